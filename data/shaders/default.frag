@@ -4,8 +4,8 @@
 
 #version 330 core
 
-uniform float u_time;
-uniform vec2 u_resolution;
+// Данные кадра, общие для всех шейдеров (блок FrameData, RENDERER_FRAME_DATA_GLSL в renderer.h):
+#include "frame_data.glsl"
 
 // Координаты текстуры и выходной цвет:
 in vec2 v_texcoord;
@@ -13,6 +13,6 @@ out vec4 FragColor;
 
 // Основная функция:
 void main() {
-    vec2 uv = gl_FragCoord.xy/u_resolution.xy;
+    vec2 uv = (gl_FragCoord.xy - u_viewport.xy)/u_viewport.zw;
     FragColor = vec4(0.5 + 0.5 * cos(u_time + uv.xyx + vec3(0, 2, 4)), 1.0);
 }
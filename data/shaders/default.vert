@@ -4,10 +4,11 @@
 
 #version 330 core
 
-// Входные параметры (матрицы преобразования):
+// Данные кадра, общие для всех шейдеров (блок FrameData, RENDERER_FRAME_DATA_GLSL в renderer.h):
+#include "frame_data.glsl"
+
+// Входные параметры (матрица модели):
 uniform mat4 u_model = mat4(1.0);
-uniform mat4 u_view = mat4(1.0);
-uniform mat4 u_projection = mat4(1.0);
 
 // Входящие атрибуты:
 layout (location = 0) in vec3 a_position;
@@ -18,6 +19,6 @@ out vec2 v_texcoord;
 
 // Основная функция:
 void main() {
-    gl_Position = u_projection * u_view * u_model * vec4(a_position, 1.0);
+    gl_Position = u_view_proj * u_model * vec4(a_position, 1.0);
     v_texcoord = a_texcoord;
 }
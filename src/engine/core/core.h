@@ -16,11 +16,17 @@ const char* CORE_NAME = "A002-UNIBOX";
 // Основное:
 #include "std.h"
 #include "darray.h"
+#include "pool.h"
+#include "varray.h"
+#include "hashmap.h"
 #include "files.h"
 #include "input.h"
 #include "math.h"
 #include "time.h"
 #include "mm/mm.h"
+#include "mm/frame.h"
+#include "mm/profiler.h"
+#include "mm/vm.h"
 
 // Графика:
 #include "graphics/realization.h"
@@ -28,5 +34,10 @@ const char* CORE_NAME = "A002-UNIBOX";
 #include "graphics/image.h"
 #include "graphics/renderer.h"
 #include "graphics/shader.h"
+#include "graphics/shader_preproc.h"
+#include "graphics/sprite_batch.h"
+#include "graphics/render_queue.h"
+#include "graphics/mesh.h"
+#include "graphics/render_target.h"
 #include "graphics/texture.h"
 #include "graphics/window.h"
@@ -6,6 +6,7 @@
 // Подключаем:
 #include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
 #include "mm/mm.h"
@@ -16,6 +17,19 @@
 static void DArray_grow(DArray *arr) {
     if (!arr) return;
 
+    // Массив в виртуальной памяти - просто подтверждаем больше страниц (данные не копируются):
+    if (arr->vm) {
+        if (arr->len < arr->capacity) return;
+        size_t max_capacity = arr->vm->reserved / sizeof(void*);
+        size_t new_capacity = arr->capacity * 2 < max_capacity ? arr->capacity * 2 : max_capacity;
+        if (new_capacity <= arr->capacity || !mm_vm_commit(arr->vm, sizeof(void*) * new_capacity)) {
+            fprintf(stderr, "DArray_grow: Reserved capacity of %zu elements is exhausted.\n", max_capacity);
+            mm_alloc_error();
+        }
+        arr->capacity = arr->vm->committed / sizeof(void*);
+        return;
+    }
+
     // Если свободной памяти в массиве нет - увеличиваем массив в 2 раза:
     if (arr->len >= arr->capacity) {
         size_t new_capacity = arr->capacity * 2;  // В 2 раза больше от текущего.
@@ -33,15 +47,54 @@ DArray* DArray_create(size_t initial_capacity) {
         initial_capacity = DARRAY_DEFAULT_CAPACITY;
     }
 
-    DArray *arr = (DArray*)mm_alloc(sizeof(DArray));
+    DArray *arr = (DArray*)mm_alloc_tagged(sizeof(DArray), MM_TAG_DARRAY);
     if (!arr) mm_alloc_error();
 
-    arr->data = mm_calloc(initial_capacity, sizeof(void*));
+    arr->data = mm_calloc_tagged(initial_capacity, sizeof(void*), MM_TAG_DARRAY);
     if (!arr->data) { mm_free(arr); mm_alloc_error(); }
 
     arr->len = 0;
     arr->capacity = initial_capacity;
     arr->init_cap = initial_capacity;
+    arr->vm = NULL;
+    return arr;
+}
+
+
+// Создать динамический массив в зарезервированной виртуальной памяти на max_capacity элементов.
+// Такой массив растёт без копирования (данные никогда не переезжают), память подтверждается по мере роста.
+// Возвращает NULL, если max_capacity * sizeof(void*) не помещается в size_t:
+DArray* DArray_create_reserved(size_t max_capacity) {
+    if (max_capacity == 0) {
+        max_capacity = DARRAY_DEFAULT_CAPACITY;
+    }
+    if (max_capacity > SIZE_MAX / sizeof(void*)) {
+        fprintf(stderr, "DArray_create_reserved: max_capacity %zu is too large.\n", max_capacity);
+        return NULL;
+    }
+
+    DArray *arr = (DArray*)mm_alloc_tagged(sizeof(DArray), MM_TAG_DARRAY);
+    if (!arr) mm_alloc_error();
+
+    arr->vm = mm_vm_create(sizeof(void*) * max_capacity);
+    if (!arr->vm) {
+        mm_free(arr);
+        mm_alloc_error();
+        return NULL;
+    }
+
+    // Подтверждаем начальный кусок (новые страницы всегда заполнены нулями):
+    size_t initial_capacity = max_capacity < DARRAY_DEFAULT_CAPACITY ? max_capacity : DARRAY_DEFAULT_CAPACITY;
+    if (!mm_vm_commit(arr->vm, sizeof(void*) * initial_capacity)) {
+        mm_vm_destroy(&arr->vm);
+        mm_free(arr);
+        mm_alloc_error();
+    }
+
+    arr->data = (void**)arr->vm->base;
+    arr->len = 0;
+    arr->capacity = arr->vm->committed / sizeof(void*);
+    arr->init_cap = initial_capacity;
     return arr;
 }
 
@@ -62,6 +115,15 @@ void DArray_push(DArray *arr, void *element) {
 void DArray_shrink(DArray *arr) {
     if (!arr) return;
 
+    // Массив в виртуальной памяти - возвращаем системе лишние страницы:
+    if (arr->vm) {
+        size_t target_capacity = arr->len ? arr->len + arr->capacity / 4 : arr->init_cap;
+        if (target_capacity < arr->init_cap) target_capacity = arr->init_cap;
+        mm_vm_decommit(arr->vm, sizeof(void*) * target_capacity);
+        arr->capacity = arr->vm->committed / sizeof(void*);
+        return;
+    }
+
     // Если массив пустой, задаем дефолтный размер:
     if (arr->len == 0) {
         arr->capacity = arr->init_cap;
@@ -197,7 +259,8 @@ void DArray_clear(DArray *arr) {
 void DArray_destroy(DArray **arr) {
     if (!arr || !*arr) return;
 
-    mm_free((*arr)->data);
+    if ((*arr)->vm) mm_vm_destroy(&(*arr)->vm);
+    else mm_free((*arr)->data);
     mm_free(*arr);
     *arr = NULL;
 }
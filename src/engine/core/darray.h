@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include "mm/vm.h"
 
 
 // Определения:
@@ -25,12 +26,18 @@ typedef struct DArray {
     size_t len;        // Длина массива (сколько ячеек занято).
     size_t capacity;   // Всего выделенных ячеек в памяти.
     size_t init_cap;   // Размер массива по умолчанию.
+    MM_VMArena *vm;    // Арена виртуальной памяти (только у массивов созданных через DArray_create_reserved).
 } DArray;
 
 
 // Создать динамический массив с заданным размером:
 DArray* DArray_create(size_t initial_capacity);
 
+// Создать динамический массив в зарезервированной виртуальной памяти на max_capacity элементов.
+// Такой массив растёт без копирования (данные никогда не переезжают), память подтверждается по мере роста.
+// Возвращает NULL, если max_capacity * sizeof(void*) не помещается в size_t:
+DArray* DArray_create_reserved(size_t max_capacity);
+
 // Добавить элемент в массив:
 void DArray_push(DArray *arr, void *element);
 
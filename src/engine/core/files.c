@@ -8,9 +8,18 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include "mm/mm.h"
 #include "files.h"
 
+#ifdef _WIN32
+    #include <direct.h>
+    #define fs_mkdir(path) _mkdir(path)
+#else
+    #include <sys/stat.h>
+    #define fs_mkdir(path) mkdir(path, 0755)
+#endif
+
 
 // Загружаем файл в строку:
 char* fs_load_file(const char* file_path, const char* mode) {
@@ -81,3 +90,28 @@ bool fs_save_file_bin(const char* file_path, const void* data, size_t size, cons
     fclose(f);
     return true;
 }
+
+
+// Создаём папку (вместе со всеми родительскими папками):
+bool fs_make_dir(const char* dir_path) {
+    if (!dir_path || !dir_path[0]) return false;
+
+    char path[1024];
+    size_t len = strlen(dir_path);
+    if (len >= sizeof(path)) return false;
+    memcpy(path, dir_path, len + 1);
+
+    // Создаём каждую папку пути по очереди (уже существующие пропускаем):
+    for (size_t i = 1; i <= len; i++) {
+        if (path[i] != '/' && path[i] != '\\' && path[i] != '\0') continue;
+        if (path[i - 1] == ':' || path[i - 1] == '/' || path[i - 1] == '\\') continue;  // Корень диска или двойной разделитель.
+        char sep = path[i];
+        path[i] = '\0';
+        if (fs_mkdir(path) != 0 && errno != EEXIST) {
+            fprintf(stderr, "fs_make_dir: Failed to create directory \"%s\".\n", path);
+            return false;
+        }
+        path[i] = sep;
+    }
+    return true;
+}
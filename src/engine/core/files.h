@@ -6,6 +6,7 @@
 
 
 // Подключаем:
+#include <stddef.h>
 #include <stdbool.h>
 
 
@@ -20,3 +21,6 @@ unsigned char* fs_load_file_bin(const char* file_path, const char* mode, size_t*
 
 // Сохраняем буфер в файл бинарно:
 bool fs_save_file_bin(const char* file_path, const void* data, size_t size, const char* mode);
+
+// Создаём папку (вместе со всеми родительскими папками):
+bool fs_make_dir(const char* dir_path);
@@ -114,14 +114,11 @@ static void Camera2D_Impl_ui_begin(Camera2D *self) {
     if (!self || self->_ui_begin_) return;
     self->_ui_begin_ = true;
 
-    // Обнуляем матрицу вида в шейдере по умолчанию:
+    // Обнуляем матрицу вида в блоке данных кадра (общем для всех шейдеров):
     mat4 view;
     glm_mat4_identity(view);
     glm_translate(view, (vec3){-self->width/2, -self->height/2, 0});
-    ShaderProgram *shader = self->window->renderer->default_shader;
-    shader->begin(shader);
-    shader->set_uniform_mat4(shader, "u_view", view);
-    shader->end(shader);
+    self->window->renderer->update_view_proj(self->window->renderer, view, self->proj);
 }
 
 
@@ -129,9 +126,6 @@ static void Camera2D_Impl_ui_end(Camera2D *self) {
     if (!self || !self->_ui_begin_) return;
     self->_ui_begin_ = false;
 
-    // Возвращаем обратно матрицу вида в шейдере по умолчанию:
-    ShaderProgram *shader = self->window->renderer->default_shader;
-    shader->begin(shader);
-    shader->set_uniform_mat4(shader, "u_view", self->view);
-    shader->end(shader);
+    // Возвращаем обратно матрицу вида в блоке данных кадра:
+    self->window->renderer->update_view_proj(self->window->renderer, self->view, self->proj);
 }
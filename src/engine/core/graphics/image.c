@@ -16,7 +16,7 @@
 
 // Загрузить картинку:
 Image* Image_load(const char *filepath, int format) {
-    Image *image = mm_alloc(sizeof(Image));
+    Image *image = mm_alloc_tagged(sizeof(Image), MM_TAG_IMAGE);
     if (!image) mm_alloc_error();
     if (!format) format = IMG_RGBA;
     if (filepath == NULL) return NULL;
@@ -66,7 +66,7 @@ bool Image_save(Image *image, const char *filepath, const char *format) {
 Image* Image_copy(const Image *source) {
     if (!source) return NULL;
 
-    Image* copy = mm_alloc(sizeof(Image));
+    Image* copy = mm_alloc_tagged(sizeof(Image), MM_TAG_IMAGE);
     if (!copy) mm_alloc_error();
 
     // Копируем простые поля:
@@ -79,9 +79,9 @@ Image* Image_copy(const Image *source) {
     size_t size = (size_t)source->width * source->height * source->channels;
 
     if (source->data && size > 0) {
-        copy->data = mm_alloc(size);
+        copy->data = mm_alloc_tagged(size, MM_TAG_IMAGE);
         if (!copy->data) {
-            free(copy);
+            mm_free(copy);
             mm_alloc_error();
         }
         memcpy(copy->data, source->data, size);
@@ -95,10 +95,10 @@ Image* Image_copy(const Image *source) {
 Image* Image_create_default() {
     if (Image_default_icon_size == 0) return NULL;
 
-    Image *image = mm_alloc(sizeof(Image));
+    Image *image = mm_alloc_tagged(sizeof(Image), MM_TAG_IMAGE);
     if (!image) mm_alloc_error();
 
-    unsigned char* buffer = mm_alloc(Image_default_icon_size);
+    unsigned char* buffer = mm_alloc_tagged(Image_default_icon_size, MM_TAG_IMAGE);
     if (!buffer) mm_alloc_error();
 
     // Копируем и используем стандартную картинку:
@@ -0,0 +1,106 @@
+//
+// mesh.c - Создаёт код для работы с мешами (общая часть: проверка раскладки и расчёт смещений).
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../mm/mm.h"
+#include "renderer.h"
+#include "realization.h"
+#include "mesh.h"
+
+
+// Посчитать смещения атрибутов и шаги потоков (false - раскладка неверная):
+static bool mesh_compute_layout(Mesh *mesh) {
+    MeshLayout *layout = &mesh->layout;
+    if (layout->count == 0 || layout->count > MESH_MAX_ATTRIBS) return false;
+
+    mesh->stream_count = 0;
+    for (uint32_t i = 0; i < layout->count; i++) {
+        MeshAttrib *attrib = &layout->attribs[i];
+        if (attrib->stream >= MESH_MAX_STREAMS || attrib->components < 1 || attrib->components > 4) return false;
+        if ((uint32_t)attrib->type > MESH_ATTRIB_UINT) return false;
+
+        // Атрибуты потока идут подряд в порядке объявления:
+        attrib->offset = mesh->strides[attrib->stream];
+        mesh->strides[attrib->stream] += Mesh_attrib_type_size(attrib->type) * attrib->components;
+        if (attrib->stream + 1 > mesh->stream_count) mesh->stream_count = attrib->stream + 1;
+    }
+
+    // Пропуски в номерах потоков не допускаются (пустой буфер без атрибутов никому не нужен):
+    for (uint32_t s = 0; s < mesh->stream_count; s++) {
+        if (mesh->strides[s] == 0) return false;
+    }
+    return true;
+}
+
+
+// Создать меш с раскладкой вершин (буферы пустые, их заполняют set_vertices и set_indices):
+Mesh* Mesh_create(Renderer *renderer, const MeshLayout *layout, RenderPrimitive primitive, MeshUsage usage) {
+    if (!renderer || !layout) return NULL;
+
+    Mesh *mesh = mm_calloc_tagged(1, sizeof(Mesh), MM_TAG_RENDERER);
+    if (!mesh) mm_alloc_error();
+
+    // Заполняем поля:
+    mesh->renderer = renderer;
+    mesh->layout = *layout;
+    mesh->usage = usage;
+    mesh->primitive = primitive;
+    mesh->index_type = RENDER_INDEX_NONE;
+    mesh->data = NULL;
+    if (!mesh_compute_layout(mesh)) {
+        fprintf(stderr, "Mesh_create: Invalid vertex layout.\n");
+        mm_free(mesh);
+        return NULL;
+    }
+
+    // Регистрируем функции для определенного рендерера:
+    switch (renderer->type) {
+        case RENDERER_OPENGL:
+            MeshGL_RegisterAPI(mesh);
+            break;
+
+        // Other renderers.
+
+        default: {
+            const char* err = "Unknown renderer type.";
+            fprintf(stderr, "Mesh_create: %s\n", err);
+            mm_free(mesh);
+            return NULL;
+        }
+    }
+    return mesh;
+}
+
+
+// Уничтожить меш:
+void Mesh_destroy(Mesh **mesh) {
+    if (!mesh || !*mesh) return;
+
+    // Удаляем объекты рендерера:
+    if ((*mesh)->_destroy_) (*mesh)->_destroy_(*mesh);
+
+    // Освобождаем структуру:
+    mm_free(*mesh);
+    *mesh = NULL;
+}
+
+
+// Получить размер компоненты атрибута в байтах:
+uint32_t Mesh_attrib_type_size(MeshAttribType type) {
+    switch (type) {
+        case MESH_ATTRIB_BYTE:
+        case MESH_ATTRIB_UBYTE:  return 1;
+        case MESH_ATTRIB_SHORT:
+        case MESH_ATTRIB_USHORT: return 2;
+        case MESH_ATTRIB_FLOAT:
+        case MESH_ATTRIB_INT:
+        case MESH_ATTRIB_UINT:
+        default:                 return 4;
+    }
+}
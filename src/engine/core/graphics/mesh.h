@@ -0,0 +1,116 @@
+//
+// mesh.h - Меши: вершинные и индексный буферы вместе с раскладкой вершин.
+//
+// Раскладка (MeshLayout) задаётся один раз при создании меша: каждый атрибут лежит в одном из потоков
+// (отдельных вершинных буферов). Все атрибуты в потоке 0 - вершины чередуются (interleaved), каждый
+// атрибут в своём потоке - структура массивов (SoA). Смещения и шаги потоков считаются сами.
+// Массив вершин рендерера (VAO) строится тоже один раз, дальше меняется только содержимое буферов.
+// Объекты рендерера удаляются отложенно (через BufferGC), поэтому меши дёшево создавать и удалять на ходу.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "render_queue.h"
+
+
+// Определения:
+#define MESH_MAX_ATTRIBS 16  // Сколько атрибутов может быть в раскладке.
+#define MESH_MAX_STREAMS 8   // Сколько вершинных буферов (потоков) может быть у меша.
+
+
+// Типы компонент атрибута:
+typedef enum MeshAttribType {
+    MESH_ATTRIB_FLOAT,
+    MESH_ATTRIB_BYTE,
+    MESH_ATTRIB_UBYTE,
+    MESH_ATTRIB_SHORT,
+    MESH_ATTRIB_USHORT,
+    MESH_ATTRIB_INT,
+    MESH_ATTRIB_UINT,
+} MeshAttribType;
+
+
+// Как часто меняется содержимое буферов меша:
+typedef enum MeshUsage {
+    MESH_USAGE_STATIC,   // Задаётся один раз.
+    MESH_USAGE_DYNAMIC,  // Иногда обновляется.
+    MESH_USAGE_STREAM,   // Обновляется каждый кадр.
+} MeshUsage;
+
+
+// Объявление структур:
+typedef struct Mesh Mesh;
+typedef struct MeshAttrib MeshAttrib;
+typedef struct MeshLayout MeshLayout;
+typedef struct Renderer Renderer;
+
+
+// Атрибут вершины:
+typedef struct MeshAttrib {
+    uint32_t location;     // Локация атрибута в шейдере.
+    MeshAttribType type;   // Тип компонент.
+    uint32_t components;   // Количество компонент (1-4).
+    bool normalized;       // Целые числа переводятся в 0..1 (или -1..1), иначе приходят в шейдер целыми (ivec/uvec).
+    uint32_t stream;       // Поток (вершинный буфер), в котором лежит атрибут.
+    uint32_t offset;       // Смещение в вершине потока (заполняется при создании меша).
+} MeshAttrib;
+
+
+// Раскладка вершин:
+typedef struct MeshLayout {
+    uint32_t count;                         // Количество атрибутов.
+    MeshAttrib attribs[MESH_MAX_ATTRIBS];  // Атрибуты (в потоке идут в порядке объявления).
+} MeshLayout;
+
+
+// Структура меша:
+typedef struct Mesh {
+    Renderer *renderer;
+    MeshLayout layout;           // Раскладка со смещениями атрибутов.
+    uint32_t stream_count;       // Количество потоков.
+    uint32_t strides[MESH_MAX_STREAMS];  // Размер вершины в каждом потоке в байтах.
+    MeshUsage usage;             // Как часто меняется содержимое.
+    RenderPrimitive primitive;   // Примитив отрисовки.
+    RenderIndexType index_type;  // Тип индексов (RENDER_INDEX_NONE - без индексов).
+    uint32_t vertex_array;       // Массив вершин рендерера (VAO), можно передавать в RenderList_draw.
+    uint32_t vertex_count;       // Количество вершин для отрисовки (наименьшее среди потоков).
+    uint32_t index_count;        // Количество индексов.
+    uint32_t vertex_counts[MESH_MAX_STREAMS];    // Количество вершин в каждом потоке.
+    uint32_t vertex_capacity[MESH_MAX_STREAMS];  // Сколько вершин вмещает буфер каждого потока.
+    uint32_t index_capacity;     // Сколько индексов вмещает индексный буфер.
+    void *data;                  // Данные реализации рендерера.
+
+    // Функции:
+
+    // Задать вершины потока (буфер растёт, если вершин больше, чем он вмещает):
+    void (*set_vertices) (Mesh *self, uint32_t stream, const void *vertices, uint32_t count);
+
+    // Обновить часть вершин потока (диапазон должен помещаться в буфер):
+    void (*update_vertices) (Mesh *self, uint32_t stream, uint32_t first, const void *vertices, uint32_t count);
+
+    // Задать индексы (type - RENDER_INDEX_U16 или RENDER_INDEX_U32, RENDER_INDEX_NONE убирает индексы):
+    void (*set_indices) (Mesh *self, RenderIndexType type, const void *indices, uint32_t count);
+
+    // Обновить часть индексов (тип тот же, что в set_indices):
+    void (*update_indices) (Mesh *self, uint32_t first, const void *indices, uint32_t count);
+
+    // Нарисовать меш текущим шейдером (first и count - в вершинах или в индексах, count 0 - до конца):
+    void (*draw) (Mesh *self, uint32_t first, uint32_t count);
+
+    void (*_destroy_) (Mesh *self);  // Внутренняя функция для удаления объектов рендерера.
+} Mesh;
+
+
+// Создать меш с раскладкой вершин (буферы пустые, их заполняют set_vertices и set_indices):
+Mesh* Mesh_create(Renderer *renderer, const MeshLayout *layout, RenderPrimitive primitive, MeshUsage usage);
+
+// Уничтожить меш (можно из любого потока, объекты рендерера удалит поток рендерера):
+void Mesh_destroy(Mesh **mesh);
+
+// Получить размер компоненты атрибута в байтах:
+uint32_t Mesh_attrib_type_size(MeshAttribType type);
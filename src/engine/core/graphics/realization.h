@@ -14,5 +14,12 @@
 // Реализации рендереров:
 // OpenGL:
 #include "renderer/gl/renderer_gl.h"
+#include "renderer/gl/state_gl.h"
+#include "renderer/gl/stream_buffer_gl.h"
+#include "renderer/gl/texture_units_gl.h"
 #include "renderer/gl/shader_gl.h"
 #include "renderer/gl/texture_gl.h"
+#include "renderer/gl/sprite_batch_gl.h"
+#include "renderer/gl/render_queue_gl.h"
+#include "renderer/gl/mesh_gl.h"
+#include "renderer/gl/render_target_gl.h"
@@ -0,0 +1,398 @@
+//
+// render_queue.c - Очередь команд рендеринга (общая часть: запись, слияние и сортировка).
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "../mm/mm.h"
+#include "../varray.h"
+#include "renderer.h"
+#include "realization.h"
+#include "render_queue.h"
+
+
+// Выравнивание команд в памяти списка:
+#define RENDER_LIST_ALIGN 16
+
+
+// Сколько очередей поток помнит одновременно (запись в большее число очередей по очереди
+// всё ещё работает, но вытесненная очередь при следующем обращении выдаст потоку новый список):
+#define RENDER_LIST_TLS_SLOTS 8
+
+
+// Счётчик поколений очередей (общий для всех очередей, поэтому поколение не повторяется, даже если
+// новая очередь создана по адресу удалённой):
+static atomic_uint render_queue_generation = 0;
+
+// Списки текущего потока по очередям (запись действительна, пока совпадают очередь и её поколение):
+typedef struct RenderListSlot {
+    RenderQueue *queue;
+    uint32_t generation;
+    RenderList *list;
+} RenderListSlot;
+
+static _Thread_local RenderListSlot render_list_tls[RENDER_LIST_TLS_SLOTS] = {0};
+static _Thread_local uint32_t render_list_tls_next = 0;  // Какую запись вытеснять, если свободных нет.
+
+
+// Выдать очереди новое поколение (0 не выдаётся, чтобы не совпасть с пустым render_list_tls):
+static inline uint32_t next_generation(void) {
+    uint32_t generation;
+    do generation = atomic_fetch_add(&render_queue_generation, 1) + 1; while (generation == 0);
+    return generation;
+}
+
+
+// Создать очередь команд:
+RenderQueue* RenderQueue_create(Renderer *renderer) {
+    if (!renderer) return NULL;
+
+    RenderQueue *queue = mm_calloc_tagged(1, sizeof(RenderQueue), MM_TAG_RENDERER);
+    if (!queue) mm_alloc_error();
+
+    // Заполняем поля:
+    queue->renderer = renderer;
+    queue->data = NULL;
+    queue->generation = next_generation();
+    atomic_init(&queue->lists_used, 0);
+    for (int i = 0; i < RENDER_QUEUE_MAX_LISTS; i++) {
+        queue->lists[i].queue = queue;
+        queue->lists[i].memory = VArray_create(1, 4096);
+        queue->lists[i].items = VArray_create(sizeof(RenderQueueItem), 256);
+    }
+    queue->sorted = VArray_create(sizeof(RenderQueueItem), 1024);
+    queue->scratch = VArray_create(sizeof(RenderQueueItem), 1024);
+
+    // Регистрируем функции для определенного рендерера:
+    switch (renderer->type) {
+        case RENDERER_OPENGL:
+            RenderQueueGL_RegisterAPI(queue);
+            break;
+
+        // Other renderers.
+
+        default: {
+            const char* err = "Unknown renderer type.";
+            fprintf(stderr, "RenderQueue_create: %s\n", err);
+            RenderQueue_destroy(&queue);
+            return NULL;
+        }
+    }
+    return queue;
+}
+
+
+// Уничтожить очередь команд:
+void RenderQueue_destroy(RenderQueue **queue) {
+    if (!queue || !*queue) return;
+    RenderQueue *q = *queue;
+
+    // Удаляем данные рендерера:
+    if (q->_destroy_) q->_destroy_(q);
+
+    // Освобождаем списки:
+    for (int i = 0; i < RENDER_QUEUE_MAX_LISTS; i++) {
+        VArray_destroy(&q->lists[i].memory);
+        VArray_destroy(&q->lists[i].items);
+    }
+    VArray_destroy(&q->sorted);
+    VArray_destroy(&q->scratch);
+
+    // Освобождаем структуру:
+    mm_free(q);
+    *queue = NULL;
+}
+
+
+// Очистить параметры следующей отрисовки:
+static inline void clear_pending(RenderList *list) {
+    list->shader = NULL;
+    list->state = RENDER_STATE_BLEND;
+    list->texture_count = 0;
+    list->uniform_count = 0;
+}
+
+
+// Получить список команд текущего потока (в пределах кадра поток всегда получает один и тот же список):
+RenderList* RenderQueue_get_list(RenderQueue *queue) {
+    if (!queue) return NULL;
+
+    // Ищем запись этой очереди (поток может писать в несколько очередей попеременно):
+    RenderListSlot *slot = NULL;
+    for (int i = 0; i < RENDER_LIST_TLS_SLOTS; i++) {
+        if (render_list_tls[i].queue != queue) continue;
+        if (render_list_tls[i].generation == queue->generation) return render_list_tls[i].list;
+        slot = &render_list_tls[i];  // Список устарел - запись переиспользуем.
+        break;
+    }
+    if (!slot) {
+        for (int i = 0; i < RENDER_LIST_TLS_SLOTS && !slot; i++) {
+            if (!render_list_tls[i].queue) slot = &render_list_tls[i];
+        }
+        if (!slot) slot = &render_list_tls[render_list_tls_next++ % RENDER_LIST_TLS_SLOTS];
+    }
+
+    // Первое обращение потока в этом кадре - берём свободный список:
+    uint32_t index = atomic_fetch_add(&queue->lists_used, 1);
+    if (index >= RENDER_QUEUE_MAX_LISTS) {
+        fprintf(stderr, "RenderQueue_get_list: Too many recording threads (max %d).\n", RENDER_QUEUE_MAX_LISTS);
+        return NULL;
+    }
+    RenderList *list = &queue->lists[index];
+    VArray_clear(list->memory);
+    VArray_clear(list->items);
+    clear_pending(list);
+
+    slot->queue = queue;
+    slot->generation = queue->generation;
+    slot->list = list;
+    return list;
+}
+
+
+// Сбросить все списки без выполнения:
+void RenderQueue_reset(RenderQueue *queue) {
+    if (!queue) return;
+    queue->generation = next_generation();  // Потоки увидят новое поколение и возьмут списки заново.
+    atomic_store(&queue->lists_used, 0);
+    VArray_clear(queue->sorted);
+}
+
+
+// Поразрядная сортировка элементов по ключу (устойчивая, по 8 бит за проход):
+static void radix_sort(RenderQueueItem *items, RenderQueueItem *scratch, size_t count) {
+    RenderQueueItem *src = items, *dst = scratch;
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {0};
+        for (size_t i = 0; i < count; i++) counts[(src[i].key >> shift) & 0xFF]++;
+
+        // Если у всех ключей этот байт одинаковый, проход ничего не меняет:
+        if (counts[(src[0].key >> shift) & 0xFF] == count) continue;
+
+        size_t offset = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t c = counts[b];
+            counts[b] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < count; i++) dst[counts[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+        RenderQueueItem *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != items) memcpy(items, src, count * sizeof(RenderQueueItem));
+}
+
+
+// Слить и отсортировать списки в queue->sorted (выполняется внутри RenderQueue_execute):
+void RenderQueue_sort(RenderQueue *queue) {
+    if (!queue) return;
+    VArray_clear(queue->sorted);
+
+    // Сливаем списки по порядку (внутри списка порядок записи сохраняется):
+    uint32_t used = atomic_load(&queue->lists_used);
+    if (used > RENDER_QUEUE_MAX_LISTS) used = RENDER_QUEUE_MAX_LISTS;
+    for (uint32_t i = 0; i < used; i++) {
+        VArray *items = queue->lists[i].items;
+        if (VArray_len(items) > 0) VArray_append(queue->sorted, items->data, VArray_len(items));
+    }
+
+    size_t count = VArray_len(queue->sorted);
+    if (count < 2) return;
+    VArray_resize(queue->scratch, count);
+    radix_sort(queue->sorted->data, queue->scratch->data, count);
+}
+
+
+// Слить списки, отсортировать, выполнить и сбросить очередь (только в потоке рендерера, когда запись закончена):
+void RenderQueue_execute(RenderQueue *queue) {
+    if (!queue) return;
+    RenderQueue_sort(queue);
+    queue->commands = 0;
+    queue->shader_switches = 0;
+    queue->texture_switches = 0;
+    if (queue->_execute_) queue->_execute_(queue);
+    RenderQueue_reset(queue);
+}
+
+
+// Собрать ключ сортировки (depth от 0 до 1):
+uint64_t RenderQueue_make_key(uint32_t layer, uint32_t shader, uint32_t texture, float depth) {
+    const uint32_t depth_max = (1u << RENDER_KEY_DEPTH_BITS) - 1;
+    if (!(depth > 0.0f)) depth = 0.0f;  // Заодно отсекает NaN.
+    if (depth > 1.0f) depth = 1.0f;
+    uint64_t key = 0;
+    key |= (uint64_t)(layer & ((1u << RENDER_KEY_LAYER_BITS) - 1));
+    key = (key << RENDER_KEY_SHADER_BITS) | (shader & ((1u << RENDER_KEY_SHADER_BITS) - 1));
+    key = (key << RENDER_KEY_TEXTURE_BITS) | (texture & ((1u << RENDER_KEY_TEXTURE_BITS) - 1));
+    key = (key << RENDER_KEY_DEPTH_BITS) | (uint32_t)(depth * (float)depth_max);
+    return key;
+}
+
+
+// Получить команду по элементу сортировки:
+RenderCommand* RenderQueue_get_command(RenderQueue *queue, const RenderQueueItem *item) {
+    if (!queue || !item || item->list >= RENDER_QUEUE_MAX_LISTS) return NULL;
+    return (RenderCommand*)((char*)queue->lists[item->list].memory->data + item->offset);
+}
+
+
+// Параметры следующей отрисовки:
+
+
+// Установить шейдер:
+void RenderList_set_shader(RenderList *list, ShaderProgram *shader) {
+    if (!list) return;
+    list->shader = shader;
+}
+
+
+// Установить флаги состояния (RenderStateFlags):
+void RenderList_set_state(RenderList *list, uint32_t state) {
+    if (!list) return;
+    list->state = state;
+}
+
+
+// Прикрепить текстуру к сэмплеру:
+void RenderList_set_texture(RenderList *list, ShaderUniform sampler, Texture *texture) {
+    if (!list) return;
+    if (list->texture_count >= RENDER_LIST_MAX_TEXTURES) {
+        fprintf(stderr, "RenderList_set_texture: Too many textures for one draw (max %d).\n", RENDER_LIST_MAX_TEXTURES);
+        return;
+    }
+    list->textures[list->texture_count++] = (RenderTextureBinding){sampler, texture};
+}
+
+
+// Добавить значение юниформа (NULL если места нет):
+static RenderUniformValue* push_uniform(RenderList *list, ShaderUniform uniform, RenderUniformType type) {
+    if (!list) return NULL;
+    if (list->uniform_count >= RENDER_LIST_MAX_UNIFORMS) {
+        fprintf(stderr, "RenderList_set_uniform: Too many uniforms for one draw (max %d).\n", RENDER_LIST_MAX_UNIFORMS);
+        return NULL;
+    }
+    RenderUniformValue *value = &list->uniforms[list->uniform_count++];
+    value->uniform = uniform;
+    value->type = type;
+    return value;
+}
+
+
+void RenderList_set_int(RenderList *list, ShaderUniform uniform, int value) {
+    RenderUniformValue *u = push_uniform(list, uniform, RENDER_UNIFORM_INT);
+    if (u) u->vint = value;
+}
+
+
+void RenderList_set_float(RenderList *list, ShaderUniform uniform, float value) {
+    RenderUniformValue *u = push_uniform(list, uniform, RENDER_UNIFORM_FLOAT);
+    if (u) u->vfloat = value;
+}
+
+
+void RenderList_set_vec2(RenderList *list, ShaderUniform uniform, Vec2f value) {
+    RenderUniformValue *u = push_uniform(list, uniform, RENDER_UNIFORM_VEC2);
+    if (u) memcpy(u->vec, &value, sizeof(value));
+}
+
+
+void RenderList_set_vec3(RenderList *list, ShaderUniform uniform, Vec3f value) {
+    RenderUniformValue *u = push_uniform(list, uniform, RENDER_UNIFORM_VEC3);
+    if (u) memcpy(u->vec, &value, sizeof(value));
+}
+
+
+void RenderList_set_vec4(RenderList *list, ShaderUniform uniform, Vec4f value) {
+    RenderUniformValue *u = push_uniform(list, uniform, RENDER_UNIFORM_VEC4);
+    if (u) memcpy(u->vec, &value, sizeof(value));
+}
+
+
+void RenderList_set_mat4(RenderList *list, ShaderUniform uniform, mat4 value) {
+    RenderUniformValue *u = push_uniform(list, uniform, RENDER_UNIFORM_MAT4);
+    if (u) memcpy(u->mat, value, sizeof(float) * 16);
+}
+
+
+// Команды отрисовки:
+
+
+// Записать команду вместе с параметрами отрисовки (extra - сколько байт данных идёт после них):
+static RenderCommand* push_command(RenderList *list, uint64_t key, RenderCommandType type, size_t extra) {
+    size_t textures_size = sizeof(RenderTextureBinding) * list->texture_count;
+    size_t uniforms_size = sizeof(RenderUniformValue) * list->uniform_count;
+    size_t size = sizeof(RenderCommand) + textures_size + uniforms_size + extra;
+
+    // Команды выравниваем, чтобы данные после заголовка можно было читать напрямую:
+    size_t offset = (VArray_len(list->memory) + RENDER_LIST_ALIGN - 1) & ~(size_t)(RENDER_LIST_ALIGN - 1);
+    if (offset + size > UINT32_MAX) {
+        fprintf(stderr, "RenderList_draw: Command list is full.\n");
+        return NULL;
+    }
+    // Память растёт вдвое (а не ровно до нужного размера), чтобы запись не копировала список на каждой команде:
+    VArray *memory = list->memory;
+    if (offset + size > memory->capacity) {
+        size_t new_capacity = memory->capacity * 2;
+        VArray_reserve(memory, new_capacity > offset + size ? new_capacity : offset + size);
+    }
+    memory->len = offset + size;  // Всё до конца команды сейчас будет записано (кроме выравнивания).
+
+    char *data = (char*)memory->data + offset;
+    RenderCommand *command = (RenderCommand*)data;
+    memset(command, 0, sizeof(RenderCommand));
+    command->type = type;
+    command->shader = list->shader;
+    command->state = list->state;
+    command->texture_count = list->texture_count;
+    command->uniform_count = list->uniform_count;
+    memcpy(data + sizeof(RenderCommand), list->textures, textures_size);
+    memcpy(data + sizeof(RenderCommand) + textures_size, list->uniforms, uniforms_size);
+
+    RenderQueueItem *item = VArray_push(list->items, NULL);
+    item->key = key;
+    item->list = (uint32_t)(list - list->queue->lists);
+    item->offset = (uint32_t)offset;
+
+    clear_pending(list);
+    return command;
+}
+
+
+// Нарисовать массив вершин (first и count - в вершинах или в индексах):
+void RenderList_draw(
+    RenderList *list, uint64_t key, uint32_t vertex_array, RenderPrimitive primitive,
+    RenderIndexType index_type, uint32_t first, uint32_t count, uint32_t instances
+) {
+    if (!list || count == 0) return;
+    RenderCommand *command = push_command(list, key, RENDER_CMD_DRAW, 0);
+    if (!command) return;
+    command->draw.vertex_array = vertex_array;
+    command->draw.primitive = primitive;
+    command->draw.index_type = index_type;
+    command->draw.first = first;
+    command->draw.count = count;
+    command->draw.instances = instances ? instances : 1;
+}
+
+
+// Нарисовать экземпляры встроенного меша (экземпляры копируются в список):
+void RenderList_draw_instanced(
+    RenderList *list, uint64_t key, RendererMesh mesh, const RendererInstance *instances, uint32_t count
+) {
+    if (!list || !instances || count == 0) return;
+    size_t data_offset = sizeof(RenderCommand) + sizeof(RenderTextureBinding) * list->texture_count +
+                         sizeof(RenderUniformValue) * list->uniform_count;
+    RenderCommand *command = push_command(list, key, RENDER_CMD_DRAW_INSTANCED, sizeof(RendererInstance) * (size_t)count);
+    if (!command) return;
+    command->instanced.mesh = mesh;
+    command->instanced.count = count;
+    memcpy((char*)command + data_offset, instances, sizeof(RendererInstance) * (size_t)count);
+}
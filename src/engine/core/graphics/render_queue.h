@@ -0,0 +1,241 @@
+//
+// render_queue.h - Очередь команд рендеринга с ключами сортировки.
+//
+// Команды отрисовки записываются в линейные списки команд, у каждого потока свой список
+// (RenderQueue_get_list), поэтому кадр можно собирать параллельно без блокировок.
+// Перед отрисовкой (RenderQueue_execute, только в потоке рендерера) списки сливаются и сортируются
+// поразрядной сортировкой по 64-битному ключу: слой, шейдер, текстура, глубина. Так команды с одним
+// шейдером и текстурой идут подряд, и лишние переключения состояния пропадают сами.
+//
+// Состояние, юниформы и текстуры задаются перед вызовом отрисовки и прикрепляются к нему,
+// поэтому после сортировки каждая отрисовка выполняется со своими параметрами. Команды с
+// одинаковым ключом сохраняют порядок записи (сортировка устойчивая).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "../math.h"
+#include "renderer.h"
+#include "shader.h"
+
+
+// Определения:
+#define RENDER_QUEUE_MAX_LISTS     32  // Сколько потоков могут одновременно записывать команды.
+#define RENDER_LIST_MAX_TEXTURES   8   // Сколько текстур можно прикрепить к одной отрисовке.
+#define RENDER_LIST_MAX_UNIFORMS   32  // Сколько юниформов можно прикрепить к одной отрисовке.
+
+// Раскладка ключа сортировки (от старших битов к младшим):
+#define RENDER_KEY_LAYER_BITS   8   // Слой (порядок проходов: фон, мир, интерфейс...).
+#define RENDER_KEY_SHADER_BITS  16  // Шейдер.
+#define RENDER_KEY_TEXTURE_BITS 16  // Текстура.
+#define RENDER_KEY_DEPTH_BITS   24  // Глубина (0..1).
+
+
+// Примитивы отрисовки:
+typedef enum RenderPrimitive {
+    RENDER_POINTS,
+    RENDER_LINES,
+    RENDER_LINE_STRIP,
+    RENDER_TRIANGLES,
+    RENDER_TRIANGLE_STRIP,
+} RenderPrimitive;
+
+
+// Тип индексов отрисовки:
+typedef enum RenderIndexType {
+    RENDER_INDEX_NONE,  // Без индексов.
+    RENDER_INDEX_U16,   // 16-битные индексы.
+    RENDER_INDEX_U32,   // 32-битные индексы.
+} RenderIndexType;
+
+
+// Флаги состояния отрисовки:
+typedef enum RenderStateFlags {
+    RENDER_STATE_BLEND      = 1 << 0,  // Включено смешивание цветов.
+    RENDER_STATE_DEPTH_TEST = 1 << 1,  // Включён тест глубины.
+} RenderStateFlags;
+
+
+// Типы команд:
+typedef enum RenderCommandType {
+    RENDER_CMD_DRAW,            // Отрисовка массива вершин.
+    RENDER_CMD_DRAW_INSTANCED,  // Отрисовка экземплярами встроенного меша (Renderer.draw_instanced).
+} RenderCommandType;
+
+
+// Типы юниформов команды:
+typedef enum RenderUniformType {
+    RENDER_UNIFORM_INT,
+    RENDER_UNIFORM_FLOAT,
+    RENDER_UNIFORM_VEC2,
+    RENDER_UNIFORM_VEC3,
+    RENDER_UNIFORM_VEC4,
+    RENDER_UNIFORM_MAT4,
+} RenderUniformType;
+
+
+// Объявление структур:
+typedef struct RenderQueue RenderQueue;
+typedef struct RenderList RenderList;
+typedef struct RenderQueueItem RenderQueueItem;
+typedef struct RenderCommand RenderCommand;
+typedef struct RenderTextureBinding RenderTextureBinding;
+typedef struct RenderUniformValue RenderUniformValue;
+typedef struct Texture Texture;
+typedef struct VArray VArray;
+
+
+// Текстура, прикреплённая к отрисовке:
+typedef struct RenderTextureBinding {
+    ShaderUniform sampler;  // Сэмплер в шейдере.
+    Texture *texture;       // Текстура.
+} RenderTextureBinding;
+
+
+// Значение юниформа, прикреплённое к отрисовке:
+typedef struct RenderUniformValue {
+    ShaderUniform uniform;   // Юниформ в шейдере.
+    RenderUniformType type;  // Тип значения.
+    union {
+        int32_t vint;
+        float vfloat;
+        float vec[4];
+        float mat[16];
+    };
+} RenderUniformValue;
+
+
+// Команда в списке (за ней в памяти лежат текстуры, юниформы и данные экземпляров):
+typedef struct RenderCommand {
+    RenderCommandType type;    // Тип команды.
+    ShaderProgram *shader;     // Шейдер (NULL у DRAW_INSTANCED - дефолтный).
+    uint32_t state;            // Флаги состояния (RenderStateFlags).
+    uint16_t texture_count;    // Сколько текстур прикреплено.
+    uint16_t uniform_count;    // Сколько юниформов прикреплено.
+    union {
+        struct {  // RENDER_CMD_DRAW:
+            uint32_t vertex_array;       // Массив вершин рендерера (VAO).
+            RenderPrimitive primitive;   // Примитив.
+            RenderIndexType index_type;  // Тип индексов.
+            uint32_t first;              // Первая вершина (или первый индекс).
+            uint32_t count;              // Количество вершин (или индексов).
+            uint32_t instances;          // Количество экземпляров (1 - обычная отрисовка).
+        } draw;
+        struct {  // RENDER_CMD_DRAW_INSTANCED:
+            RendererMesh mesh;           // Встроенный меш.
+            uint32_t count;              // Количество экземпляров.
+        } instanced;
+    };
+} RenderCommand;
+
+
+// Элемент сортировки (ссылка на команду в списке):
+typedef struct RenderQueueItem {
+    uint64_t key;     // Ключ сортировки.
+    uint32_t list;    // Индекс списка.
+    uint32_t offset;  // Смещение команды в памяти списка.
+} RenderQueueItem;
+
+
+// Список команд одного потока:
+typedef struct RenderList {
+    RenderQueue *queue;  // Очередь, которой принадлежит список.
+    VArray *memory;      // Линейная память команд (байты).
+    VArray *items;       // Записанные команды (RenderQueueItem).
+
+    // Параметры следующей отрисовки (сбрасываются после неё):
+    ShaderProgram *shader;
+    uint32_t state;
+    uint16_t texture_count;
+    uint16_t uniform_count;
+    RenderTextureBinding textures[RENDER_LIST_MAX_TEXTURES];
+    RenderUniformValue uniforms[RENDER_LIST_MAX_UNIFORMS];
+} RenderList;
+
+
+// Структура очереди команд:
+typedef struct RenderQueue {
+    Renderer *renderer;  // Рендерер.
+    void *data;          // Данные реализации рендерера.
+    uint32_t generation;     // Поколение очереди (новое при создании и сбросе, по нему потоки узнают, что список устарел).
+    atomic_uint lists_used;  // Сколько списков выдано потокам в этом кадре.
+    RenderList lists[RENDER_QUEUE_MAX_LISTS];  // Списки команд.
+    VArray *sorted;      // Все команды кадра после сортировки (RenderQueueItem).
+    VArray *scratch;     // Временный буфер поразрядной сортировки.
+
+    // Статистика последнего выполнения:
+    size_t commands;          // Сколько команд выполнено.
+    size_t shader_switches;   // Сколько раз переключался шейдер.
+    size_t texture_switches;  // Сколько раз текстуру пришлось привязывать к юниту.
+
+    // Функции:
+
+    // Выполнить отсортированные команды (только в потоке рендерера):
+    void (*_execute_) (RenderQueue *self);
+    void (*_destroy_) (RenderQueue *self);  // Внутренняя функция для удаления данных рендерера.
+} RenderQueue;
+
+
+// Создать очередь команд:
+RenderQueue* RenderQueue_create(Renderer *renderer);
+
+// Уничтожить очередь команд:
+void RenderQueue_destroy(RenderQueue **queue);
+
+// Получить список команд текущего потока (в пределах кадра поток всегда получает один и тот же список):
+RenderList* RenderQueue_get_list(RenderQueue *queue);
+
+// Слить списки, отсортировать, выполнить и сбросить очередь (только в потоке рендерера, когда запись закончена):
+void RenderQueue_execute(RenderQueue *queue);
+
+// Сбросить все списки без выполнения:
+void RenderQueue_reset(RenderQueue *queue);
+
+// Слить и отсортировать списки в queue->sorted (выполняется внутри RenderQueue_execute):
+void RenderQueue_sort(RenderQueue *queue);
+
+// Собрать ключ сортировки (depth от 0 до 1):
+uint64_t RenderQueue_make_key(uint32_t layer, uint32_t shader, uint32_t texture, float depth);
+
+// Получить команду по элементу сортировки:
+RenderCommand* RenderQueue_get_command(RenderQueue *queue, const RenderQueueItem *item);
+
+
+// Параметры следующей отрисовки:
+
+// Установить шейдер:
+void RenderList_set_shader(RenderList *list, ShaderProgram *shader);
+
+// Установить флаги состояния (RenderStateFlags):
+void RenderList_set_state(RenderList *list, uint32_t state);
+
+// Прикрепить текстуру к сэмплеру:
+void RenderList_set_texture(RenderList *list, ShaderUniform sampler, Texture *texture);
+
+// Прикрепить значения юниформов:
+void RenderList_set_int   (RenderList *list, ShaderUniform uniform, int value);
+void RenderList_set_float (RenderList *list, ShaderUniform uniform, float value);
+void RenderList_set_vec2  (RenderList *list, ShaderUniform uniform, Vec2f value);
+void RenderList_set_vec3  (RenderList *list, ShaderUniform uniform, Vec3f value);
+void RenderList_set_vec4  (RenderList *list, ShaderUniform uniform, Vec4f value);
+void RenderList_set_mat4  (RenderList *list, ShaderUniform uniform, mat4 value);
+
+
+// Команды отрисовки:
+
+// Нарисовать массив вершин (first и count - в вершинах или в индексах):
+void RenderList_draw(
+    RenderList *list, uint64_t key, uint32_t vertex_array, RenderPrimitive primitive,
+    RenderIndexType index_type, uint32_t first, uint32_t count, uint32_t instances
+);
+
+// Нарисовать экземпляры встроенного меша (экземпляры копируются в список):
+void RenderList_draw_instanced(
+    RenderList *list, uint64_t key, RendererMesh mesh, const RendererInstance *instances, uint32_t count
+);
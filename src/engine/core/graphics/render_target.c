@@ -0,0 +1,164 @@
+//
+// render_target.c - Создаёт код для работы с целями отрисовки и пулом временных целей.
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../mm/mm.h"
+#include "../varray.h"
+#include "renderer.h"
+#include "realization.h"
+#include "render_target.h"
+
+
+// Создать цель отрисовки:
+RenderTarget* RenderTarget_create(Renderer *renderer, const RenderTargetDesc *desc) {
+    if (!renderer || !desc) return NULL;
+    if (desc->width <= 0 || desc->height <= 0 || desc->color_count > RENDER_TARGET_MAX_COLORS ||
+        (desc->color_count == 0 && desc->depth == RENDER_TARGET_DEPTH_NONE)) {
+        fprintf(stderr, "RenderTarget_create: Invalid description.\n");
+        return NULL;
+    }
+
+    RenderTarget *target = mm_calloc_tagged(1, sizeof(RenderTarget), MM_TAG_RENDERER);
+    if (!target) mm_alloc_error();
+
+    // Заполняем поля:
+    target->renderer = renderer;
+    target->desc = *desc;
+    if (target->desc.samples < 1) target->desc.samples = 1;
+    target->_is_begin_ = false;
+    target->data = NULL;
+
+    // Регистрируем функции для определенного рендерера:
+    bool created = false;
+    switch (renderer->type) {
+        case RENDERER_OPENGL:
+            created = RenderTargetGL_RegisterAPI(target);
+            break;
+
+        // Other renderers.
+
+        default: {
+            const char* err = "Unknown renderer type.";
+            fprintf(stderr, "RenderTarget_create: %s\n", err);
+            break;
+        }
+    }
+    if (!created) RenderTarget_destroy(&target);
+    return target;
+}
+
+
+// Уничтожить цель отрисовки:
+void RenderTarget_destroy(RenderTarget **target) {
+    if (!target || !*target) return;
+
+    // Удаляем объекты рендерера (текстуры цели тоже):
+    if ((*target)->_destroy_) (*target)->_destroy_(*target);
+
+    // Освобождаем структуру:
+    mm_free(*target);
+    *target = NULL;
+}
+
+
+// Совпадают ли описания целей:
+bool RenderTargetDesc_equal(const RenderTargetDesc *a, const RenderTargetDesc *b) {
+    uint32_t samples_a = a->samples < 1 ? 1 : a->samples;
+    uint32_t samples_b = b->samples < 1 ? 1 : b->samples;
+    return a->width == b->width && a->height == b->height && a->color_count == b->color_count &&
+           (a->color_count == 0 || a->color_format == b->color_format) && a->depth == b->depth &&
+           (a->depth == RENDER_TARGET_DEPTH_NONE || a->depth_texture == b->depth_texture) && samples_a == samples_b;
+}
+
+
+// Создать пул временных целей (max_idle_frames 0 - по умолчанию):
+RenderTargetPool* RenderTargetPool_create(Renderer *renderer, uint32_t max_idle_frames) {
+    if (!renderer) return NULL;
+
+    RenderTargetPool *pool = mm_calloc_tagged(1, sizeof(RenderTargetPool), MM_TAG_RENDERER);
+    if (!pool) mm_alloc_error();
+
+    // Заполняем поля:
+    pool->renderer = renderer;
+    pool->entries = VArray_create(sizeof(RenderTargetPoolEntry), 16);
+    pool->frame = 0;
+    pool->max_idle_frames = max_idle_frames ? max_idle_frames : RENDER_TARGET_POOL_DEFAULT_FRAMES;
+    return pool;
+}
+
+
+// Уничтожить пул вместе со всеми целями:
+void RenderTargetPool_destroy(RenderTargetPool **pool) {
+    if (!pool || !*pool) return;
+    for (size_t i = 0; i < VArray_len((*pool)->entries); i++) {
+        RenderTarget_destroy(&VArray_at((*pool)->entries, RenderTargetPoolEntry, i).target);
+    }
+    VArray_destroy(&(*pool)->entries);
+    mm_free(*pool);
+    *pool = NULL;
+}
+
+
+// Получить свободную цель с таким описанием (или создать новую):
+RenderTarget* RenderTargetPool_acquire(RenderTargetPool *pool, const RenderTargetDesc *desc) {
+    if (!pool || !desc) return NULL;
+
+    // Ищем свободную цель с тем же описанием (целей в пуле единицы, поэтому хватает прохода по массиву):
+    for (size_t i = 0; i < VArray_len(pool->entries); i++) {
+        RenderTargetPoolEntry *entry = &VArray_at(pool->entries, RenderTargetPoolEntry, i);
+        if (entry->in_use || !RenderTargetDesc_equal(&entry->target->desc, desc)) continue;
+        entry->in_use = true;
+        entry->last_used = pool->frame;
+        pool->hits++;
+        return entry->target;
+    }
+
+    // Подходящей нет - создаём новую:
+    RenderTarget *target = RenderTarget_create(pool->renderer, desc);
+    if (!target) return NULL;
+    RenderTargetPoolEntry entry = {.target = target, .last_used = pool->frame, .in_use = true};
+    VArray_push(pool->entries, &entry);
+    pool->misses++;
+    return target;
+}
+
+
+// Вернуть цель в пул (в этом же кадре её может получить следующий проход):
+void RenderTargetPool_release(RenderTargetPool *pool, RenderTarget *target) {
+    if (!pool || !target) return;
+    for (size_t i = 0; i < VArray_len(pool->entries); i++) {
+        RenderTargetPoolEntry *entry = &VArray_at(pool->entries, RenderTargetPoolEntry, i);
+        if (entry->target != target) continue;
+        if (target->_is_begin_) target->end(target);
+        entry->in_use = false;
+        return;
+    }
+    fprintf(stderr, "RenderTargetPool_release: The target does not belong to the pool.\n");
+}
+
+
+// Закончить кадр пула (удаляет цели, которые не запрашивали дольше max_idle_frames кадров):
+void RenderTargetPool_next_frame(RenderTargetPool *pool) {
+    if (!pool) return;
+    pool->frame++;
+
+    // Удаляем простаивающие цели (порядок не важен, поэтому на место удалённой ставим последнюю):
+    for (size_t i = 0; i < VArray_len(pool->entries);) {
+        RenderTargetPoolEntry *entry = &VArray_at(pool->entries, RenderTargetPoolEntry, i);
+        if (entry->in_use || pool->frame - entry->last_used <= pool->max_idle_frames) {
+            i++;
+            continue;
+        }
+        RenderTarget_destroy(&entry->target);
+        size_t last = VArray_len(pool->entries) - 1;
+        if (i != last) *entry = VArray_at(pool->entries, RenderTargetPoolEntry, last);
+        VArray_pop(pool->entries, NULL);
+        pool->evictions++;
+    }
+}
@@ -0,0 +1,127 @@
+//
+// render_target.h - Цели отрисовки (кадровые буферы) и пул временных целей.
+//
+// Цель отрисовки состоит из текстур цвета (до RENDER_TARGET_MAX_COLORS) и необязательной глубины.
+// Между begin и end всё рисуется в неё, а текстуры цвета потом можно читать в шейдерах как обычные Texture.
+// С MSAA (samples > 1) рисование идёт в отдельные многовыборочные буферы, а в текстуры результат
+// попадает при resolve (end делает его сам).
+//
+// Пул (RenderTargetPool) раздаёт временные цели для проходов постобработки: цель с тем же описанием
+// переиспользуется и внутри кадра (после release), и между кадрами, а цели, которые долго не
+// запрашивались, удаляются.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "texture.h"
+
+
+// Определения:
+#define RENDER_TARGET_MAX_COLORS          4  // Сколько текстур цвета может быть у цели.
+#define RENDER_TARGET_POOL_DEFAULT_FRAMES 3  // Через сколько кадров без запросов пул удаляет цель.
+
+
+// Формат глубины:
+typedef enum RenderTargetDepth {
+    RENDER_TARGET_DEPTH_NONE,      // Без глубины.
+    RENDER_TARGET_DEPTH_24,        // 24 бита глубины.
+    RENDER_TARGET_DEPTH_24_S8,     // 24 бита глубины и 8 бит трафарета.
+    RENDER_TARGET_DEPTH_32F,       // 32 бита глубины с плавающей точкой.
+} RenderTargetDepth;
+
+
+// Объявление структур:
+typedef struct RenderTarget RenderTarget;
+typedef struct RenderTargetDesc RenderTargetDesc;
+typedef struct RenderTargetPool RenderTargetPool;
+typedef struct RenderTargetPoolEntry RenderTargetPoolEntry;
+typedef struct Renderer Renderer;
+typedef struct VArray VArray;
+
+
+// Описание цели отрисовки (по нему же пул ищет подходящие цели):
+typedef struct RenderTargetDesc {
+    int width;                    // Ширина в пикселях.
+    int height;                   // Высота в пикселях.
+    uint32_t color_count;         // Количество текстур цвета (0 - только глубина).
+    TextureFormat color_format;   // Формат текстур цвета.
+    RenderTargetDepth depth;      // Формат глубины.
+    bool depth_texture;           // Глубина в текстуре (её можно читать в шейдере), иначе во внутреннем буфере.
+    uint32_t samples;             // Количество выборок MSAA (0 или 1 - без MSAA).
+} RenderTargetDesc;
+
+
+// Структура цели отрисовки:
+typedef struct RenderTarget {
+    Renderer *renderer;
+    RenderTargetDesc desc;     // Описание цели.
+    uint32_t id;               // Кадровый буфер с текстурами (в него попадает результат resolve).
+    Texture *colors[RENDER_TARGET_MAX_COLORS];  // Текстуры цвета.
+    Texture *depth;            // Текстура глубины (только если desc.depth_texture).
+    bool _is_begin_;
+    void *data;                // Данные реализации рендерера.
+
+    // Функции:
+
+    void (*begin)   (RenderTarget *self);  // Рисовать в цель (запоминает прошлую цель и область просмотра).
+    void (*end)     (RenderTarget *self);  // Вернуть прошлую цель (с MSAA заодно делает resolve).
+    void (*resolve) (RenderTarget *self);  // Перенести многовыборочные буферы в текстуры (без MSAA ничего не делает).
+
+    // Скопировать цвет (первую текстуру) в другую цель с растяжением (dst NULL - в окно, в текущую область просмотра):
+    void (*blit) (RenderTarget *self, RenderTarget *dst, bool linear);
+
+    void (*_destroy_) (RenderTarget *self);  // Внутренняя функция для удаления объектов рендерера.
+} RenderTarget;
+
+
+// Цель в пуле:
+typedef struct RenderTargetPoolEntry {
+    RenderTarget *target;  // Цель.
+    uint64_t last_used;    // Кадр, в котором цель запрашивали последний раз.
+    bool in_use;           // Цель выдана и ещё не возвращена.
+} RenderTargetPoolEntry;
+
+
+// Структура пула временных целей:
+typedef struct RenderTargetPool {
+    Renderer *renderer;
+    VArray *entries;         // Цели пула (RenderTargetPoolEntry).
+    uint64_t frame;          // Номер текущего кадра пула.
+    uint32_t max_idle_frames;  // Через сколько кадров без запросов цель удаляется.
+
+    // Статистика:
+    size_t hits;       // Сколько раз цель взята из пула.
+    size_t misses;     // Сколько раз пришлось создавать новую цель.
+    size_t evictions;  // Сколько целей удалено за простой.
+} RenderTargetPool;
+
+
+// Создать цель отрисовки:
+RenderTarget* RenderTarget_create(Renderer *renderer, const RenderTargetDesc *desc);
+
+// Уничтожить цель отрисовки:
+void RenderTarget_destroy(RenderTarget **target);
+
+// Совпадают ли описания целей:
+bool RenderTargetDesc_equal(const RenderTargetDesc *a, const RenderTargetDesc *b);
+
+
+// Создать пул временных целей (max_idle_frames 0 - по умолчанию):
+RenderTargetPool* RenderTargetPool_create(Renderer *renderer, uint32_t max_idle_frames);
+
+// Уничтожить пул вместе со всеми целями:
+void RenderTargetPool_destroy(RenderTargetPool **pool);
+
+// Получить свободную цель с таким описанием (или создать новую):
+RenderTarget* RenderTargetPool_acquire(RenderTargetPool *pool, const RenderTargetDesc *desc);
+
+// Вернуть цель в пул (в этом же кадре её может получить следующий проход):
+void RenderTargetPool_release(RenderTargetPool *pool, RenderTarget *target);
+
+// Закончить кадр пула (удаляет цели, которые не запрашивали дольше max_idle_frames кадров):
+void RenderTargetPool_next_frame(RenderTargetPool *pool);
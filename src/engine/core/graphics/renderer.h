@@ -6,7 +6,42 @@
 
 
 // Подключаем:
+#include <stddef.h>
 #include <stdint.h>
+#include "../math.h"
+
+
+// Общий для всех шейдеров блок юниформов с данными кадра (std140):
+#define RENDERER_FRAME_DATA_BLOCK   "FrameData"  // Имя блока в шейдерах.
+#define RENDERER_FRAME_DATA_BINDING 0            // Фиксированная точка привязки блока.
+#define RENDERER_FRAME_DATA_INCLUDE "frame_data.glsl"  // Имя для #include в шейдерах.
+
+// Объявление блока (рендерер регистрирует его как подключаемый файл RENDERER_FRAME_DATA_INCLUDE):
+#define RENDERER_FRAME_DATA_GLSL \
+"layout (std140) uniform FrameData {\n" \
+"    mat4 u_view;\n" \
+"    mat4 u_proj;\n" \
+"    mat4 u_view_proj;\n" \
+"    vec4 u_viewport;\n" \
+"    float u_time;\n" \
+"};\n"
+
+
+// Флаги вариантов шейдера по умолчанию (порядок совпадает с #define в его исходнике):
+typedef enum RendererShaderFlags {
+    RENDERER_SHADER_TEXTURE = 1 << 0,  // USE_TEXTURE - цвет умножается на текстуру.
+    RENDERER_SHADER_POINTS  = 1 << 1,  // USE_POINTS - круглые точки (всё вне круга отбрасывается).
+    RENDERER_SHADER_VERTEX_COLOR = 1 << 2,  // USE_VERTEX_COLOR - цвет умножается на атрибут a_color (location 2).
+    RENDERER_SHADER_INSTANCED    = 1 << 3,  // USE_INSTANCED - позиция, поворот, масштаб и цвет берутся из RendererInstance.
+} RendererShaderFlags;
+
+
+// Встроенные меши для отрисовки экземплярами:
+typedef enum RendererMesh {
+    RENDERER_MESH_QUAD,   // Квадрат 1x1 с центром в нуле (полоса из двух треугольников).
+    RENDERER_MESH_POINT,  // Одна точка (размер в пикселях берётся из scale.x экземпляра).
+    RENDERER_MESH_COUNT,  // Количество встроенных мешей.
+} RendererMesh;
 
 
 // Виды рендереров:
@@ -18,6 +53,46 @@ typedef enum RenderType {
 // Объявление структур:
 typedef struct Renderer Renderer;
 typedef struct ShaderProgram ShaderProgram;
+typedef struct ShaderVariants ShaderVariants;
+typedef struct RendererFrameData RendererFrameData;
+typedef struct RendererInstance RendererInstance;
+typedef struct Texture Texture;
+
+
+// Данные кадра в раскладке std140 (совпадает с блоком FrameData в шейдерах):
+typedef struct RendererFrameData {
+    float view[16];       // Матрица вида.
+    float proj[16];       // Матрица проекции.
+    float view_proj[16];  // Произведение proj * view.
+    float viewport[4];    // Область просмотра (x, y, ширина, высота).
+    float time;           // Время в секундах.
+    float _pad_[3];       // Выравнивание блока до 16 байт.
+} RendererFrameData;
+
+_Static_assert(sizeof(RendererFrameData) == 224, "RendererFrameData must match the std140 layout of FrameData.");
+
+
+// Данные одного экземпляра (атрибуты с делителем 1, location 3-5 в шейдере):
+typedef struct RendererInstance {
+    float position[3];  // Позиция центра (i_position.xyz).
+    float rotation;     // Угол поворота в радианах (i_position.w).
+    float scale[2];     // Масштаб меша (i_scale).
+    uint32_t color;     // Цвет RGBA8, см. Renderer_pack_color (i_color).
+} RendererInstance;
+
+_Static_assert(sizeof(RendererInstance) == 28, "RendererInstance must stay tightly packed.");
+
+
+// Упаковать цвет в RGBA8 (в памяти байты идут как R, G, B, A):
+static inline uint32_t Renderer_pack_color(Vec4f color) {
+    float c[4] = {color.x, color.y, color.z, color.w};
+    uint32_t packed = 0;
+    for (int i = 0; i < 4; i++) {
+        float v = c[i] < 0.0f ? 0.0f : (c[i] > 1.0f ? 1.0f : c[i]);
+        packed |= (uint32_t)(v * 255.0f + 0.5f) << (i * 8);
+    }
+    return packed;
+}
 
 
 // Типовая структура рендерера:
@@ -25,7 +100,8 @@ typedef struct Renderer {
     // Поля:
     const char    *name;
     RenderType    type;
-    ShaderProgram *default_shader;  // Дефолтная шейдерная программа.
+    ShaderProgram *default_shader;  // Дефолтная шейдерная программа (вариант без флагов).
+    ShaderVariants *default_shaders;  // Все варианты дефолтного шейдера (RendererShaderFlags).
     void          *camera;  // Текущая активная камера.
     void          *data;    // Указатель на структуру данных рендерера.
 
@@ -37,4 +113,12 @@ typedef struct Renderer {
     void (*camera2d_update) (Renderer *self);  // Обновляем данные матриц в шейдере по умолчанию для 2D камеры.
     void (*camera3d_update) (Renderer *self);  // Обновляем данные матриц в шейдере по умолчанию для 3D камеры.
     void (*viewport_resize) (Renderer *self, int x, int y, int width, int height);  // Масштабируем область просмотра.
+    void (*update_view_proj) (Renderer *self, mat4 view, mat4 proj);  // Записать матрицы камеры в блок данных кадра.
+    void (*set_time)         (Renderer *self, float time);  // Записать время в блок данных кадра.
+    ShaderProgram* (*get_default_shader) (Renderer *self, uint32_t flags);  // Вариант дефолтного шейдера (RendererShaderFlags).
+
+    // Нарисовать count экземпляров встроенного меша одним вызовом. Экземпляры загружаются в общий
+    // потоковый буфер. shader - NULL для инстансного варианта дефолтного шейдера, texture может быть NULL:
+    void (*draw_instanced) (Renderer *self, RendererMesh mesh, const RendererInstance *instances, size_t count,
+                            Texture *texture, ShaderProgram *shader);
 } Renderer;
@@ -6,9 +6,13 @@
 // Подключаем:
 #include <stdint.h>
 #include <stddef.h>
-#include "../../../darray.h"
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "../../../varray.h"
+#include "../../../hashmap.h"
 #include "../../../mm/mm.h"
 #include "../../gl.h"
+#include "state_gl.h"
 #include "buffer_gc_gl.h"
 
 
@@ -16,134 +20,263 @@
 BufferGC_GL buffer_gc_gl = {0};
 
 
-// Найти максимальный размер стеков:
-static inline size_t find_max_stacks_len() {
-    size_t max_stack_len = 0;
-    if (DArray_len(buffer_gc_gl.qbo)  > max_stack_len) max_stack_len = DArray_len(buffer_gc_gl.qbo);
-    if (DArray_len(buffer_gc_gl.ssbo) > max_stack_len) max_stack_len = DArray_len(buffer_gc_gl.ssbo);
-    if (DArray_len(buffer_gc_gl.fbo)  > max_stack_len) max_stack_len = DArray_len(buffer_gc_gl.fbo);
-    if (DArray_len(buffer_gc_gl.vbo)  > max_stack_len) max_stack_len = DArray_len(buffer_gc_gl.vbo);
-    if (DArray_len(buffer_gc_gl.ibo)  > max_stack_len) max_stack_len = DArray_len(buffer_gc_gl.ibo);
-    if (DArray_len(buffer_gc_gl.vao)  > max_stack_len) max_stack_len = DArray_len(buffer_gc_gl.vao);
-    if (DArray_len(buffer_gc_gl.tbo)  > max_stack_len) max_stack_len = DArray_len(buffer_gc_gl.tbo);
-    // ...
-    return max_stack_len;
+// Поток рендерера (в нём вызван BufferGC_GL_init, только он трогает стеки кадра напрямую):
+static _Thread_local bool buffer_gc_gl_owner = false;
+
+
+// Ключ пула с учётом типа объекта (одинаковые ключи разных типов не должны смешиваться):
+static inline uint64_t pool_key(BufferGC_GL_Type type, uint64_t key) {
+    return key * BGC_GL_TYPE_COUNT + (uint64_t)type;
+}
+
+
+// Удалить объекты одного типа (айдишки лежат в стеке подряд как uint32_t, так что передаём их в OpenGL напрямую):
+static void delete_objects(BufferGC_GL_Type type, const uint32_t *ids, size_t count) {
+    if (count == 0) return;
+
+    // Удалённые объекты OpenGL отвязывает сам, поэтому убираем их и из теневой копии состояния:
+    StateGL_forget_deleted(type, ids, count);
+    switch (type) {
+        case BGC_GL_QBO:  glDeleteQueries((GLsizei)count, ids); break;
+        case BGC_GL_FBO:  glDeleteFramebuffers((GLsizei)count, ids); break;
+        case BGC_GL_SSBO:
+        case BGC_GL_VBO:
+        case BGC_GL_IBO:  glDeleteBuffers((GLsizei)count, ids); break;
+        case BGC_GL_VAO:  glDeleteVertexArrays((GLsizei)count, ids); break;
+        case BGC_GL_TBO:  glDeleteTextures((GLsizei)count, ids); break;
+        case BGC_GL_RBO:  glDeleteRenderbuffers((GLsizei)count, ids); break;
+        // ...
+        default: break;
+    }
+}
+
+
+// Положить объект в пул (если в пуле уже достаточно таких объектов - удалить):
+static void pool_put(const BufferGC_GL_Recycled *item) {
+    if (!buffer_gc_gl.recycle) {
+        delete_objects(item->type, &item->id, 1);
+        return;
+    }
+    uint64_t key = pool_key(item->type, item->key);
+    VArray **slot = HashMap_get_int(buffer_gc_gl.pool, key);
+    if (!slot) {
+        VArray *ids = VArray_create(sizeof(uint32_t), BUFFER_GC_GL_POOL_LIMIT);
+        slot = HashMap_put_int(buffer_gc_gl.pool, key, &ids);
+    }
+    if (VArray_len(*slot) >= BUFFER_GC_GL_POOL_LIMIT) {
+        delete_objects(item->type, &item->id, 1);
+        return;
+    }
+    VArray_push(*slot, &item->id);
 }
 
 
-// Скопировать айдишки из стека в массив:
-static inline void copy_ids_from_stack(DArray *stack, uint32_t *ids) {
-    for (size_t i=0; i < DArray_len(stack); i++) {
-        ids[i] = (uint32_t)(uintptr_t)stack->data[i];
+// Освободить слот кольца (видеокарта уже закончила кадр этого слота):
+static void frame_release(BufferGC_GL_Frame *frame) {
+    for (int t = 0; t < BGC_GL_TYPE_COUNT; t++) {
+        delete_objects((BufferGC_GL_Type)t, frame->stacks[t]->data, VArray_len(frame->stacks[t]));
+        VArray_clear(frame->stacks[t]);  // Память стеков остаётся на следующие кадры.
+    }
+    for (size_t i = 0; i < VArray_len(frame->recycled); i++) {
+        pool_put(&VArray_at(frame->recycled, BufferGC_GL_Recycled, i));
     }
+    VArray_clear(frame->recycled);
+    if (frame->fence) glDeleteSync(frame->fence);
+    frame->fence = NULL;
+}
+
+
+// Сработал ли забор кадра (не блокирует):
+static inline bool frame_is_done(BufferGC_GL_Frame *frame) {
+    GLenum status = glClientWaitSync(frame->fence, 0, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+
+// Дождаться забора кадра:
+static void frame_wait(BufferGC_GL_Frame *frame) {
+    if (frame_is_done(frame)) return;
+    buffer_gc_gl.waits++;
+    GLenum status;
+    do {
+        status = glClientWaitSync(frame->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);  // По 1 мс.
+    } while (status == GL_TIMEOUT_EXPIRED);
 }
 
 
-// Очистить стек:
-static inline void stack_flush(DArray *stack) {
-    DArray_clear(stack);
-    DArray_shrink(stack);
+// Положить объект в лок-фри стек (для потоков, кроме потока рендерера):
+static void incoming_push(BufferGC_GL_Type type, uint32_t id, uint64_t key, bool recycle) {
+    BufferGC_GL_Node *node = mm_alloc_tagged(sizeof(BufferGC_GL_Node), MM_TAG_RENDERER);
+    if (!node) mm_alloc_error();
+    node->item = (BufferGC_GL_Recycled){.key = key, .id = id, .type = type};
+    node->recycle = recycle;
+    node->next = atomic_load_explicit(&buffer_gc_gl.incoming, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(
+        &buffer_gc_gl.incoming, &node->next, node, memory_order_release, memory_order_relaxed
+    ));
+}
+
+
+// Забрать все объекты из лок-фри стека в стеки кадра (стек забирается целиком, поэтому проблемы ABA нет):
+static void incoming_drain() {
+    BufferGC_GL_Node *node = atomic_exchange_explicit(&buffer_gc_gl.incoming, NULL, memory_order_acquire);
+    while (node) {
+        BufferGC_GL_Node *next = node->next;
+        if (node->recycle && buffer_gc_gl.recycle) {
+            VArray_push(buffer_gc_gl.recycled, &node->item);
+        } else {
+            VArray_push(buffer_gc_gl.stacks[node->item.type], &node->item.id);
+        }
+        mm_free(node);
+        node = next;
+    }
 }
 
 
 // Инициализация стеков буферов:
 void BufferGC_GL_init() {
     size_t start_capacity = 1024;  // Начальный и стандартный размер стеков.
-    buffer_gc_gl.qbo  = DArray_create(start_capacity);
-    buffer_gc_gl.ssbo = DArray_create(start_capacity);
-    buffer_gc_gl.fbo  = DArray_create(start_capacity);
-    buffer_gc_gl.vbo  = DArray_create(start_capacity);
-    buffer_gc_gl.ibo  = DArray_create(start_capacity);
-    buffer_gc_gl.vao  = DArray_create(start_capacity);
-    buffer_gc_gl.tbo  = DArray_create(start_capacity);
-    // ...
+    for (int t = 0; t < BGC_GL_TYPE_COUNT; t++) {
+        buffer_gc_gl.stacks[t] = VArray_create(sizeof(uint32_t), start_capacity);
+        for (int f = 0; f < BUFFER_GC_GL_FRAMES; f++) {
+            buffer_gc_gl.frames[f].stacks[t] = VArray_create(sizeof(uint32_t), start_capacity);
+        }
+    }
+    buffer_gc_gl.recycled = VArray_create(sizeof(BufferGC_GL_Recycled), 64);
+    for (int f = 0; f < BUFFER_GC_GL_FRAMES; f++) {
+        buffer_gc_gl.frames[f].recycled = VArray_create(sizeof(BufferGC_GL_Recycled), 64);
+        buffer_gc_gl.frames[f].fence = NULL;
+    }
+    buffer_gc_gl.frame = 0;
+    buffer_gc_gl.recycle = false;
+    buffer_gc_gl.pool = HashMap_create(HASHMAP_KEY_INT, sizeof(VArray*), 64);
+    atomic_store(&buffer_gc_gl.incoming, NULL);
+    buffer_gc_gl.waits = 0;
+    buffer_gc_gl.pool_hits = 0;
+    buffer_gc_gl.pool_misses = 0;
+    buffer_gc_gl_owner = true;
 }
 
 
-// Уничтожение стеков буферов:
+// Уничтожение стеков буферов (всё, что ещё ждёт видеокарту или лежит в пуле, удаляется сразу):
 void BufferGC_GL_destroy() {
-    DArray_destroy(&buffer_gc_gl.qbo);
-    DArray_destroy(&buffer_gc_gl.ssbo);
-    DArray_destroy(&buffer_gc_gl.fbo);
-    DArray_destroy(&buffer_gc_gl.vbo);
-    DArray_destroy(&buffer_gc_gl.ibo);
-    DArray_destroy(&buffer_gc_gl.vao);
-    DArray_destroy(&buffer_gc_gl.tbo);
-    // ...
+    if (!buffer_gc_gl.pool) return;
+
+    // Мусор в кольце и текущего кадра удаляем без ожидания (контекст уничтожается вместе с ним):
+    BufferGC_GL_set_recycle(false);
+    incoming_drain();
+    for (int f = 0; f < BUFFER_GC_GL_FRAMES; f++) frame_release(&buffer_gc_gl.frames[f]);
+    for (int t = 0; t < BGC_GL_TYPE_COUNT; t++) {
+        delete_objects((BufferGC_GL_Type)t, buffer_gc_gl.stacks[t]->data, VArray_len(buffer_gc_gl.stacks[t]));
+    }
+    for (size_t i = 0; i < VArray_len(buffer_gc_gl.recycled); i++) {
+        pool_put(&VArray_at(buffer_gc_gl.recycled, BufferGC_GL_Recycled, i));
+    }
+
+    // Освобождаем память:
+    for (int t = 0; t < BGC_GL_TYPE_COUNT; t++) {
+        VArray_destroy(&buffer_gc_gl.stacks[t]);
+        for (int f = 0; f < BUFFER_GC_GL_FRAMES; f++) VArray_destroy(&buffer_gc_gl.frames[f].stacks[t]);
+    }
+    VArray_destroy(&buffer_gc_gl.recycled);
+    for (int f = 0; f < BUFFER_GC_GL_FRAMES; f++) VArray_destroy(&buffer_gc_gl.frames[f].recycled);
+    size_t iter = 0;
+    VArray **ids;
+    while ((ids = HashMap_next(buffer_gc_gl.pool, &iter, NULL, NULL))) VArray_destroy(ids);
+    HashMap_destroy(&buffer_gc_gl.pool);
 }
 
 
 // Добавить буфер на уничтожение:
 void BufferGC_GL_push(BufferGC_GL_Type type, unsigned int id) {
-    switch (type) {
-        case BGC_GL_QBO:  DArray_push(buffer_gc_gl.qbo,  (void*)(uintptr_t)id); break;
-        case BGC_GL_SSBO: DArray_push(buffer_gc_gl.ssbo, (void*)(uintptr_t)id); break;
-        case BGC_GL_FBO:  DArray_push(buffer_gc_gl.fbo,  (void*)(uintptr_t)id); break;
-        case BGC_GL_VBO:  DArray_push(buffer_gc_gl.vbo,  (void*)(uintptr_t)id); break;
-        case BGC_GL_IBO:  DArray_push(buffer_gc_gl.ibo,  (void*)(uintptr_t)id); break;
-        case BGC_GL_VAO:  DArray_push(buffer_gc_gl.vao,  (void*)(uintptr_t)id); break;
-        case BGC_GL_TBO:  DArray_push(buffer_gc_gl.tbo,  (void*)(uintptr_t)id); break;
-        // ...
+    if ((uint32_t)type >= BGC_GL_TYPE_COUNT || id == 0) return;
+    if (!buffer_gc_gl_owner) {
+        incoming_push(type, id, 0, false);
+        return;
     }
+    VArray_push(buffer_gc_gl.stacks[type], &id);
 }
 
 
-// Очистка всех буферов:
+// Закончить кадр: мусор кадра уходит под забор, а мусор прошлых кадров, которые видеокарта дорисовала, удаляется:
 void BufferGC_GL_flush() {
-    // Находим максимальный размер стека буферов:
-    size_t max_stack_len = find_max_stacks_len();
-
-    // Если нет буферов -> выходим (лишний раз не выделяем память):
-    if (max_stack_len == 0) return;
-
-    // Выделяем память для айдишек:
-    uint32_t *ids = mm_alloc(sizeof(uint32_t) * max_stack_len);
-
-    // Очищаем стек буферов QBO:
-    if (DArray_len(buffer_gc_gl.qbo) > 0) {
-        copy_ids_from_stack(buffer_gc_gl.qbo, ids);
-        glDeleteQueries(DArray_len(buffer_gc_gl.qbo), ids);
-        stack_flush(buffer_gc_gl.qbo);
-    }
-    // Очищаем стек буферов SSBO:
-    if (DArray_len(buffer_gc_gl.ssbo) > 0) {
-        copy_ids_from_stack(buffer_gc_gl.ssbo, ids);
-        glDeleteBuffers(DArray_len(buffer_gc_gl.ssbo), ids);
-        stack_flush(buffer_gc_gl.ssbo);
-    }
-    // Очищаем стек буферов FBO:
-    if (DArray_len(buffer_gc_gl.fbo) > 0) {
-        copy_ids_from_stack(buffer_gc_gl.fbo, ids);
-        glDeleteFramebuffers(DArray_len(buffer_gc_gl.fbo), ids);
-        stack_flush(buffer_gc_gl.fbo);
-    }
-    // Очищаем стек буферов VBO:
-    if (DArray_len(buffer_gc_gl.vbo) > 0) {
-        copy_ids_from_stack(buffer_gc_gl.vbo, ids);
-        glDeleteBuffers(DArray_len(buffer_gc_gl.vbo), ids);
-        stack_flush(buffer_gc_gl.vbo);
-    }
-    // Очищаем стек буферов IBO:
-    if (DArray_len(buffer_gc_gl.ibo) > 0) {
-        copy_ids_from_stack(buffer_gc_gl.ibo, ids);
-        glDeleteBuffers(DArray_len(buffer_gc_gl.ibo), ids);
-        stack_flush(buffer_gc_gl.ibo);
-    }
-    // Очищаем стек буферов VAO:
-    if (DArray_len(buffer_gc_gl.vao) > 0) {
-        copy_ids_from_stack(buffer_gc_gl.vao, ids);
-        glDeleteVertexArrays(DArray_len(buffer_gc_gl.vao), ids);
-        stack_flush(buffer_gc_gl.vao);
-    }
-    // Очищаем стек буферов TBO:
-    if (DArray_len(buffer_gc_gl.tbo) > 0) {
-        copy_ids_from_stack(buffer_gc_gl.tbo, ids);
-        glDeleteTextures(DArray_len(buffer_gc_gl.tbo), ids);
-        stack_flush(buffer_gc_gl.tbo);
-    }
-
-    // ...
-
-    // Освобожаем память:
-    mm_free(ids);
+    incoming_drain();  // Забираем объекты, отданные другими потоками.
+
+    // Освобождаем кадры, которые видеокарта уже закончила:
+    for (int f = 0; f < BUFFER_GC_GL_FRAMES; f++) {
+        BufferGC_GL_Frame *frame = &buffer_gc_gl.frames[f];
+        if (frame->fence && frame_is_done(frame)) frame_release(frame);
+    }
+
+    // Есть ли мусор в этом кадре:
+    bool empty = VArray_len(buffer_gc_gl.recycled) == 0;
+    for (int t = 0; t < BGC_GL_TYPE_COUNT && empty; t++) empty = VArray_len(buffer_gc_gl.stacks[t]) == 0;
+    if (empty) return;
+
+    // Слот кольца ещё занят - видеокарта отстала на BUFFER_GC_GL_FRAMES кадров, ждём её:
+    BufferGC_GL_Frame *frame = &buffer_gc_gl.frames[buffer_gc_gl.frame];
+    if (frame->fence) {
+        frame_wait(frame);
+        frame_release(frame);
+    }
+
+    // Меняем стеки местами вместо копирования (стеки слота после освобождения пусты):
+    for (int t = 0; t < BGC_GL_TYPE_COUNT; t++) {
+        VArray *stack = frame->stacks[t];
+        frame->stacks[t] = buffer_gc_gl.stacks[t];
+        buffer_gc_gl.stacks[t] = stack;
+    }
+    VArray *recycled = frame->recycled;
+    frame->recycled = buffer_gc_gl.recycled;
+    buffer_gc_gl.recycled = recycled;
+    frame->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    buffer_gc_gl.frame = (buffer_gc_gl.frame + 1) % BUFFER_GC_GL_FRAMES;
+}
+
+
+// Включить или выключить пул переиспользования (при выключении пул очищается):
+void BufferGC_GL_set_recycle(bool enabled) {
+    buffer_gc_gl.recycle = enabled;
+    if (enabled || !buffer_gc_gl.pool) return;
+
+    // Объекты в пуле видеокарта уже не использует, поэтому удаляем их сразу:
+    size_t iter = 0;
+    uint64_t key;
+    VArray **ids;
+    while ((ids = HashMap_next(buffer_gc_gl.pool, &iter, NULL, &key))) {
+        delete_objects((BufferGC_GL_Type)(key % BGC_GL_TYPE_COUNT), (*ids)->data, VArray_len(*ids));
+        VArray_clear(*ids);
+    }
+}
+
+
+// Отдать объект на переиспользование (если пул выключен - просто на уничтожение):
+void BufferGC_GL_recycle(BufferGC_GL_Type type, uint32_t id, uint64_t key) {
+    if (!buffer_gc_gl_owner) {
+        // Включён ли пул, решит поток рендерера, когда заберёт объект:
+        if ((uint32_t)type < BGC_GL_TYPE_COUNT && id != 0) incoming_push(type, id, key, true);
+        return;
+    }
+    if (!buffer_gc_gl.recycle) {
+        BufferGC_GL_push(type, id);
+        return;
+    }
+    if ((uint32_t)type >= BGC_GL_TYPE_COUNT || id == 0) return;
+    BufferGC_GL_Recycled item = {.key = key, .id = id, .type = type};
+    VArray_push(buffer_gc_gl.recycled, &item);
+}
+
+
+// Взять объект из пула (0 - подходящего нет, надо создать новый):
+uint32_t BufferGC_GL_reuse(BufferGC_GL_Type type, uint64_t key) {
+    if (!buffer_gc_gl.recycle) return 0;
+    VArray **ids = HashMap_get_int(buffer_gc_gl.pool, pool_key(type, key));
+    if (!ids || VArray_len(*ids) == 0) {
+        buffer_gc_gl.pool_misses++;
+        return 0;
+    }
+    uint32_t id;
+    VArray_pop(*ids, &id);
+    buffer_gc_gl.pool_hits++;
+    return id;
 }
@@ -1,12 +1,36 @@
 //
 // buffer_gc_gl.h
 //
+// Объекты OpenGL, отправленные на уничтожение в течение кадра, копятся в стеках и в конце кадра
+// (BufferGC_GL_flush) уходят в кольцо из BUFFER_GC_GL_FRAMES кадров под забором glFenceSync.
+// Удаляются они только когда забор сработал, то есть видеокарта точно закончила кадр, в котором
+// эти объекты ещё могли использоваться.
+//
+// Пул переиспользования (выключен по умолчанию) вместо удаления складывает объекты по ключу
+// (тип + размер/формат) и отдаёт их обратно через BufferGC_GL_reuse, что убирает лишние glGen*/glDelete*
+// для временных текстур и буферов.
+//
+// BufferGC_GL_push и BufferGC_GL_recycle можно вызывать из любого потока: в потоке рендерера (в котором
+// вызван BufferGC_GL_init) объект сразу попадает в стек кадра, а из других потоков - в лок-фри стек
+// (стек Трайбера), который поток рендерера забирает целиком в начале BufferGC_GL_flush.
+// Остальные функции - только в потоке рендерера.
+//
 
 #pragma once
 
 
 // Подключаем:
-#include "../../../darray.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "../../../varray.h"
+#include "../../gl.h"
+
+
+// Определения:
+#define BUFFER_GC_GL_FRAMES     3  // Сколько кадров мусора может ждать видеокарту одновременно.
+#define BUFFER_GC_GL_POOL_LIMIT 8  // Сколько одинаковых объектов хранит пул (лишние удаляются).
 
 
 // Типы буферов на уничтожение:
@@ -18,24 +42,58 @@ typedef enum BufferGC_GL_Type {
     BGC_GL_IBO,
     BGC_GL_VAO,
     BGC_GL_TBO,
+    BGC_GL_RBO,
     // ...
+    BGC_GL_TYPE_COUNT,  // Количество типов.
 } BufferGC_GL_Type;
 
 
 // Объявление структур:
 typedef struct BufferGC_GL BufferGC_GL;
+typedef struct BufferGC_GL_Frame BufferGC_GL_Frame;
+typedef struct BufferGC_GL_Recycled BufferGC_GL_Recycled;
+typedef struct BufferGC_GL_Node BufferGC_GL_Node;
+typedef struct HashMap HashMap;
+
+
+// Объект, отданный на переиспользование:
+typedef struct BufferGC_GL_Recycled {
+    uint64_t key;           // Ключ пула (см. BufferGC_GL_buffer_key и BufferGC_GL_texture_key).
+    uint32_t id;            // Айди объекта.
+    BufferGC_GL_Type type;  // Тип объекта.
+} BufferGC_GL_Recycled;
+
+
+// Объект, отданный из другого потока (узел лок-фри стека):
+typedef struct BufferGC_GL_Node {
+    BufferGC_GL_Node *next;     // Следующий узел.
+    BufferGC_GL_Recycled item;  // Объект (ключ нужен только при переиспользовании).
+    bool recycle;               // Отдан на переиспользование, а не на уничтожение.
+} BufferGC_GL_Node;
 
 
-// Единица кэша локаций юниформов:
+// Мусор одного кадра, ждущий видеокарту:
+typedef struct BufferGC_GL_Frame {
+    VArray *stacks[BGC_GL_TYPE_COUNT];  // Айди на уничтожение по типам (uint32_t).
+    VArray *recycled;                   // Объекты для пула (BufferGC_GL_Recycled).
+    GLsync fence;                       // Забор кадра (NULL - слот свободен).
+} BufferGC_GL_Frame;
+
+
+// Стеки айди буферов на уничтожение (VArray из uint32_t, можно сразу передавать в glDelete*):
 typedef struct BufferGC_GL {
-    DArray *qbo;
-    DArray *ssbo;
-    DArray *fbo;
-    DArray *vbo;
-    DArray *ibo;
-    DArray *vao;
-    DArray *tbo;
-    // ...
+    VArray *stacks[BGC_GL_TYPE_COUNT];  // Мусор текущего кадра по типам.
+    VArray *recycled;                   // Объекты текущего кадра для пула (BufferGC_GL_Recycled).
+    BufferGC_GL_Frame frames[BUFFER_GC_GL_FRAMES];  // Кольцо кадров, ждущих видеокарту.
+    uint32_t frame;                     // Слот кольца для следующего кадра.
+    bool recycle;                       // Пул переиспользования включён.
+    HashMap *pool;                      // Ключ пула -> VArray* свободных айди.
+    _Atomic(BufferGC_GL_Node*) incoming;  // Объекты из других потоков (лок-фри стек).
+
+    // Статистика:
+    size_t waits;        // Сколько раз кольцо было заполнено и пришлось ждать видеокарту.
+    size_t pool_hits;    // Сколько объектов выдано из пула.
+    size_t pool_misses;  // Сколько раз подходящего объекта в пуле не было.
 } BufferGC_GL;
 
 
@@ -46,11 +104,31 @@ extern BufferGC_GL buffer_gc_gl;
 // Инициализация стеков буферов:
 void BufferGC_GL_init();
 
-// Уничтожение стеков буферов:
+// Уничтожение стеков буферов (всё, что ещё ждёт видеокарту или лежит в пуле, удаляется сразу):
 void BufferGC_GL_destroy();
 
 // Добавить буфер на уничтожение:
 void BufferGC_GL_push(BufferGC_GL_Type type, unsigned int id);
 
-// Очистка всех буферов:
+// Закончить кадр: мусор кадра уходит под забор, а мусор прошлых кадров, которые видеокарта дорисовала, удаляется:
 void BufferGC_GL_flush();
+
+// Включить или выключить пул переиспользования (при выключении пул очищается):
+void BufferGC_GL_set_recycle(bool enabled);
+
+// Отдать объект на переиспользование (если пул выключен - просто на уничтожение):
+void BufferGC_GL_recycle(BufferGC_GL_Type type, uint32_t id, uint64_t key);
+
+// Взять объект из пула (0 - подходящего нет, надо создать новый):
+uint32_t BufferGC_GL_reuse(BufferGC_GL_Type type, uint64_t key);
+
+// Ключ пула для буфера (размер в байтах и подсказка использования):
+static inline uint64_t BufferGC_GL_buffer_key(size_t size, uint32_t usage) {
+    return ((uint64_t)size << 16) | (usage & 0xFFFF);
+}
+
+// Ключ пула для 2D текстуры (размер, внутренний формат и наличие мипмапов):
+static inline uint64_t BufferGC_GL_texture_key(int width, int height, uint32_t format, bool mipmap) {
+    return ((uint64_t)(width & 0xFFFF)) | ((uint64_t)(height & 0xFFFF) << 16) |
+           ((uint64_t)(format & 0xFFFF) << 32) | ((uint64_t)mipmap << 48);
+}
@@ -0,0 +1,234 @@
+//
+// mesh_gl.c - Реализует меши на OpenGL.
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../../../mm/mm.h"
+#include "../../gl.h"
+#include "../../mesh.h"
+#include "buffer_gc_gl.h"
+#include "state_gl.h"
+#include "render_queue_gl.h"
+#include "mesh_gl.h"
+
+
+// Объявление функций:
+static void MeshGL_Impl_set_vertices(Mesh *self, uint32_t stream, const void *vertices, uint32_t count);
+static void MeshGL_Impl_update_vertices(Mesh *self, uint32_t stream, uint32_t first, const void *vertices, uint32_t count);
+static void MeshGL_Impl_set_indices(Mesh *self, RenderIndexType type, const void *indices, uint32_t count);
+static void MeshGL_Impl_update_indices(Mesh *self, uint32_t first, const void *indices, uint32_t count);
+static void MeshGL_Impl_draw(Mesh *self, uint32_t first, uint32_t count);
+static void MeshGL_Impl__destroy_(Mesh *self);
+
+
+// Перевести тип компонент атрибута в OpenGL:
+static inline uint32_t gl_attrib_type(MeshAttribType type) {
+    switch (type) {
+        case MESH_ATTRIB_BYTE:   return GL_BYTE;
+        case MESH_ATTRIB_UBYTE:  return GL_UNSIGNED_BYTE;
+        case MESH_ATTRIB_SHORT:  return GL_SHORT;
+        case MESH_ATTRIB_USHORT: return GL_UNSIGNED_SHORT;
+        case MESH_ATTRIB_INT:    return GL_INT;
+        case MESH_ATTRIB_UINT:   return GL_UNSIGNED_INT;
+        case MESH_ATTRIB_FLOAT:
+        default:                 return GL_FLOAT;
+    }
+}
+
+
+// Перевести частоту изменения в подсказку OpenGL:
+static inline uint32_t gl_usage(MeshUsage usage) {
+    switch (usage) {
+        case MESH_USAGE_DYNAMIC: return GL_DYNAMIC_DRAW;
+        case MESH_USAGE_STREAM:  return GL_STREAM_DRAW;
+        case MESH_USAGE_STATIC:
+        default:                 return GL_STATIC_DRAW;
+    }
+}
+
+
+// Размер индекса в байтах:
+static inline size_t index_size(RenderIndexType type) {
+    return type == RENDER_INDEX_U16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+
+// Целочисленный атрибут без нормализации читается в шейдере как целый (glVertexAttribIPointer):
+static inline bool is_integer_attrib(const MeshAttrib *attrib) {
+    return attrib->type != MESH_ATTRIB_FLOAT && !attrib->normalized;
+}
+
+
+// Пересчитать количество вершин для отрисовки (рисовать можно только вершины, которые есть во всех потоках):
+static void update_vertex_count(Mesh *mesh) {
+    uint32_t count = mesh->stream_count ? UINT32_MAX : 0;
+    for (uint32_t s = 0; s < mesh->stream_count; s++) {
+        if (mesh->vertex_counts[s] < count) count = mesh->vertex_counts[s];
+    }
+    mesh->vertex_count = count;
+}
+
+
+// Загрузить данные в привязанный буфер. Если места хватает, буфер не пересоздаётся, а у потокового
+// меша старое содержимое отбрасывается (orphaning), чтобы не ждать видеокарту:
+static void upload(uint32_t target, MeshUsage usage, size_t bytes, size_t capacity_bytes, const void *data) {
+    if (bytes > capacity_bytes || usage == MESH_USAGE_STATIC) {
+        glBufferData(target, (GLsizeiptr)bytes, data, gl_usage(usage));
+        return;
+    }
+    if (usage == MESH_USAGE_STREAM) glBufferData(target, (GLsizeiptr)capacity_bytes, NULL, gl_usage(usage));
+    if (data && bytes > 0) glBufferSubData(target, 0, (GLsizeiptr)bytes, data);
+}
+
+
+// Регистрируем функции реализации апи для меша:
+void MeshGL_RegisterAPI(Mesh *mesh) {
+    MeshGL_Data *data = mm_calloc_tagged(1, sizeof(MeshGL_Data), MM_TAG_RENDERER);
+    if (!data) mm_alloc_error();
+
+    // Буферы потоков и раскладка создаются один раз, дальше меняется только содержимое буферов:
+    glGenVertexArrays(1, &mesh->vertex_array);
+    glGenBuffers((GLsizei)mesh->stream_count, data->vbo);
+    StateGL_bind_vao(mesh->vertex_array);
+    for (uint32_t i = 0; i < mesh->layout.count; i++) {
+        const MeshAttrib *attrib = &mesh->layout.attribs[i];
+        StateGL_bind_buffer(GL_ARRAY_BUFFER, data->vbo[attrib->stream]);
+        GLsizei stride = (GLsizei)mesh->strides[attrib->stream];
+        void *offset = (void*)(size_t)attrib->offset;
+        if (is_integer_attrib(attrib)) {
+            glVertexAttribIPointer(attrib->location, (GLint)attrib->components, gl_attrib_type(attrib->type), stride, offset);
+        } else {
+            glVertexAttribPointer(
+                attrib->location, (GLint)attrib->components, gl_attrib_type(attrib->type),
+                attrib->normalized ? GL_TRUE : GL_FALSE, stride, offset
+            );
+        }
+        glEnableVertexAttribArray(attrib->location);
+    }
+    StateGL_bind_vao(0);
+
+    mesh->data = data;
+    mesh->set_vertices = MeshGL_Impl_set_vertices;
+    mesh->update_vertices = MeshGL_Impl_update_vertices;
+    mesh->set_indices = MeshGL_Impl_set_indices;
+    mesh->update_indices = MeshGL_Impl_update_indices;
+    mesh->draw = MeshGL_Impl_draw;
+    mesh->_destroy_ = MeshGL_Impl__destroy_;
+}
+
+
+// Реализация API:
+
+
+static void MeshGL_Impl_set_vertices(Mesh *self, uint32_t stream, const void *vertices, uint32_t count) {
+    if (!self || stream >= self->stream_count) return;
+    MeshGL_Data *data = (MeshGL_Data*)self->data;
+
+    size_t stride = self->strides[stream];
+    StateGL_bind_buffer(GL_ARRAY_BUFFER, data->vbo[stream]);
+    upload(GL_ARRAY_BUFFER, self->usage, count * stride, self->vertex_capacity[stream] * stride, vertices);
+    if (count > self->vertex_capacity[stream] || self->usage == MESH_USAGE_STATIC) {
+        self->vertex_capacity[stream] = count;
+    }
+    self->vertex_counts[stream] = count;
+    update_vertex_count(self);
+}
+
+
+static void MeshGL_Impl_update_vertices(Mesh *self, uint32_t stream, uint32_t first, const void *vertices, uint32_t count) {
+    if (!self || !vertices || stream >= self->stream_count || count == 0) return;
+    MeshGL_Data *data = (MeshGL_Data*)self->data;
+    if ((uint64_t)first + count > self->vertex_capacity[stream]) {
+        fprintf(stderr, "Mesh.update_vertices: Range is out of the buffer.\n");
+        return;
+    }
+
+    size_t stride = self->strides[stream];
+    StateGL_bind_buffer(GL_ARRAY_BUFFER, data->vbo[stream]);
+    glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(first * stride), (GLsizeiptr)(count * stride), vertices);
+    if (first + count > self->vertex_counts[stream]) {
+        self->vertex_counts[stream] = first + count;
+        update_vertex_count(self);
+    }
+}
+
+
+static void MeshGL_Impl_set_indices(Mesh *self, RenderIndexType type, const void *indices, uint32_t count) {
+    if (!self) return;
+    MeshGL_Data *data = (MeshGL_Data*)self->data;
+    if (type == RENDER_INDEX_NONE) {
+        self->index_type = RENDER_INDEX_NONE;
+        self->index_count = 0;
+        return;
+    }
+
+    // Индексный буфер запоминается в VAO, поэтому привязываем его при привязанной раскладке меша:
+    StateGL_bind_vao(self->vertex_array);
+    if (!data->ibo) glGenBuffers(1, &data->ibo);
+    StateGL_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, data->ibo);
+
+    // При смене типа индексов старая ёмкость в байтах остаётся, а в индексах - пересчитывается:
+    size_t capacity_bytes = self->index_type == RENDER_INDEX_NONE ? 0 : self->index_capacity * index_size(self->index_type);
+    size_t bytes = count * index_size(type);
+    upload(GL_ELEMENT_ARRAY_BUFFER, self->usage, bytes, capacity_bytes, indices);
+    if (bytes > capacity_bytes || self->usage == MESH_USAGE_STATIC) capacity_bytes = bytes;
+    StateGL_bind_vao(0);
+
+    self->index_type = type;
+    self->index_capacity = (uint32_t)(capacity_bytes / index_size(type));
+    self->index_count = count;
+}
+
+
+static void MeshGL_Impl_update_indices(Mesh *self, uint32_t first, const void *indices, uint32_t count) {
+    if (!self || !indices || count == 0 || self->index_type == RENDER_INDEX_NONE) return;
+    MeshGL_Data *data = (MeshGL_Data*)self->data;
+    if ((uint64_t)first + count > self->index_capacity) {
+        fprintf(stderr, "Mesh.update_indices: Range is out of the buffer.\n");
+        return;
+    }
+
+    size_t size = index_size(self->index_type);
+    StateGL_bind_vao(self->vertex_array);
+    StateGL_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, data->ibo);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)(first * size), (GLsizeiptr)(count * size), indices);
+    StateGL_bind_vao(0);
+    if (first + count > self->index_count) self->index_count = first + count;
+}
+
+
+static void MeshGL_Impl_draw(Mesh *self, uint32_t first, uint32_t count) {
+    if (!self) return;
+    uint32_t total = self->index_type == RENDER_INDEX_NONE ? self->vertex_count : self->index_count;
+    if (first >= total) return;
+    if (count == 0 || count > total - first) count = total - first;
+
+    StateGL_bind_vao(self->vertex_array);
+    uint32_t mode = RenderQueueGL_primitive(self->primitive);
+    if (self->index_type == RENDER_INDEX_NONE) {
+        glDrawArrays(mode, (GLint)first, (GLsizei)count);
+    } else {
+        bool u16 = self->index_type == RENDER_INDEX_U16;
+        size_t offset = (size_t)first * index_size(self->index_type);
+        glDrawElements(mode, (GLsizei)count, u16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)offset);
+    }
+}
+
+
+static void MeshGL_Impl__destroy_(Mesh *self) {
+    if (!self || !self->data) return;
+    MeshGL_Data *data = (MeshGL_Data*)self->data;
+
+    // Добавляем буферы в стек на уничтожение (удалятся в конце кадра, даже если меш ещё рисуется):
+    BufferGC_GL_push(BGC_GL_VAO, self->vertex_array);
+    for (uint32_t s = 0; s < self->stream_count; s++) BufferGC_GL_push(BGC_GL_VBO, data->vbo[s]);
+    if (data->ibo) BufferGC_GL_push(BGC_GL_IBO, data->ibo);
+    self->vertex_array = 0;
+    mm_free(data);
+    self->data = NULL;
+}
@@ -0,0 +1,25 @@
+//
+// mesh_gl.h
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stdint.h>
+#include "../../mesh.h"
+
+
+// Объявление структур:
+typedef struct MeshGL_Data MeshGL_Data;
+
+
+// Объекты OpenGL меша:
+typedef struct MeshGL_Data {
+    uint32_t vbo[MESH_MAX_STREAMS];  // Вершинные буферы потоков.
+    uint32_t ibo;                    // Индексный буфер (0 - ещё не создан).
+} MeshGL_Data;
+
+
+// Регистрируем функции реализации апи для меша:
+void MeshGL_RegisterAPI(Mesh *mesh);
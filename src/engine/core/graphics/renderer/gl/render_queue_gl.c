@@ -0,0 +1,112 @@
+//
+// render_queue_gl.c - Выполняет очередь команд рендеринга на OpenGL.
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../../../varray.h"
+#include "../../gl.h"
+#include "../../renderer.h"
+#include "../../shader.h"
+#include "../../texture.h"
+#include "../../render_queue.h"
+#include "state_gl.h"
+#include "texture_units_gl.h"
+#include "render_queue_gl.h"
+
+
+// Объявление функций:
+static void RenderQueueGL_Impl__execute_(RenderQueue *self);
+
+
+// Регистрируем функции реализации апи для очереди команд:
+void RenderQueueGL_RegisterAPI(RenderQueue *queue) {
+    queue->_execute_ = RenderQueueGL_Impl__execute_;
+    queue->_destroy_ = NULL;
+}
+
+
+// Применить прикреплённые к команде юниформы (загрузки без изменений отсекает кэш шейдера):
+static void apply_uniforms(ShaderProgram *shader, const RenderUniformValue *uniforms, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const RenderUniformValue *u = &uniforms[i];
+        switch (u->type) {
+            case RENDER_UNIFORM_INT:   shader->set_uniform_int_h(shader, u->uniform, u->vint); break;
+            case RENDER_UNIFORM_FLOAT: shader->set_uniform_float_h(shader, u->uniform, u->vfloat); break;
+            case RENDER_UNIFORM_VEC2:  shader->set_uniform_vec2_h(shader, u->uniform, (Vec2f){u->vec[0], u->vec[1]}); break;
+            case RENDER_UNIFORM_VEC3:  shader->set_uniform_vec3_h(shader, u->uniform, (Vec3f){u->vec[0], u->vec[1], u->vec[2]}); break;
+            case RENDER_UNIFORM_VEC4:  shader->set_uniform_vec4_h(shader, u->uniform, (Vec4f){u->vec[0], u->vec[1], u->vec[2], u->vec[3]}); break;
+            case RENDER_UNIFORM_MAT4:  shader->set_uniform_mat4_h(shader, u->uniform, (vec4*)u->mat); break;
+        }
+    }
+}
+
+
+// Реализация API:
+
+
+static void RenderQueueGL_Impl__execute_(RenderQueue *self) {
+    size_t count = VArray_len(self->sorted);
+    if (count == 0) return;
+
+    ShaderProgram *current = NULL;  // Активный шейдер (команды отсортированы, так что он меняется редко).
+    size_t texture_misses = texture_units_gl.misses;
+    for (size_t i = 0; i < count; i++) {
+        const RenderQueueItem *item = &VArray_at(self->sorted, RenderQueueItem, i);
+        RenderCommand *command = RenderQueue_get_command(self, item);
+        const RenderTextureBinding *textures = (const RenderTextureBinding*)(command + 1);
+        const RenderUniformValue *uniforms = (const RenderUniformValue*)(textures + command->texture_count);
+
+        // Состояние (повторные установки отсекает StateGL):
+        StateGL_set_blend(command->state & RENDER_STATE_BLEND);
+        StateGL_set_depth_test(command->state & RENDER_STATE_DEPTH_TEST);
+
+        // Отрисовка экземплярами сама включает свой шейдер и привязывает текстуру:
+        if (command->type == RENDER_CMD_DRAW_INSTANCED) {
+            if (current) current->end(current);
+            current = NULL;
+            Texture *texture = command->texture_count > 0 ? textures[0].texture : NULL;
+            self->renderer->draw_instanced(
+                self->renderer, command->instanced.mesh, (const RendererInstance*)(uniforms + command->uniform_count),
+                command->instanced.count, texture, command->shader
+            );
+            self->commands++;
+            continue;
+        }
+
+        // Обычная отрисовка:
+        ShaderProgram *shader = command->shader;
+        if (!shader) continue;
+        if (shader != current) {
+            if (current) current->end(current);
+            shader->begin(shader);
+            current = shader;
+            self->shader_switches++;
+        }
+        for (uint32_t t = 0; t < command->texture_count; t++) {
+            shader->set_sampler2d_h(shader, textures[t].sampler, textures[t].texture);
+        }
+        apply_uniforms(shader, uniforms, command->uniform_count);
+
+        StateGL_bind_vao(command->draw.vertex_array);
+        uint32_t mode = RenderQueueGL_primitive(command->draw.primitive);
+        int instances = (int)command->draw.instances;
+        if (command->draw.index_type == RENDER_INDEX_NONE) {
+            glDrawArraysInstanced(mode, (int)command->draw.first, (int)command->draw.count, instances);
+        } else {
+            bool u16 = command->draw.index_type == RENDER_INDEX_U16;
+            size_t offset = (size_t)command->draw.first * (u16 ? sizeof(uint16_t) : sizeof(uint32_t));
+            glDrawElementsInstanced(
+                mode, (int)command->draw.count, u16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)offset, instances
+            );
+        }
+        self->commands++;
+    }
+    if (current) current->end(current);
+    StateGL_bind_vao(0);
+    self->texture_switches = texture_units_gl.misses - texture_misses;  // Сколько раз текстуру пришлось привязывать.
+}
@@ -0,0 +1,32 @@
+//
+// render_queue_gl.h
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stdint.h>
+#include "../../gl.h"
+#include "../../render_queue.h"
+
+
+// Объявление структур:
+typedef struct RenderQueue RenderQueue;
+
+
+// Регистрируем функции реализации апи для очереди команд:
+void RenderQueueGL_RegisterAPI(RenderQueue *queue);
+
+
+// Перевести примитив в OpenGL:
+static inline uint32_t RenderQueueGL_primitive(RenderPrimitive primitive) {
+    switch (primitive) {
+        case RENDER_POINTS:         return GL_POINTS;
+        case RENDER_LINES:          return GL_LINES;
+        case RENDER_LINE_STRIP:     return GL_LINE_STRIP;
+        case RENDER_TRIANGLE_STRIP: return GL_TRIANGLE_STRIP;
+        case RENDER_TRIANGLES:
+        default:                    return GL_TRIANGLES;
+    }
+}
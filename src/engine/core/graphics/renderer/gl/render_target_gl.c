@@ -0,0 +1,318 @@
+//
+// render_target_gl.c - Реализует цели отрисовки на OpenGL (кадровые буферы).
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../../../mm/mm.h"
+#include "../../gl.h"
+#include "../../texture.h"
+#include "../../render_target.h"
+#include "buffer_gc_gl.h"
+#include "state_gl.h"
+#include "render_target_gl.h"
+
+
+// Объявление функций:
+static void RenderTargetGL_Impl_begin(RenderTarget *self);
+static void RenderTargetGL_Impl_end(RenderTarget *self);
+static void RenderTargetGL_Impl_resolve(RenderTarget *self);
+static void RenderTargetGL_Impl_blit(RenderTarget *self, RenderTarget *dst, bool linear);
+static void RenderTargetGL_Impl__destroy_(RenderTarget *self);
+
+
+// Точки прикрепления цвета по порядку (для glDrawBuffers):
+static const uint32_t COLOR_ATTACHMENTS[RENDER_TARGET_MAX_COLORS] = {
+    GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3,
+};
+
+
+// Внутренний формат цвета (у буферов MSAA и текстур он должен совпадать, поэтому только форматы с размером):
+static uint32_t gl_color_format(TextureFormat format) {
+    switch (format) {
+        case TEX_RED:     return GL_R8;
+        case TEX_RG:      return GL_RG8;
+        case TEX_RGB:     return GL_RGB8;
+        case TEX_RGB16F:  return GL_RGB16F;
+        case TEX_RGBA16F: return GL_RGBA16F;
+        case TEX_RGB32F:  return GL_RGB32F;
+        case TEX_RGBA32F: return GL_RGBA32F;
+        case TEX_R16F:    return GL_R16F;
+        case TEX_SRGB:    return GL_SRGB8;
+        case TEX_SRGBA:   return GL_SRGB8_ALPHA8;
+        case TEX_RGBA:
+        default:          return GL_RGBA8;
+    }
+}
+
+
+// Внутренний формат глубины:
+static uint32_t gl_depth_format(RenderTargetDepth depth) {
+    switch (depth) {
+        case RENDER_TARGET_DEPTH_24_S8: return GL_DEPTH24_STENCIL8;
+        case RENDER_TARGET_DEPTH_32F:   return GL_DEPTH_COMPONENT32F;
+        case RENDER_TARGET_DEPTH_24:
+        default:                        return GL_DEPTH_COMPONENT24;
+    }
+}
+
+
+// Точка прикрепления глубины:
+static inline uint32_t gl_depth_attachment(RenderTargetDepth depth) {
+    return depth == RENDER_TARGET_DEPTH_24_S8 ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+}
+
+
+// Создать текстуру цели (берётся из пула BufferGC, если там есть такая же):
+static Texture* create_texture(RenderTarget *target, uint32_t internal, uint32_t format, uint32_t type) {
+    Texture *texture = Texture_create(target->renderer);
+    if (!texture) return NULL;
+    texture->width = target->desc.width;
+    texture->height = target->desc.height;
+    texture->_pool_key_ = BufferGC_GL_texture_key(texture->width, texture->height, internal, false);
+
+    // Содержимое текстуры из пула неважно, а хранилище у неё уже нужного размера и формата:
+    texture->id = BufferGC_GL_reuse(BGC_GL_TBO, texture->_pool_key_);
+    bool reused = texture->id != 0;
+    if (!reused) glGenTextures(1, &texture->id);
+    texture->begin(texture);
+    if (!reused) glTexImage2D(GL_TEXTURE_2D, 0, (GLint)internal, texture->width, texture->height, 0, format, type, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    texture->end(texture);
+    return texture;
+}
+
+
+// Создать внутренний буфер (samples 1 - обычный):
+static uint32_t create_renderbuffer(uint32_t internal, int width, int height, uint32_t samples) {
+    uint32_t rbo = 0;
+    glGenRenderbuffers(1, &rbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+    if (samples > 1) glRenderbufferStorageMultisample(GL_RENDERBUFFER, (GLsizei)samples, internal, width, height);
+    else glRenderbufferStorage(GL_RENDERBUFFER, internal, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    return rbo;
+}
+
+
+// Указать буферы цвета для рисования и чтения (кадровый буфер должен быть привязан к GL_FRAMEBUFFER):
+static void set_draw_buffers(uint32_t color_count) {
+    if (color_count == 0) {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        return;
+    }
+    glDrawBuffers((GLsizei)color_count, COLOR_ATTACHMENTS);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+}
+
+
+// Проверить, собран ли привязанный кадровый буфер:
+static bool check_framebuffer(const char *name) {
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status == GL_FRAMEBUFFER_COMPLETE) return true;
+    fprintf(stderr, "RenderTarget_create: The %s framebuffer is incomplete (0x%x).\n", name, status);
+    return false;
+}
+
+
+// Узнать текущую область просмотра (из теневой копии или у OpenGL):
+static void get_viewport(int32_t viewport[4]) {
+    if (!state_gl.viewport_known) {
+        glGetIntegerv(GL_VIEWPORT, state_gl.viewport);
+        state_gl.viewport_known = true;
+    }
+    for (int i = 0; i < 4; i++) viewport[i] = state_gl.viewport[i];
+}
+
+
+// Узнать текущий кадровый буфер для рисования (из теневой копии или у OpenGL):
+static uint32_t get_draw_framebuffer() {
+    if (state_gl.draw_framebuffer == STATE_GL_UNKNOWN) {
+        GLint fbo = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &fbo);
+        state_gl.draw_framebuffer = (uint32_t)fbo;
+    }
+    return state_gl.draw_framebuffer;
+}
+
+
+// Регистрируем функции реализации апи для цели отрисовки (false - кадровый буфер не собрался):
+bool RenderTargetGL_RegisterAPI(RenderTarget *target) {
+    RenderTargetGL_Data *data = mm_calloc_tagged(1, sizeof(RenderTargetGL_Data), MM_TAG_RENDERER);
+    if (!data) mm_alloc_error();
+    target->data = data;
+    target->begin = RenderTargetGL_Impl_begin;
+    target->end = RenderTargetGL_Impl_end;
+    target->resolve = RenderTargetGL_Impl_resolve;
+    target->blit = RenderTargetGL_Impl_blit;
+    target->_destroy_ = RenderTargetGL_Impl__destroy_;
+
+    const RenderTargetDesc *desc = &target->desc;
+    bool msaa = desc->samples > 1;
+    uint32_t prev_read = state_gl.read_framebuffer;
+    uint32_t prev_draw = get_draw_framebuffer();
+
+    // Кадровый буфер с текстурами (с MSAA в него попадает результат resolve):
+    glGenFramebuffers(1, &target->id);
+    StateGL_bind_framebuffer(GL_FRAMEBUFFER, target->id);
+    uint32_t color_internal = gl_color_format(desc->color_format);
+    bool is_float = desc->color_format == TEX_RGB16F || desc->color_format == TEX_RGBA16F ||
+                    desc->color_format == TEX_RGB32F || desc->color_format == TEX_RGBA32F || desc->color_format == TEX_R16F;
+    for (uint32_t i = 0; i < desc->color_count; i++) {
+        target->colors[i] = create_texture(target, color_internal, GL_RGBA, is_float ? GL_FLOAT : GL_UNSIGNED_BYTE);
+        if (target->colors[i]) glFramebufferTexture2D(GL_FRAMEBUFFER, COLOR_ATTACHMENTS[i], GL_TEXTURE_2D, target->colors[i]->id, 0);
+    }
+    if (desc->depth != RENDER_TARGET_DEPTH_NONE) {
+        uint32_t depth_internal = gl_depth_format(desc->depth);
+        if (desc->depth_texture) {
+            bool stencil = desc->depth == RENDER_TARGET_DEPTH_24_S8;
+            target->depth = create_texture(
+                target, depth_internal, stencil ? GL_DEPTH_STENCIL : GL_DEPTH_COMPONENT,
+                stencil ? GL_UNSIGNED_INT_24_8 : GL_FLOAT
+            );
+            if (target->depth) {
+                glFramebufferTexture2D(GL_FRAMEBUFFER, gl_depth_attachment(desc->depth), GL_TEXTURE_2D, target->depth->id, 0);
+            }
+        } else if (!msaa) {
+            data->depth_rbo = create_renderbuffer(depth_internal, desc->width, desc->height, 1);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, gl_depth_attachment(desc->depth), GL_RENDERBUFFER, data->depth_rbo);
+        }
+    }
+    set_draw_buffers(desc->color_count);
+    bool complete = check_framebuffer("resolve");
+
+    // Многовыборочный кадровый буфер, в который идёт рисование при MSAA:
+    if (msaa && complete) {
+        glGenFramebuffers(1, &data->msaa_fbo);
+        StateGL_bind_framebuffer(GL_FRAMEBUFFER, data->msaa_fbo);
+        for (uint32_t i = 0; i < desc->color_count; i++) {
+            data->msaa_colors[i] = create_renderbuffer(color_internal, desc->width, desc->height, desc->samples);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, COLOR_ATTACHMENTS[i], GL_RENDERBUFFER, data->msaa_colors[i]);
+        }
+        if (desc->depth != RENDER_TARGET_DEPTH_NONE) {
+            data->depth_rbo = create_renderbuffer(gl_depth_format(desc->depth), desc->width, desc->height, desc->samples);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, gl_depth_attachment(desc->depth), GL_RENDERBUFFER, data->depth_rbo);
+        }
+        set_draw_buffers(desc->color_count);
+        complete = check_framebuffer("multisample");
+    }
+
+    StateGL_bind_framebuffer(GL_DRAW_FRAMEBUFFER, prev_draw);
+    if (prev_read != STATE_GL_UNKNOWN) StateGL_bind_framebuffer(GL_READ_FRAMEBUFFER, prev_read);
+    return complete;
+}
+
+
+// Реализация API:
+
+
+static void RenderTargetGL_Impl_begin(RenderTarget *self) {
+    if (!self || self->_is_begin_) return;
+    RenderTargetGL_Data *data = (RenderTargetGL_Data*)self->data;
+    data->prev_framebuffer = get_draw_framebuffer();
+    get_viewport(data->prev_viewport);
+
+    StateGL_bind_framebuffer(GL_FRAMEBUFFER, data->msaa_fbo ? data->msaa_fbo : self->id);
+    StateGL_set_viewport(0, 0, self->desc.width, self->desc.height);
+    data->dirty = true;
+    self->_is_begin_ = true;
+}
+
+
+static void RenderTargetGL_Impl_end(RenderTarget *self) {
+    if (!self || !self->_is_begin_) return;
+    RenderTargetGL_Data *data = (RenderTargetGL_Data*)self->data;
+    self->_is_begin_ = false;
+    self->resolve(self);
+
+    StateGL_bind_framebuffer(GL_FRAMEBUFFER, data->prev_framebuffer);
+    StateGL_set_viewport(data->prev_viewport[0], data->prev_viewport[1], data->prev_viewport[2], data->prev_viewport[3]);
+}
+
+
+static void RenderTargetGL_Impl_resolve(RenderTarget *self) {
+    if (!self) return;
+    RenderTargetGL_Data *data = (RenderTargetGL_Data*)self->data;
+    if (!data->msaa_fbo || !data->dirty) return;
+
+    uint32_t prev_draw = get_draw_framebuffer();
+    uint32_t prev_read = state_gl.read_framebuffer;
+    int w = self->desc.width, h = self->desc.height;
+    StateGL_bind_framebuffer(GL_READ_FRAMEBUFFER, data->msaa_fbo);
+    StateGL_bind_framebuffer(GL_DRAW_FRAMEBUFFER, self->id);
+
+    // Каждую текстуру цвета переносим отдельно (blit берёт один буфер чтения), глубину - вместе с первой:
+    for (uint32_t i = 0; i < self->desc.color_count; i++) {
+        GLbitfield mask = GL_COLOR_BUFFER_BIT;
+        if (i == 0 && self->depth) mask |= GL_DEPTH_BUFFER_BIT;
+        glReadBuffer(COLOR_ATTACHMENTS[i]);
+        glDrawBuffers(1, &COLOR_ATTACHMENTS[i]);
+        glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, mask, GL_NEAREST);
+    }
+    if (self->desc.color_count == 0 && self->depth) {
+        glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
+
+    // Возвращаем буферы рисования и чтения обоих кадровых буферов:
+    if (self->desc.color_count > 1) {
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glDrawBuffers((GLsizei)self->desc.color_count, COLOR_ATTACHMENTS);
+    }
+    StateGL_bind_framebuffer(GL_DRAW_FRAMEBUFFER, prev_draw);
+    if (prev_read != STATE_GL_UNKNOWN) StateGL_bind_framebuffer(GL_READ_FRAMEBUFFER, prev_read);
+    data->dirty = false;
+}
+
+
+static void RenderTargetGL_Impl_blit(RenderTarget *self, RenderTarget *dst, bool linear) {
+    if (!self || self->desc.color_count == 0 || dst == self) return;
+    self->resolve(self);
+
+    // Область назначения - вся цель или текущая область просмотра окна:
+    int32_t rect[4] = {0, 0, 0, 0};
+    if (dst) {
+        rect[2] = dst->desc.width;
+        rect[3] = dst->desc.height;
+    } else {
+        get_viewport(rect);
+    }
+
+    uint32_t prev_draw = get_draw_framebuffer();
+    uint32_t prev_read = state_gl.read_framebuffer;
+    StateGL_bind_framebuffer(GL_READ_FRAMEBUFFER, self->id);
+    StateGL_bind_framebuffer(GL_DRAW_FRAMEBUFFER, dst ? dst->id : 0);
+    glBlitFramebuffer(
+        0, 0, self->desc.width, self->desc.height, rect[0], rect[1], rect[0] + rect[2], rect[1] + rect[3],
+        GL_COLOR_BUFFER_BIT, linear ? GL_LINEAR : GL_NEAREST
+    );
+    StateGL_bind_framebuffer(GL_DRAW_FRAMEBUFFER, prev_draw);
+    if (prev_read != STATE_GL_UNKNOWN) StateGL_bind_framebuffer(GL_READ_FRAMEBUFFER, prev_read);
+}
+
+
+static void RenderTargetGL_Impl__destroy_(RenderTarget *self) {
+    if (!self || !self->data) return;
+    RenderTargetGL_Data *data = (RenderTargetGL_Data*)self->data;
+    if (self->_is_begin_) self->end(self);
+
+    // Добавляем объекты в стеки на уничтожение, текстуры уходят в пул BufferGC (если он включён):
+    if (self->id) BufferGC_GL_push(BGC_GL_FBO, self->id);
+    if (data->msaa_fbo) BufferGC_GL_push(BGC_GL_FBO, data->msaa_fbo);
+    for (uint32_t i = 0; i < RENDER_TARGET_MAX_COLORS; i++) {
+        if (data->msaa_colors[i]) BufferGC_GL_push(BGC_GL_RBO, data->msaa_colors[i]);
+        Texture_destroy(&self->colors[i]);
+    }
+    if (data->depth_rbo) BufferGC_GL_push(BGC_GL_RBO, data->depth_rbo);
+    Texture_destroy(&self->depth);
+    self->id = 0;
+    mm_free(data);
+    self->data = NULL;
+}
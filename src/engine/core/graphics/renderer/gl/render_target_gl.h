@@ -0,0 +1,32 @@
+//
+// render_target_gl.h
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stdint.h>
+#include <stdbool.h>
+#include "../../render_target.h"
+
+
+// Объявление структур:
+typedef struct RenderTargetGL_Data RenderTargetGL_Data;
+
+
+// Объекты OpenGL цели отрисовки:
+typedef struct RenderTargetGL_Data {
+    uint32_t msaa_fbo;    // Многовыборочный кадровый буфер (0 - без MSAA).
+    uint32_t msaa_colors[RENDER_TARGET_MAX_COLORS];  // Многовыборочные буферы цвета.
+    uint32_t depth_rbo;   // Внутренний буфер глубины (многовыборочный при MSAA, 0 - нет).
+    bool dirty;           // В многовыборочные буферы рисовали после последнего resolve.
+
+    // Что было до begin (восстанавливается в end):
+    uint32_t prev_framebuffer;
+    int32_t prev_viewport[4];
+} RenderTargetGL_Data;
+
+
+// Регистрируем функции реализации апи для цели отрисовки (false - кадровый буфер не собрался):
+bool RenderTargetGL_RegisterAPI(RenderTarget *target);
@@ -8,52 +8,98 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 #include "../../../math.h"
 #include "../../../mm/mm.h"
+#include "../../../mm/frame.h"
 #include "../../renderer.h"
 #include "../../gl.h"
 #include "../../camera.h"
 #include "../../shader.h"
+#include "../../shader_preproc.h"
+#include "../../texture.h"
 #include "buffer_gc_gl.h"
+#include "state_gl.h"
+#include "stream_buffer_gl.h"
+#include "texture_units_gl.h"
 #include "renderer_gl.h"
 
 
-// Стандартные шейдеры рендеринга:
+// Сколько байт экземпляров помещается в сегмент потокового буфера без его роста (4096 экземпляров):
+#define RENDERER_INSTANCE_STREAM_SIZE (4096 * sizeof(RendererInstance))
+
+
+// Стандартные шейдеры рендеринга (варианты собираются по RendererShaderFlags):
 static const char* DEFAULT_SHD_VERT = \
 "#version 330 core\n"
+"#include \"" RENDERER_FRAME_DATA_INCLUDE "\"\n"
 "uniform mat4 u_model = mat4(1.0);\n"
-"uniform mat4 u_view = mat4(1.0);\n"
-"uniform mat4 u_proj = mat4(1.0);\n"
 "layout (location = 0) in vec3 a_position;\n"
 "layout (location = 1) in vec2 a_texcoord;\n"
 "out vec2 TexCoord;\n"
+"#ifdef USE_VERTEX_COLOR\n"
+"layout (location = 2) in vec4 a_color;\n"
+"#endif\n"
+"#ifdef USE_INSTANCED\n"
+"layout (location = 3) in vec4 i_position;  // xyz - позиция, w - поворот.\n"
+"layout (location = 4) in vec2 i_scale;\n"
+"layout (location = 5) in vec4 i_color;\n"
+"#endif\n"
+"#if defined(USE_VERTEX_COLOR) || defined(USE_INSTANCED)\n"
+"out vec4 VertColor;\n"
+"#endif\n"
 "void main(void) {\n"
-"    gl_Position = u_proj * u_view * u_model * vec4(a_position, 1.0);\n"
+"#ifdef USE_INSTANCED\n"
+"    // Трансформация экземпляра: масштаб, поворот, сдвиг:\n"
+"    vec2 scaled = a_position.xy * i_scale;\n"
+"    float c = cos(i_position.w), s = sin(i_position.w);\n"
+"    vec3 position = vec3(c*scaled.x - s*scaled.y, s*scaled.x + c*scaled.y, a_position.z) + i_position.xyz;\n"
+"    gl_PointSize = i_scale.x;\n"
+"#else\n"
+"    vec3 position = a_position;\n"
+"#endif\n"
+"    gl_Position = u_view_proj * u_model * vec4(position, 1.0);\n"
 "    TexCoord = a_texcoord;\n"
+"#if defined(USE_VERTEX_COLOR) && defined(USE_INSTANCED)\n"
+"    VertColor = a_color * i_color;\n"
+"#elif defined(USE_VERTEX_COLOR)\n"
+"    VertColor = a_color;\n"
+"#elif defined(USE_INSTANCED)\n"
+"    VertColor = i_color;\n"
+"#endif\n"
 "}\n";
 
 static const char* DEFAULT_SHD_FRAG = \
 "#version 330 core\n"
-"uniform bool u_use_points = false;\n"
-"uniform bool u_use_texture;\n"
 "uniform vec4 u_color = vec4(1.0);\n"
+"#ifdef USE_TEXTURE\n"
 "uniform sampler2D u_texture;\n"
+"#endif\n"
 "in vec2 TexCoord;\n"
+"#if defined(USE_VERTEX_COLOR) || defined(USE_INSTANCED)\n"
+"in vec4 VertColor;\n"
+"#endif\n"
 "out vec4 FragColor;\n"
 "void main(void) {\n"
-"    // Если мы используем точки для рисования:\n"
-"    if (u_use_points) {\n"
-"        vec2 coord = gl_PointCoord*2.0-1.0;\n"
-"        if (dot(coord, coord) > 1.0) discard;  // Отбрасываем всё за пределами круга.\n"
-"    }\n"
-"    // Если мы используем текстуру, рисуем с ней, иначе только цвет:\n"
-"    if (u_use_texture) {\n"
-"        FragColor = u_color * texture(u_texture, TexCoord);\n"
-"    } else {\n"
-"        FragColor = u_color;\n"
-"    }\n"
+"#ifdef USE_POINTS\n"
+"    // Рисуем точки кругами:\n"
+"    vec2 coord = gl_PointCoord*2.0-1.0;\n"
+"    if (dot(coord, coord) > 1.0) discard;  // Отбрасываем всё за пределами круга.\n"
+"#endif\n"
+"#ifdef USE_TEXTURE\n"
+"    FragColor = u_color * texture(u_texture, TexCoord);\n"
+"#else\n"
+"    FragColor = u_color;\n"
+"#endif\n"
+"#if defined(USE_VERTEX_COLOR) || defined(USE_INSTANCED)\n"
+"    FragColor *= VertColor;\n"
+"#endif\n"
 "}\n";
 
+// Имена флагов вариантов (бит i в RendererShaderFlags -> #define DEFAULT_SHD_FLAGS[i]):
+static const char* DEFAULT_SHD_FLAGS[] = {"USE_TEXTURE", "USE_POINTS", "USE_VERTEX_COLOR", "USE_INSTANCED"};
+#define DEFAULT_SHD_VARIANTS (1u << (sizeof(DEFAULT_SHD_FLAGS) / sizeof(DEFAULT_SHD_FLAGS[0])))
+
 
 // Объявление функций:
 static void RendererGL_Impl_init(Renderer *self);
@@ -62,6 +108,11 @@ static void RendererGL_Impl_buffers_flush(Renderer *self);
 static void RendererGL_Impl_camera2d_update(Renderer *self);
 static void RendererGL_Impl_camera3d_update(Renderer *self);
 static void RendererGL_Impl_viewport_resize(Renderer *self, int x, int y, int width, int height);
+static void RendererGL_Impl_update_view_proj(Renderer *self, mat4 view, mat4 proj);
+static void RendererGL_Impl_set_time(Renderer *self, float time);
+static ShaderProgram* RendererGL_Impl_get_default_shader(Renderer *self, uint32_t flags);
+static void RendererGL_Impl_draw_instanced(Renderer *self, RendererMesh mesh, const RendererInstance *instances, size_t count,
+                                           Texture *texture, ShaderProgram *shader);
 
 
 // Регистрируем функции реализации апи:
@@ -72,16 +123,20 @@ static void RendererGL_RegisterAPI(Renderer *self) {
     self->camera2d_update = RendererGL_Impl_camera2d_update;
     self->camera3d_update = RendererGL_Impl_camera3d_update;
     self->viewport_resize = RendererGL_Impl_viewport_resize;
+    self->update_view_proj = RendererGL_Impl_update_view_proj;
+    self->set_time = RendererGL_Impl_set_time;
+    self->get_default_shader = RendererGL_Impl_get_default_shader;
+    self->draw_instanced = RendererGL_Impl_draw_instanced;
 }
 
 
 // Создать рендерер:
 Renderer* RendererGL_create(int major, int minor, bool doublebuffer, RendererGL_Profile profile) {
-    Renderer *renderer = (Renderer*)mm_alloc(sizeof(Renderer));
+    Renderer *renderer = (Renderer*)mm_alloc_tagged(sizeof(Renderer), MM_TAG_RENDERER);
     if (!renderer) mm_alloc_error();
 
     // Создаём данные рендерера:
-    RendererGL_Data *data = (RendererGL_Data*)mm_calloc(1, sizeof(RendererGL_Data));
+    RendererGL_Data *data = (RendererGL_Data*)mm_calloc_tagged(1, sizeof(RendererGL_Data), MM_TAG_RENDERER);
     if (!data) mm_alloc_error();
 
     // Заполняем поля данных:
@@ -89,28 +144,38 @@ Renderer* RendererGL_create(int major, int minor, bool doublebuffer, RendererGL_
     data->minor = minor;
     data->doublebuffer = doublebuffer;
     data->profile = profile;
+    data->frame_ubo = 0;
+    glm_mat4_identity((vec4*)data->frame_data.view);
+    glm_mat4_identity((vec4*)data->frame_data.proj);
+    glm_mat4_identity((vec4*)data->frame_data.view_proj);
 
     // Заполняем поля рендерера:
     renderer->name = "OpenGL";
     renderer->type = RENDERER_OPENGL;
     renderer->default_shader = NULL;
+    renderer->default_shaders = NULL;
     renderer->camera = NULL;
     renderer->data = data;
 
     // Инициализация стеков буферов:
     BufferGC_GL_init();
 
-    // Создаём шейдер:
-    ShaderProgram *default_shader = ShaderProgram_create(renderer, DEFAULT_SHD_VERT, DEFAULT_SHD_FRAG, NULL);
-    if (!default_shader || default_shader->get_error(default_shader)) {
-        fprintf(stderr, "RENDERER_GL-FAIL: Creating default shader failed: %s\n", default_shader->error);
+    // Общие подключаемые файлы шейдеров:
+    ShaderPreproc_register_include(RENDERER_FRAME_DATA_INCLUDE, RENDERER_FRAME_DATA_GLSL);
+
+    // Создаём варианты дефолтного шейдера (компилируются при инициализации):
+    ShaderVariants *default_shaders = ShaderVariants_create(
+        renderer, DEFAULT_SHD_VERT, DEFAULT_SHD_FRAG, NULL,
+        DEFAULT_SHD_FLAGS, sizeof(DEFAULT_SHD_FLAGS) / sizeof(DEFAULT_SHD_FLAGS[0])
+    );
+    if (!default_shaders) {
+        fprintf(stderr, "RENDERER_GL-FAIL: Creating default shader failed.\n");
         // Самоуничтожение при провале создания шейдера:
-        ShaderProgram_destroy(&default_shader);
         mm_free(data);
         mm_free(renderer);
         return NULL;
     }
-    renderer->default_shader = default_shader;
+    renderer->default_shaders = default_shaders;
 
     // Регистрируем функции:
     RendererGL_RegisterAPI(renderer);
@@ -125,6 +190,13 @@ void RendererGL_destroy(Renderer **self) {
 
     // Освобождаем память данных рендерера:
     if ((*self)->data) {
+        RendererGL_Data *data = (RendererGL_Data*)(*self)->data;
+        if (data->frame_ubo) BufferGC_GL_push(BGC_GL_VBO, data->frame_ubo);
+        for (int i = 0; i < RENDERER_MESH_COUNT; i++) {
+            if (data->mesh_vao[i]) BufferGC_GL_push(BGC_GL_VAO, data->mesh_vao[i]);
+        }
+        if (data->mesh_vbo) BufferGC_GL_push(BGC_GL_VBO, data->mesh_vbo);
+        StreamBufferGL_destroy(&data->instances);
         mm_free((*self)->data);
         (*self)->data = NULL;
     }
@@ -133,10 +205,16 @@ void RendererGL_destroy(Renderer **self) {
     BufferGC_GL_flush();
     BufferGC_GL_destroy();
 
-    // Освобождаем память шейдера:
-    if ((*self)->default_shader) {
-        ShaderProgram_destroy(&(*self)->default_shader);
-    }
+    // Уничтожаем кадровый аллокатор (цикл окна уже завершён):
+    mm_frame_destroy();
+
+    // Освобождаем память шейдеров (дефолтный шейдер - один из вариантов):
+    ShaderVariants_destroy(&(*self)->default_shaders);
+    (*self)->default_shader = NULL;
+    ShaderPreproc_destroy();
+
+    // Освобождаем пул структур текстур (все текстуры уже уничтожены):
+    Texture_destroy_pool();
 
     // Освободить память рендерера:
     mm_free(*self);
@@ -151,6 +229,55 @@ void RendererGL_destroy(Renderer **self) {
 // }
 
 
+// Вершины встроенных мешей (позиция xyz, текстурные координаты uv):
+static const float MESH_VERTICES[] = {
+    // RENDERER_MESH_QUAD (GL_TRIANGLE_STRIP):
+    -0.5f, -0.5f, 0.0f,  0.0f, 0.0f,
+     0.5f, -0.5f, 0.0f,  1.0f, 0.0f,
+    -0.5f,  0.5f, 0.0f,  0.0f, 1.0f,
+     0.5f,  0.5f, 0.0f,  1.0f, 1.0f,
+    // RENDERER_MESH_POINT (GL_POINTS):
+     0.0f,  0.0f, 0.0f,  0.5f, 0.5f,
+};
+
+// Где лежит каждый встроенный меш и как он рисуется:
+static const struct { uint32_t mode; int first; int count; } MESH_RANGES[RENDERER_MESH_COUNT] = {
+    [RENDERER_MESH_QUAD]  = {GL_TRIANGLE_STRIP, 0, 4},
+    [RENDERER_MESH_POINT] = {GL_POINTS,         4, 1},
+};
+
+
+// Создать встроенные меши и их раскладки с атрибутами экземпляров:
+static void create_instancing(RendererGL_Data *data) {
+    glGenBuffers(1, &data->mesh_vbo);
+    glGenVertexArrays(RENDERER_MESH_COUNT, data->mesh_vao);
+    data->instances = StreamBufferGL_create(GL_ARRAY_BUFFER, RENDERER_INSTANCE_STREAM_SIZE);
+
+    StateGL_bind_buffer(GL_ARRAY_BUFFER, data->mesh_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(MESH_VERTICES), MESH_VERTICES, GL_STATIC_DRAW);
+
+    // Меши лежат в одном буфере, поэтому раскладки у них одинаковые, а отличаются только диапазоны:
+    for (int i = 0; i < RENDERER_MESH_COUNT; i++) {
+        StateGL_bind_vao(data->mesh_vao[i]);
+
+        // Вершины меша:
+        StateGL_bind_buffer(GL_ARRAY_BUFFER, data->mesh_vbo);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // Атрибуты экземпляров (делитель 1 - одно значение на экземпляр). Указатели на них задаются
+        // при каждой отрисовке, потому что экземпляры лежат в потоковом буфере каждый раз по новому смещению:
+        for (uint32_t attr = 3; attr <= 5; attr++) {
+            glEnableVertexAttribArray(attr);
+            glVertexAttribDivisor(attr, 1);
+        }
+    }
+    StateGL_bind_vao(0);
+}
+
+
 // Реализация API:
 
 
@@ -161,17 +288,19 @@ static void RendererGL_Impl_init(Renderer *self) {
         return;
     }
 
-    glEnable(GL_BLEND);  // Включаем смешивание цветов.
+    StateGL_init();  // Контекст свежий, его состояние по умолчанию известно.
+    TextureUnitsGL_init();  // Узнаём, сколько текстурных юнитов можно раздавать.
+
+    StateGL_set_blend(true);  // Включаем смешивание цветов.
 
     // Устанавливаем режим смешивания:
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StateGL_set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Разрешаем установку размера точки через шейдер:
     glEnable(GL_PROGRAM_POINT_SIZE);
 
-    // Делаем нулевой текстурный юнит привязанным к нулевой текстуре:
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Делаем нулевой текстурный юнит (зарезервирован под begin/end текстур) привязанным к нулевой текстуре:
+    StateGL_bind_texture(0, 0);
 
     // Включаем отладку OpenGL:
     // < ВЫРЕЗАНО на будущее внедрение. Сейчас не работает должным образом! >
@@ -183,8 +312,24 @@ static void RendererGL_Impl_init(Renderer *self) {
     //     printf("glDebugMessageCallback not available.\n");
     // }
 
-    // Компилируем дефолтный шейдер:
-    self->default_shader->compile(self->default_shader);
+    // Создаём буфер данных кадра и привязываем его к общей точке привязки блока:
+    RendererGL_Data *data = (RendererGL_Data*)self->data;
+    glGenBuffers(1, &data->frame_ubo);
+    StateGL_bind_buffer(GL_UNIFORM_BUFFER, data->frame_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(RendererFrameData), &data->frame_data, GL_DYNAMIC_DRAW);
+    StateGL_bind_buffer_base(GL_UNIFORM_BUFFER, RENDERER_FRAME_DATA_BINDING, data->frame_ubo);
+
+    // Создаём встроенные меши для отрисовки экземплярами:
+    create_instancing(data);
+
+    // Отправляем все варианты дефолтного шейдера на компиляцию разом, потом дожидаемся основного:
+    for (uint32_t flags = 0; flags < DEFAULT_SHD_VARIANTS; flags++) {
+        ShaderVariants_precompile(self->default_shaders, flags);
+    }
+    self->default_shader = ShaderVariants_get(self->default_shaders, 0);
+    if (!self->default_shader || self->default_shader->get_error(self->default_shader)) {
+        fprintf(stderr, "RENDERER_GL-FAIL: Compiling default shader failed.\n");
+    }
 }
 
 
@@ -198,17 +343,17 @@ static void RendererGL_Impl_clear(Renderer *self, float r, float g, float b, flo
 static void RendererGL_Impl_buffers_flush(Renderer *self) {
     if (!self) return;
     BufferGC_GL_flush();  // Очистка всех буферов.
+    StreamBufferGL_next_frame();  // Потоковые буферы переходят к следующему сегменту.
 }
 
 
 static void RendererGL_Impl_camera2d_update(Renderer *self) {
-    glDisable(GL_DEPTH_TEST);
+    StateGL_set_depth_test(false);
     ShaderProgram *shader = self->default_shader;
     Camera2D *camera = (Camera2D*)self->camera;
     if (!shader || !camera) return;
     shader->begin(shader);
-    shader->set_uniform_mat4(shader, "u_view", camera->view);
-    shader->set_uniform_mat4(shader, "u_proj", camera->proj);
+    self->update_view_proj(self, camera->view, camera->proj);
 }
 
 
@@ -217,6 +362,83 @@ static void RendererGL_Impl_camera3d_update(Renderer *self) {
 }
 
 
+static ShaderProgram* RendererGL_Impl_get_default_shader(Renderer *self, uint32_t flags) {
+    if (!self) return NULL;
+    return ShaderVariants_get(self->default_shaders, flags);
+}
+
+
 static void RendererGL_Impl_viewport_resize(Renderer *self, int x, int y, int width, int height) {
-    glViewport(x, y, width, height);
+    StateGL_set_viewport(x, y, width, height);
+    if (!self) return;
+
+    // Обновляем область просмотра в блоке данных кадра:
+    RendererGL_Data *data = (RendererGL_Data*)self->data;
+    float viewport[4] = {(float)x, (float)y, (float)width, (float)height};
+    memcpy(data->frame_data.viewport, viewport, sizeof(viewport));
+    if (!data->frame_ubo) return;
+    StateGL_bind_buffer(GL_UNIFORM_BUFFER, data->frame_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(RendererFrameData, viewport), sizeof(viewport), viewport);
+}
+
+
+static void RendererGL_Impl_update_view_proj(Renderer *self, mat4 view, mat4 proj) {
+    if (!self) return;
+    RendererGL_Data *data = (RendererGL_Data*)self->data;
+
+    // Матрицы лежат подряд, так что обновление камеры - это одна запись в буфер для всех шейдеров:
+    memcpy(data->frame_data.view, view, sizeof(float) * 16);
+    memcpy(data->frame_data.proj, proj, sizeof(float) * 16);
+    glm_mat4_mul(proj, view, (vec4*)data->frame_data.view_proj);
+    if (!data->frame_ubo) return;
+    StateGL_bind_buffer(GL_UNIFORM_BUFFER, data->frame_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(RendererFrameData, view), sizeof(float) * 16 * 3, data->frame_data.view);
+}
+
+
+static void RendererGL_Impl_set_time(Renderer *self, float time) {
+    if (!self) return;
+    RendererGL_Data *data = (RendererGL_Data*)self->data;
+    data->frame_data.time = time;
+    if (!data->frame_ubo) return;
+    StateGL_bind_buffer(GL_UNIFORM_BUFFER, data->frame_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(RendererFrameData, time), sizeof(float), &data->frame_data.time);
+}
+
+
+static void RendererGL_Impl_draw_instanced(Renderer *self, RendererMesh mesh, const RendererInstance *instances, size_t count,
+                                           Texture *texture, ShaderProgram *shader) {
+    if (!self || !instances || count == 0 || (uint32_t)mesh >= RENDERER_MESH_COUNT) return;
+    RendererGL_Data *data = (RendererGL_Data*)self->data;
+    if (!data->instances) return;
+
+    // Вариант дефолтного шейдера под меш и текстуру:
+    if (!shader) {
+        uint32_t flags = RENDERER_SHADER_INSTANCED;
+        if (texture) flags |= RENDERER_SHADER_TEXTURE;
+        if (mesh == RENDERER_MESH_POINT) flags |= RENDERER_SHADER_POINTS;
+        shader = ShaderVariants_get(self->default_shaders, flags);
+        if (!shader) return;
+    }
+
+    // Копируем экземпляры в потоковый буфер (без вызовов драйвера, если буфер постоянно отображён):
+    size_t offset = 0;
+    void *memory = StreamBufferGL_map(data->instances, count * sizeof(RendererInstance), sizeof(RendererInstance), &offset);
+    if (!memory) return;
+    memcpy(memory, instances, count * sizeof(RendererInstance));
+    StreamBufferGL_unmap(data->instances);
+
+    shader->begin(shader);
+    if (texture) shader->set_sampler2d(shader, "u_texture", texture);
+    StateGL_bind_vao(data->mesh_vao[mesh]);
+
+    // Направляем атрибуты экземпляров на записанный диапазон:
+    int stride = (int)sizeof(RendererInstance);
+    StateGL_bind_buffer(GL_ARRAY_BUFFER, data->instances->id);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(RendererInstance, position)));
+    glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(RendererInstance, scale)));
+    glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(offset + offsetof(RendererInstance, color)));
+    glDrawArraysInstanced(MESH_RANGES[mesh].mode, MESH_RANGES[mesh].first, MESH_RANGES[mesh].count, (int)count);
+    StateGL_bind_vao(0);
+    shader->end(shader);
 }
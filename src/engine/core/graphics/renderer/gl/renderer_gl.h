@@ -6,6 +6,8 @@
 
 
 // Подключаем:
+#include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include "../../renderer.h"
 
@@ -19,6 +21,7 @@ typedef enum RendererGL_Profile {
 
 // Объявление структур:
 typedef struct RendererGL_Data RendererGL_Data;
+typedef struct StreamBufferGL StreamBufferGL;
 
 
 // Структура данных рендерера:
@@ -27,6 +30,15 @@ typedef struct RendererGL_Data {
     int major;
     bool doublebuffer;
     RendererGL_Profile profile;
+
+    // Блок данных кадра (общий для всех шейдеров):
+    uint32_t frame_ubo;            // Буфер юниформов, привязанный к RENDERER_FRAME_DATA_BINDING.
+    RendererFrameData frame_data;  // Копия данных буфера на стороне процессора.
+
+    // Отрисовка экземплярами:
+    uint32_t mesh_vbo;                        // Вершины встроенных мешей.
+    uint32_t mesh_vao[RENDERER_MESH_COUNT];   // Раскладки мешей вместе с атрибутами экземпляров.
+    StreamBufferGL *instances;                // Потоковый буфер экземпляров (общий для всех мешей).
 } RendererGL_Data;
 
 
@@ -8,20 +8,63 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 #include "../../../math.h"
 #include "../../../mm/mm.h"
-#include "../../../darray.h"
+#include "../../../varray.h"
+#include "../../../hashmap.h"
+#include "../../../files.h"
 #include "../../gl.h"
+#include "../../renderer.h"
 #include "../../shader.h"
+#include "../../texture.h"
+#include "state_gl.h"
+#include "texture_units_gl.h"
 #include "shader_gl.h"
 
 
+// Кэш скомпилированных программ:
+#define SHADER_BINARY_MAGIC   0x42444853u  // "SHDB".
+#define SHADER_BINARY_VERSION 1u           // Версия формата файла кэша.
+
+// Статус готовности программы из GL_KHR_parallel_shader_compile (нет в нашем glad):
+#ifndef GL_COMPLETION_STATUS_KHR
+    #define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// Название ОС для ключа кэша:
+#if defined(_WIN32)
+    #define SHADER_BINARY_OS "windows"
+#elif defined(__APPLE__)
+    #define SHADER_BINARY_OS "macos"
+#elif defined(__ANDROID__)
+    #define SHADER_BINARY_OS "android"
+#elif defined(__linux__)
+    #define SHADER_BINARY_OS "linux"
+#else
+    #define SHADER_BINARY_OS "unknown"
+#endif
+
+
+// Заголовок файла кэша программы (за ним идёт сам бинарник программы):
+typedef struct ShaderBinaryHeader {
+    uint32_t magic;    // SHADER_BINARY_MAGIC.
+    uint32_t version;  // SHADER_BINARY_VERSION.
+    uint64_t key;      // Ключ кэша (исходники + видеокарта + драйвер + ОС).
+    uint32_t format;   // Формат бинарника (от драйвера).
+    uint32_t length;   // Размер бинарника.
+} ShaderBinaryHeader;
+
+
 // Объявление функций:
 static void ShaderGL_Impl_compile(ShaderProgram *self);
+static void ShaderGL_Impl_compile_async(ShaderProgram *self);
+static bool ShaderGL_Impl_is_ready(ShaderProgram *self);
 static void ShaderGL_Impl_begin(ShaderProgram *self);
 static void ShaderGL_Impl_end(ShaderProgram *self);
 static void ShaderGL_Impl__destroy_(ShaderProgram *self);
 static int32_t ShaderGL_Impl_get_location(ShaderProgram *self, const char* name);
+static ShaderUniform ShaderGL_Impl_get_uniform(ShaderProgram *self, const char* name);
 static void ShaderGL_Impl_set_uniform_bool(ShaderProgram *self, const char* name, bool value);
 static void ShaderGL_Impl_set_uniform_int(ShaderProgram *self, const char* name, int value);
 static void ShaderGL_Impl_set_uniform_float(ShaderProgram *self, const char* name, float value);
@@ -37,15 +80,49 @@ static void ShaderGL_Impl_set_uniform_mat2x4(ShaderProgram *self, const char* na
 static void ShaderGL_Impl_set_uniform_mat4x2(ShaderProgram *self, const char* name, mat4x2 value);
 static void ShaderGL_Impl_set_uniform_mat3x4(ShaderProgram *self, const char* name, mat3x4 value);
 static void ShaderGL_Impl_set_uniform_mat4x3(ShaderProgram *self, const char* name, mat4x3 value);
+static void ShaderGL_Impl_set_uniform_bool_h(ShaderProgram *self, ShaderUniform uniform, bool value);
+static void ShaderGL_Impl_set_uniform_int_h(ShaderProgram *self, ShaderUniform uniform, int value);
+static void ShaderGL_Impl_set_uniform_float_h(ShaderProgram *self, ShaderUniform uniform, float value);
+static void ShaderGL_Impl_set_uniform_vec2_h(ShaderProgram *self, ShaderUniform uniform, Vec2f value);
+static void ShaderGL_Impl_set_uniform_vec3_h(ShaderProgram *self, ShaderUniform uniform, Vec3f value);
+static void ShaderGL_Impl_set_uniform_vec4_h(ShaderProgram *self, ShaderUniform uniform, Vec4f value);
+static void ShaderGL_Impl_set_uniform_mat2_h(ShaderProgram *self, ShaderUniform uniform, mat2 value);
+static void ShaderGL_Impl_set_uniform_mat3_h(ShaderProgram *self, ShaderUniform uniform, mat3 value);
+static void ShaderGL_Impl_set_uniform_mat4_h(ShaderProgram *self, ShaderUniform uniform, mat4 value);
+static void ShaderGL_Impl_set_uniform_mat2x3_h(ShaderProgram *self, ShaderUniform uniform, mat2x3 value);
+static void ShaderGL_Impl_set_uniform_mat3x2_h(ShaderProgram *self, ShaderUniform uniform, mat3x2 value);
+static void ShaderGL_Impl_set_uniform_mat2x4_h(ShaderProgram *self, ShaderUniform uniform, mat2x4 value);
+static void ShaderGL_Impl_set_uniform_mat4x2_h(ShaderProgram *self, ShaderUniform uniform, mat4x2 value);
+static void ShaderGL_Impl_set_uniform_mat3x4_h(ShaderProgram *self, ShaderUniform uniform, mat3x4 value);
+static void ShaderGL_Impl_set_uniform_mat4x3_h(ShaderProgram *self, ShaderUniform uniform, mat4x3 value);
+static void ShaderGL_Impl_set_uniform_int_array(ShaderProgram *self, const char* name, const int *values, int count);
+static void ShaderGL_Impl_set_uniform_float_array(ShaderProgram *self, const char* name, const float *values, int count);
+static void ShaderGL_Impl_set_uniform_vec2_array(ShaderProgram *self, const char* name, const Vec2f *values, int count);
+static void ShaderGL_Impl_set_uniform_vec3_array(ShaderProgram *self, const char* name, const Vec3f *values, int count);
+static void ShaderGL_Impl_set_uniform_vec4_array(ShaderProgram *self, const char* name, const Vec4f *values, int count);
+static void ShaderGL_Impl_set_uniform_mat4_array(ShaderProgram *self, const char* name, const mat4 *values, int count);
+static void ShaderGL_Impl_set_uniform_int_array_h(ShaderProgram *self, ShaderUniform uniform, const int *values, int count);
+static void ShaderGL_Impl_set_uniform_float_array_h(ShaderProgram *self, ShaderUniform uniform, const float *values, int count);
+static void ShaderGL_Impl_set_uniform_vec2_array_h(ShaderProgram *self, ShaderUniform uniform, const Vec2f *values, int count);
+static void ShaderGL_Impl_set_uniform_vec3_array_h(ShaderProgram *self, ShaderUniform uniform, const Vec3f *values, int count);
+static void ShaderGL_Impl_set_uniform_vec4_array_h(ShaderProgram *self, ShaderUniform uniform, const Vec4f *values, int count);
+static void ShaderGL_Impl_set_uniform_mat4_array_h(ShaderProgram *self, ShaderUniform uniform, const mat4 *values, int count);
+static void ShaderGL_Impl_set_sampler2d(ShaderProgram *self, const char* name, Texture *texture);
+static void ShaderGL_Impl_set_sampler2d_h(ShaderProgram *self, ShaderUniform uniform, Texture *texture);
+static void ShaderGL_Impl_set_sampler2d_array(ShaderProgram *self, const char* name, Texture *const *textures, int count);
+static void ShaderGL_Impl_set_sampler2d_array_h(ShaderProgram *self, ShaderUniform uniform, Texture *const *textures, int count);
 
 
 // Регистрируем функции реализации апи для шейдера:
 void ShaderGL_RegisterAPI(ShaderProgram *shader) {
     shader->compile = ShaderGL_Impl_compile;
+    shader->compile_async = ShaderGL_Impl_compile_async;
+    shader->is_ready = ShaderGL_Impl_is_ready;
     shader->begin = ShaderGL_Impl_begin;
     shader->end = ShaderGL_Impl_end;
     shader->_destroy_ = ShaderGL_Impl__destroy_;
     shader->get_location = ShaderGL_Impl_get_location;
+    shader->get_uniform = ShaderGL_Impl_get_uniform;
     shader->set_uniform_bool = ShaderGL_Impl_set_uniform_bool;
     shader->set_uniform_int = ShaderGL_Impl_set_uniform_int;
     shader->set_uniform_float = ShaderGL_Impl_set_uniform_float;
@@ -61,6 +138,37 @@ void ShaderGL_RegisterAPI(ShaderProgram *shader) {
     shader->set_uniform_mat4x2 = ShaderGL_Impl_set_uniform_mat4x2;
     shader->set_uniform_mat3x4 = ShaderGL_Impl_set_uniform_mat3x4;
     shader->set_uniform_mat4x3 = ShaderGL_Impl_set_uniform_mat4x3;
+    shader->set_uniform_bool_h = ShaderGL_Impl_set_uniform_bool_h;
+    shader->set_uniform_int_h = ShaderGL_Impl_set_uniform_int_h;
+    shader->set_uniform_float_h = ShaderGL_Impl_set_uniform_float_h;
+    shader->set_uniform_vec2_h = ShaderGL_Impl_set_uniform_vec2_h;
+    shader->set_uniform_vec3_h = ShaderGL_Impl_set_uniform_vec3_h;
+    shader->set_uniform_vec4_h = ShaderGL_Impl_set_uniform_vec4_h;
+    shader->set_uniform_mat2_h = ShaderGL_Impl_set_uniform_mat2_h;
+    shader->set_uniform_mat3_h = ShaderGL_Impl_set_uniform_mat3_h;
+    shader->set_uniform_mat4_h = ShaderGL_Impl_set_uniform_mat4_h;
+    shader->set_uniform_mat2x3_h = ShaderGL_Impl_set_uniform_mat2x3_h;
+    shader->set_uniform_mat3x2_h = ShaderGL_Impl_set_uniform_mat3x2_h;
+    shader->set_uniform_mat2x4_h = ShaderGL_Impl_set_uniform_mat2x4_h;
+    shader->set_uniform_mat4x2_h = ShaderGL_Impl_set_uniform_mat4x2_h;
+    shader->set_uniform_mat3x4_h = ShaderGL_Impl_set_uniform_mat3x4_h;
+    shader->set_uniform_mat4x3_h = ShaderGL_Impl_set_uniform_mat4x3_h;
+    shader->set_uniform_int_array = ShaderGL_Impl_set_uniform_int_array;
+    shader->set_uniform_float_array = ShaderGL_Impl_set_uniform_float_array;
+    shader->set_uniform_vec2_array = ShaderGL_Impl_set_uniform_vec2_array;
+    shader->set_uniform_vec3_array = ShaderGL_Impl_set_uniform_vec3_array;
+    shader->set_uniform_vec4_array = ShaderGL_Impl_set_uniform_vec4_array;
+    shader->set_uniform_mat4_array = ShaderGL_Impl_set_uniform_mat4_array;
+    shader->set_uniform_int_array_h = ShaderGL_Impl_set_uniform_int_array_h;
+    shader->set_uniform_float_array_h = ShaderGL_Impl_set_uniform_float_array_h;
+    shader->set_uniform_vec2_array_h = ShaderGL_Impl_set_uniform_vec2_array_h;
+    shader->set_uniform_vec3_array_h = ShaderGL_Impl_set_uniform_vec3_array_h;
+    shader->set_uniform_vec4_array_h = ShaderGL_Impl_set_uniform_vec4_array_h;
+    shader->set_uniform_mat4_array_h = ShaderGL_Impl_set_uniform_mat4_array_h;
+    shader->set_sampler2d = ShaderGL_Impl_set_sampler2d;
+    shader->set_sampler2d_h = ShaderGL_Impl_set_sampler2d_h;
+    shader->set_sampler2d_array = ShaderGL_Impl_set_sampler2d_array;
+    shader->set_sampler2d_array_h = ShaderGL_Impl_set_sampler2d_array_h;
 }
 
 
@@ -73,28 +181,226 @@ static inline bool cmp_float(float a, float b) {
 }
 
 
-static inline ShaderCacheUniformValue* find_cached_uniform(ShaderProgram *self, int loc, ShaderCacheUniformType type) {
-    // TODO: Не обязательно, но лучше заменить на хэш-таблицу чтобы скорость была O(1) а не от O(n).
-    for (size_t i = 0; i < DArray_len(self->uniform_values); i++) {
-        ShaderCacheUniformValue *item = DArray_get(self->uniform_values, i);
-        if (item->location == loc && item->type == type) return item;
+// Получить запись таблицы рефлексии по дескриптору (NULL если дескриптор недействителен):
+static inline ShaderUniformInfo* uniform_info(ShaderProgram *self, ShaderUniform uniform) {
+    if (uniform < 0 || (size_t)uniform >= self->uniforms->len) return NULL;
+    return &VArray_at(self->uniforms, ShaderUniformInfo, uniform);
+}
+
+
+// Обновить кэш вектора. Возвращает true если значение изменилось:
+static inline bool update_cached_vec(ShaderUniformInfo *u, const float *value, int count) {
+    if (u->has_value) {
+        bool same = true;
+        for (int i = 0; i < count; i++) same &= cmp_float(u->vec[i], value[i]);
+        if (same) return false;
+    }
+    memcpy(u->vec, value, sizeof(float) * count);
+    u->has_value = true;
+    u->shadow_valid = 0;  // Значение массива в теневой копии больше не актуально.
+    return true;
+}
+
+
+// Обновить кэш матрицы (побайтовое сравнение). Возвращает true если значение изменилось:
+static inline bool update_cached_mat(ShaderUniformInfo *u, const float *value, int count) {
+    if (u->has_value && memcmp(u->mat, value, sizeof(float) * count) == 0) return false;
+    memcpy(u->mat, value, sizeof(float) * count);
+    u->has_value = true;
+    u->shadow_valid = 0;  // Значение массива в теневой копии больше не актуально.
+    return true;
+}
+
+
+// Обновить теневую копию массива (побайтовое сравнение). Возвращает true если значение изменилось:
+static bool update_cached_array(ShaderProgram *self, ShaderUniformInfo *u, const void *value, size_t size) {
+    // Теневая копия выделяется при первой загрузке массива (или заново, если массив стал больше):
+    if (u->shadow_size < size) {
+        u->shadow_offset = (uint32_t)self->uniform_shadow->len;
+        u->shadow_size = (uint32_t)size;
+        u->shadow_valid = 0;
+        VArray_resize(self->uniform_shadow, self->uniform_shadow->len + size);
+    }
+    char *shadow = (char*)self->uniform_shadow->data + u->shadow_offset;
+    if (size <= u->shadow_valid && memcmp(shadow, value, size) == 0) return false;
+    memcpy(shadow, value, size);
+    if (u->shadow_valid < size) u->shadow_valid = (uint32_t)size;
+    u->has_value = false;  // Значение в кэше одиночного значения больше не актуально.
+    return true;
+}
+
+
+// Привязать общие блоки юниформов программы к их фиксированным точкам привязки:
+static void bind_uniform_blocks(uint32_t program) {
+    GLuint index = glGetUniformBlockIndex(program, RENDERER_FRAME_DATA_BLOCK);
+    if (index != GL_INVALID_INDEX) glUniformBlockBinding(program, index, RENDERER_FRAME_DATA_BINDING);
+}
+
+
+// Заполнить таблицу рефлексии активными юниформами слинкованной программы:
+static void reflect_uniforms(ShaderProgram *self, uint32_t program) {
+    VArray_clear(self->uniforms);
+    VArray_clear(self->uniform_shadow);
+    HashMap_clear(self->uniform_names);
+
+    int active = 0, max_length = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &active);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    if (active <= 0 || max_length <= 0) return;
+
+    char *name = mm_alloc_tagged(max_length + 1, MM_TAG_SHADER);
+    if (!name) mm_alloc_error();
+    VArray_reserve(self->uniforms, (size_t)active);
+
+    for (int i = 0; i < active; i++) {
+        GLsizei length = 0;
+        GLint count = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, (GLuint)i, max_length + 1, &length, &count, &type, name);
+        int32_t location = glGetUniformLocation(program, name);
+        if (location < 0) continue;  // Юниформы из блоков не имеют позиции.
+
+        ShaderUniform handle = (ShaderUniform)self->uniforms->len;
+        ShaderUniformInfo *u = VArray_push(self->uniforms, NULL);
+        u->location = location;
+        u->type = type;
+        u->count = count;
+        HashMap_put_str(self->uniform_names, name, &handle);
+
+        // Массивы доступны и по имени без "[0]":
+        if (length > 3 && strcmp(name + length - 3, "[0]") == 0) {
+            name[length - 3] = '\0';
+            HashMap_put_str(self->uniform_names, name, &handle);
+        }
     }
-    return NULL;
+    mm_free(name);
 }
 
 
-static uint32_t compile_shader(ShaderProgram *program, const char* source, GLenum type) {
+// Добавить строку к хэшу (FNV-1a, с разделителем, чтобы "ab"+"c" и "a"+"bc" различались):
+static uint64_t hash_append_str(uint64_t hash, const char *str) {
+    if (str) {
+        for (const unsigned char *p = (const unsigned char*)str; *p; p++) {
+            hash ^= *p;
+            hash *= 0x100000001b3ull;
+        }
+    }
+    hash ^= 0xff;
+    hash *= 0x100000001b3ull;
+    return hash;
+}
+
+
+// Кэш программ доступен (нужен OpenGL 4.1+ и хотя бы один формат бинарников):
+static bool binary_cache_available(void) {
+    if (!ShaderProgram_get_binary_cache_dir() || !GLAD_GL_VERSION_4_1) return false;
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+
+// Ключ кэша программы. Меняется при изменении исходников, видеокарты, версии драйвера или ОС:
+static uint64_t binary_cache_key(ShaderProgram *self) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = hash_append_str(hash, self->vertex);
+    hash = hash_append_str(hash, self->fragment);
+    hash = hash_append_str(hash, self->geometry);
+    hash = hash_append_str(hash, (const char*)glGetString(GL_VENDOR));
+    hash = hash_append_str(hash, (const char*)glGetString(GL_RENDERER));
+    hash = hash_append_str(hash, (const char*)glGetString(GL_VERSION));
+    hash = hash_append_str(hash, (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
+    hash = hash_append_str(hash, SHADER_BINARY_OS);
+    return hash;
+}
+
+
+// Путь к файлу кэша программы:
+static void binary_cache_path(char *path, size_t size, uint64_t key) {
+    snprintf(path, size, "%s/%016llx.bin", ShaderProgram_get_binary_cache_dir(), (unsigned long long)key);
+}
+
+
+// Загрузить программу из кэша. Возвращает 0 если кэша нет или он не подходит:
+static uint32_t load_program_binary(uint64_t key) {
+    char path[SHADER_BINARY_CACHE_DIR_MAX + 32];
+    binary_cache_path(path, sizeof(path), key);
+
+    size_t size = 0;
+    unsigned char *data = fs_load_file_bin(path, "rb", &size);
+    if (!data) return 0;
+
+    // Проверяем заголовок:
+    ShaderBinaryHeader header;
+    if (size < sizeof(header)) { mm_free(data); return 0; }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != SHADER_BINARY_MAGIC || header.version != SHADER_BINARY_VERSION ||
+        header.key != key || header.length != size - sizeof(header)) {
+        mm_free(data);
+        return 0;
+    }
+
+    // Загружаем бинарник. Драйвер может отказаться от него (например после обновления), тогда собираем заново:
+    uint32_t program = glCreateProgram();
+    glProgramBinary(program, header.format, data + sizeof(header), (GLsizei)header.length);
+    mm_free(data);
+
+    int linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+
+// Сохранить слинкованную программу в кэш:
+static void save_program_binary(uint32_t program, uint64_t key) {
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    unsigned char *data = mm_alloc_tagged(sizeof(ShaderBinaryHeader) + length, MM_TAG_SHADER);
+    if (!data) mm_alloc_error();
+
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, data + sizeof(ShaderBinaryHeader));
+    if (written > 0) {
+        ShaderBinaryHeader header = {SHADER_BINARY_MAGIC, SHADER_BINARY_VERSION, key, format, (uint32_t)written};
+        memcpy(data, &header, sizeof(header));
+
+        char path[SHADER_BINARY_CACHE_DIR_MAX + 32];
+        binary_cache_path(path, sizeof(path), key);
+        if (!fs_make_dir(ShaderProgram_get_binary_cache_dir()) ||
+            !fs_save_file_bin(path, data, sizeof(header) + written, "wb")) {
+            fprintf(stderr, "ShaderGL_Impl_compile: Failed to save program binary to \"%s\".\n", path);
+        }
+    }
+    mm_free(data);
+}
+
+
+// Отправить шейдер драйверу на компиляцию (статус не запрашивается, чтобы не ждать драйвер):
+static uint32_t submit_shader(const char* source, GLenum type) {
     if (!source) return 0;
     uint32_t shader = glCreateShader(type);
     glShaderSource(shader, 1, &source, NULL);
     glCompileShader(shader);
+    return shader;
+}
+
 
+// Проверить статус компиляции шейдера и записать ошибку в программу. Возвращает false при ошибке:
+static bool check_shader(ShaderProgram *program, uint32_t shader, GLenum type) {
     int compiled = 0;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
     if (!compiled) {
         int logLength = 0;
         glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-        char* log = mm_alloc(logLength);
+        char* log = mm_alloc_tagged(logLength + 1, MM_TAG_SHADER);
+        log[0] = '\0';
         glGetShaderInfoLog(shader, logLength, NULL, log);
         // Тип шейдера:
         const char* type_str = (type == GL_VERTEX_SHADER)   ? "VERTEX"   :
@@ -102,93 +408,190 @@ static uint32_t compile_shader(ShaderProgram *program, const char* source, GLenu
                                (type == GL_GEOMETRY_SHADER) ? "GEOMETRY" : "UNKNOWN";
         // Сколько надо выделить памяти:
         int needed = snprintf(NULL, 0, "ShaderCompileError (%s):\n%s\n", type_str, log);
-        program->error = mm_alloc(needed + 1);
+        program->error = mm_alloc_tagged(needed + 1, MM_TAG_SHADER);
         // Форматируем строку:
         sprintf(program->error, "ShaderCompileError (%s):\n%s\n", type_str, log);
         fprintf(stderr, "%s", program->error);
         mm_free(log);
-        glDeleteShader(shader);
-        return 0;
+        return false;
     }
-    return shader;
+    return true;
+}
+
+
+// Поддерживает ли драйвер параллельную компиляцию (GL_KHR_parallel_shader_compile):
+static bool parallel_compile_supported(void) {
+    static int supported = -1;  // -1 - ещё не проверяли.
+    if (supported < 0) {
+        supported = 0;
+        int count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (int i = 0; i < count; i++) {
+            const char *ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+            if (ext && (strcmp(ext, "GL_KHR_parallel_shader_compile") == 0 ||
+                        strcmp(ext, "GL_ARB_parallel_shader_compile") == 0)) {
+                supported = 1;
+                break;
+            }
+        }
+    }
+    return supported == 1;
+}
+
+
+// Удалить отдельные шейдеры программы, которая компилировалась:
+static void release_pending_stages(ShaderProgram *self) {
+    for (int i = 0; i < 3; ++i) {
+        if (!self->_stages_[i]) continue;
+        if (self->_program_) glDetachShader(self->_program_, self->_stages_[i]);
+        glDeleteShader(self->_stages_[i]);
+        self->_stages_[i] = 0;
+    }
+}
+
+
+// Завершить компиляцию: запросить статусы, собрать ошибки, рефлексию и сохранить кэш.
+// Если драйвер ещё компилирует программу - этот вызов будет его ждать:
+static void finish_compile(ShaderProgram *self) {
+    if (!self->_compiling_) return;
+    self->_compiling_ = false;
+    uint32_t program = self->_program_;
+
+    // Проверяем статус линковки:
+    int linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // Сначала ищем ошибку компиляции отдельных шейдеров, она понятнее ошибки линковки:
+        static const GLenum types[3] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER};
+        bool stages_ok = true;
+        for (int i = 0; i < 3 && stages_ok; ++i) {
+            if (self->_stages_[i]) stages_ok = check_shader(self, self->_stages_[i], types[i]);
+        }
+        if (stages_ok) {
+            int logLength = 0;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+            char* log = mm_alloc_tagged(logLength + 1, MM_TAG_SHADER);
+            log[0] = '\0';
+            glGetProgramInfoLog(program, logLength, NULL, log);
+            // Сколько надо выделить памяти:
+            int needed = snprintf(NULL, 0, "ShaderLinkingError:\n%s\n", log);
+            self->error = mm_alloc_tagged(needed + 1, MM_TAG_SHADER);
+            // Форматируем строку:
+            sprintf(self->error, "ShaderLinkingError:\n%s\n", log);
+            fprintf(stderr, "%s", self->error);
+            mm_free(log);
+        }
+        release_pending_stages(self);
+        glDeleteProgram(program);
+        self->_program_ = 0;
+        return;
+    }
+
+    // Удаляем отдельные шейдеры:
+    release_pending_stages(self);
+    self->_program_ = 0;
+    self->id = program;
+    bind_uniform_blocks(program);
+    reflect_uniforms(self, program);
+
+    // Сохраняем программу в кэш для следующих запусков:
+    if (self->_use_cache_) save_program_binary(program, self->_cache_key_);
 }
 
 
 static void ShaderGL_Impl_compile(ShaderProgram *self) {
     if (!self) return;
+    self->compile_async(self);
+    finish_compile(self);
+}
 
-    uint32_t program = glCreateProgram();
-    uint32_t shaders[3] = {0};
 
+static void ShaderGL_Impl_compile_async(ShaderProgram *self) {
+    if (!self || self->_compiling_ || self->id) return;
+
+    // Пробуем загрузить программу из кэша:
+    self->_use_cache_ = binary_cache_available();
+    self->_cache_key_ = self->_use_cache_ ? binary_cache_key(self) : 0;
+    if (self->_use_cache_) {
+        uint32_t cached = load_program_binary(self->_cache_key_);
+        if (cached) {
+            self->id = cached;
+            bind_uniform_blocks(cached);
+            reflect_uniforms(self, cached);
+            return;
+        }
+    }
+
+    uint32_t program = glCreateProgram();
     if (!program) {
         // Сколько надо выделить памяти:
         int needed = snprintf(NULL, 0, "ShaderCreateError: The OpenGL context has not been created or is inactive.\n");
-        self->error = mm_alloc(needed + 1);
+        self->error = mm_alloc_tagged(needed + 1, MM_TAG_SHADER);
         // Форматируем строку:
         sprintf(self->error, "ShaderCreateError: The OpenGL context has not been created or is inactive.\n");
         fprintf(stderr, "%s", self->error);
         return;
     }
 
-    // Компилируем шейдеры:
-    if (self->vertex)   shaders[0] = compile_shader(self, self->vertex, GL_VERTEX_SHADER);
-    if (self->fragment) shaders[1] = compile_shader(self, self->fragment, GL_FRAGMENT_SHADER);
-    if (self->geometry) shaders[2] = compile_shader(self, self->geometry, GL_GEOMETRY_SHADER);
-
-    // Линкуем программу:
+    // Отправляем шейдеры на компиляцию и сразу линкуем, не дожидаясь статусов (ошибки соберёт finish_compile):
+    self->_stages_[0] = submit_shader(self->vertex, GL_VERTEX_SHADER);
+    self->_stages_[1] = submit_shader(self->fragment, GL_FRAGMENT_SHADER);
+    self->_stages_[2] = submit_shader(self->geometry, GL_GEOMETRY_SHADER);
     for (int i = 0; i < 3; ++i) {
-        if (shaders[i]) glAttachShader(program, shaders[i]);
+        if (self->_stages_[i]) glAttachShader(program, self->_stages_[i]);
     }
+    if (self->_use_cache_) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
 
-    // Проверяем статус линковки:
-    int linked = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        int logLength = 0;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
-        char* log = mm_alloc(logLength);
-        glGetProgramInfoLog(program, logLength, NULL, log);
-        // Сколько надо выделить памяти:
-        int needed = snprintf(NULL, 0, "ShaderLinkingError:\n%s\n", log);
-        self->error = mm_alloc(needed + 1);
-        // Форматируем строку:
-        sprintf(self->error, "ShaderCompileError:\n%s\n", log);
-        fprintf(stderr, "%s", self->error);
-        mm_free(log);
-        glDeleteProgram(program);
-        return;
-    }
+    self->_program_ = program;
+    self->_compiling_ = true;
+}
 
-    // Удаляем отдельные шейдеры:
-    for (int i = 0; i < 3; ++i) {
-        if (shaders[i]) {
-            glDetachShader(program, shaders[i]);
-            glDeleteShader(shaders[i]);
-        }
+
+static bool ShaderGL_Impl_is_ready(ShaderProgram *self) {
+    if (!self) return false;
+    if (!self->_compiling_) return true;
+
+    // С параллельной компиляцией спрашиваем драйвер без ожидания:
+    if (parallel_compile_supported()) {
+        int completed = 0;
+        glGetProgramiv(self->_program_, GL_COMPLETION_STATUS_KHR, &completed);
+        if (!completed) return false;
     }
-    self->id = program;
+    finish_compile(self);
+    return true;
 }
 
 
 static void ShaderGL_Impl_begin(ShaderProgram *self) {
     if (!self) return;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &self->_id_before_begin_);
-    glUseProgram(self->id);
+    finish_compile(self);  // Программа нужна прямо сейчас, дожидаемся компиляции.
+    self->_id_before_begin_ = state_gl.program == STATE_GL_UNKNOWN ? 0 : (int32_t)state_gl.program;
+    StateGL_use_program(self->id);
     self->_is_begin_ = true;
 }
 
 
 static void ShaderGL_Impl_end(ShaderProgram *self) {
     if (!self) return;
-    glUseProgram((uint32_t)self->_id_before_begin_);
+    StateGL_use_program((uint32_t)self->_id_before_begin_);
     self->_is_begin_ = false;
 }
 
 
 static void ShaderGL_Impl__destroy_(ShaderProgram *self) {
     if (!self) return;
+    if (self->_compiling_) {
+        release_pending_stages(self);
+        if (state_gl.program == self->_program_) StateGL_use_program(0);
+        glDeleteProgram(self->_program_);
+        self->_program_ = 0;
+        self->_compiling_ = false;
+    }
     if (self->id) {
+        // Удалённая, но активная программа продолжает работать, а её айди может получить новый шейдер,
+        // и тогда его begin пропустится теневой копией. Поэтому сначала снимаем её:
+        if (state_gl.program == self->id) StateGL_use_program(0);
         glDeleteProgram(self->id);
         self->id = 0;
     }
@@ -197,244 +600,420 @@ static void ShaderGL_Impl__destroy_(ShaderProgram *self) {
 
 static int32_t ShaderGL_Impl_get_location(ShaderProgram *self, const char* name) {
     if (!self) return -1;
+    ShaderUniformInfo *u = uniform_info(self, self->get_uniform(self, name));
+    return u ? u->location : -1;
+}
 
-    // Ищем и возвращаем локацию в кэше:
-    // TODO: Не обязательно, но лучше заменить на хэш-таблицу чтобы скорость была O(1) а не от O(n).
-    for (size_t i = 0; i < DArray_len(self->uniform_locations); i++) {
-        ShaderCacheUniformLocation *u = DArray_get(self->uniform_locations, i);
-        if (strcmp(u->name, name) == 0) {
-            return u->location;
-        }
-    }
 
-    // Иначе получаем локацию и добавляем в кэш:
-    int32_t location = glGetUniformLocation(self->id, name);
-    if (location == -1) return -1;
+static ShaderUniform ShaderGL_Impl_get_uniform(ShaderProgram *self, const char* name) {
+    if (!self || !name) return SHADER_UNIFORM_INVALID;
 
-    ShaderCacheUniformLocation *cache = mm_alloc(sizeof(ShaderCacheUniformLocation));
-    cache->name = mm_strdup(name);
-    cache->location = location;
-    DArray_push(self->uniform_locations, cache);
+    // Ищем дескриптор в таблице имён:
+    uint64_t hash = HashMap_hash_str(name);
+    ShaderUniform *cached = HashMap_get_str_h(self->uniform_names, name, hash);
+    if (cached) return *cached;
+    finish_compile(self);  // Для рефлексии нужна слинкованная программа, дожидаемся компиляции.
+    cached = HashMap_get_str_h(self->uniform_names, name, hash);
+    if (cached) return *cached;
+    if (!self->id) return SHADER_UNIFORM_INVALID;  // Программа ещё не слинкована, ничего не кэшируем.
 
-    return location;
+    // Имени нет в рефлексии (например элемент массива "u_arr[3]"), спрашиваем OpenGL один раз.
+    // Отсутствующие юниформы тоже кэшируем, чтобы не спрашивать OpenGL каждый раз:
+    ShaderUniform handle = SHADER_UNIFORM_INVALID;
+    int32_t location = glGetUniformLocation(self->id, name);
+    if (location >= 0) {
+        handle = (ShaderUniform)self->uniforms->len;
+        ShaderUniformInfo *u = VArray_push(self->uniforms, NULL);
+        u->location = location;
+        u->count = 1;
+    }
+    HashMap_put_str_h(self->uniform_names, name, hash, &handle);
+    return handle;
 }
 
 
+// Установка значений по имени (дескриптор ищется в таблице имён):
+
+
 static void ShaderGL_Impl_set_uniform_bool(ShaderProgram *self, const char* name, bool value) {
     if (!self || !name) return;
-    int32_t loc = self->get_location(self, name);
-    if (loc < 0) return; // Униформа не найдена.
-
-    // Ищем униформу в кэше:
-    ShaderCacheUniformValue *u = find_cached_uniform(self, loc, SHADERCACHE_UNIFORM_BOOL);
-
-    // Если нашли:
-    if (u) {
-        if (u->vbool == value) return;  // Если значение не изменилось - выходим.
-        u->vbool = value;  // Если значение изменилось - обновляем.
-    } else {  // Иначе добавляем новую запись:
-        ShaderCacheUniformValue *cache = mm_alloc(sizeof(ShaderCacheUniformValue));
-        cache->type = SHADERCACHE_UNIFORM_BOOL;
-        cache->location = loc;
-        cache->vbool = value;
-        DArray_push(self->uniform_values, cache);
-    }
-    glUniform1i(loc, (int)value);
+    ShaderGL_Impl_set_uniform_bool_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_int(ShaderProgram *self, const char* name, int value) {
     if (!self || !name) return;
-    int32_t loc = self->get_location(self, name);
-    if (loc < 0) return; // Униформа не найдена.
-
-    // Ищем униформу в кэше:
-    ShaderCacheUniformValue *u = find_cached_uniform(self, loc, SHADERCACHE_UNIFORM_INT);
-
-    // Если нашли:
-    if (u) {
-        if (u->vint == value) return;  // Если значение не изменилось - выходим.
-        u->vint = value;  // Если значение изменилось - обновляем.
-    } else {  // Иначе добавляем новую запись:
-        ShaderCacheUniformValue *cache = mm_alloc(sizeof(ShaderCacheUniformValue));
-        cache->type = SHADERCACHE_UNIFORM_INT;
-        cache->location = loc;
-        cache->vint = value;
-        DArray_push(self->uniform_values, cache);
-    }
-    glUniform1i(loc, value);
+    ShaderGL_Impl_set_uniform_int_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_float(ShaderProgram *self, const char* name, float value) {
     if (!self || !name) return;
-    int32_t loc = self->get_location(self, name);
-    if (loc < 0) return; // Униформа не найдена.
-
-    // Ищем униформу в кэше:
-    ShaderCacheUniformValue *u = find_cached_uniform(self, loc, SHADERCACHE_UNIFORM_FLOAT);
-
-    // Если нашли:
-    if (u) {
-        if (cmp_float(u->vfloat, value)) return;  // Если значение не изменилось - выходим.
-        u->vfloat = value;  // Если значение изменилось - обновляем.
-    } else {  // Иначе добавляем новую запись:
-        ShaderCacheUniformValue *cache = mm_alloc(sizeof(ShaderCacheUniformValue));
-        cache->type = SHADERCACHE_UNIFORM_FLOAT;
-        cache->location = loc;
-        cache->vfloat = value;
-        DArray_push(self->uniform_values, cache);
-    }
-    glUniform1f(loc, value);
+    ShaderGL_Impl_set_uniform_float_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_vec2(ShaderProgram *self, const char* name, Vec2f value) {
     if (!self || !name) return;
-    int32_t loc = self->get_location(self, name);
-    if (loc < 0) return; // Униформа не найдена.
-
-    // Ищем униформу в кэше:
-    ShaderCacheUniformValue *u = find_cached_uniform(self, loc, SHADERCACHE_UNIFORM_VEC2);
-
-    // Если нашли:
-    if (u) {
-        // Если значение не изменилось - выходим:
-        if (cmp_float(u->vec2[0], value.x) && cmp_float(u->vec2[1], value.y)) return;
-        // Если значение изменилось - обновляем:
-        u->vec2[0] = value.x;
-        u->vec2[1] = value.y;
-    } else {  // Иначе добавляем новую запись:
-        ShaderCacheUniformValue *cache = mm_alloc(sizeof(ShaderCacheUniformValue));
-        cache->type = SHADERCACHE_UNIFORM_VEC2;
-        cache->location = loc;
-        cache->vec2[0] = value.x;
-        cache->vec2[1] = value.y;
-        DArray_push(self->uniform_values, cache);
-    }
-    glUniform2fv(loc, 1, (float*)&value);
+    ShaderGL_Impl_set_uniform_vec2_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_vec3(ShaderProgram *self, const char* name, Vec3f value) {
     if (!self || !name) return;
-    int32_t loc = self->get_location(self, name);
-    if (loc < 0) return; // Униформа не найдена.
-
-    // Ищем униформу в кэше:
-    ShaderCacheUniformValue *u = find_cached_uniform(self, loc, SHADERCACHE_UNIFORM_VEC3);
-
-    // Если нашли:
-    if (u) {
-        // Если значение не изменилось - выходим:
-        if (cmp_float(u->vec3[0], value.x) && cmp_float(u->vec3[1], value.y) && cmp_float(u->vec3[2], value.z)) return;
-        // Если значение изменилось - обновляем:
-        u->vec3[0] = value.x;
-        u->vec3[1] = value.y;
-        u->vec3[2] = value.z;
-    } else {  // Иначе добавляем новую запись:
-        ShaderCacheUniformValue *cache = mm_alloc(sizeof(ShaderCacheUniformValue));
-        cache->type = SHADERCACHE_UNIFORM_VEC3;
-        cache->location = loc;
-        cache->vec3[0] = value.x;
-        cache->vec3[1] = value.y;
-        cache->vec3[2] = value.z;
-        DArray_push(self->uniform_values, cache);
-    }
-    glUniform3fv(loc, 1, (float*)&value);
+    ShaderGL_Impl_set_uniform_vec3_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_vec4(ShaderProgram *self, const char* name, Vec4f value) {
     if (!self || !name) return;
-    int32_t loc = self->get_location(self, name);
-    if (loc < 0) return; // Униформа не найдена.
-
-    // Ищем униформу в кэше:
-    ShaderCacheUniformValue *u = find_cached_uniform(self, loc, SHADERCACHE_UNIFORM_VEC4);
-
-    // Если нашли:
-    if (u) {
-        // Если значение не изменилось - выходим:
-        if (cmp_float(u->vec4[0], value.x) && cmp_float(u->vec4[1], value.y) &&
-            cmp_float(u->vec4[2], value.z) && cmp_float(u->vec4[3], value.w)) return;
-        // Если значение изменилось - обновляем:
-        u->vec4[0] = value.x;
-        u->vec4[1] = value.y;
-        u->vec4[2] = value.z;
-        u->vec4[3] = value.w;
-    } else {  // Иначе добавляем новую запись:
-        ShaderCacheUniformValue *cache = mm_alloc(sizeof(ShaderCacheUniformValue));
-        cache->type = SHADERCACHE_UNIFORM_VEC4;
-        cache->location = loc;
-        cache->vec4[0] = value.x;
-        cache->vec4[1] = value.y;
-        cache->vec4[2] = value.z;
-        cache->vec4[3] = value.w;
-        DArray_push(self->uniform_values, cache);
-    }
-    glUniform4fv(loc, 1, (float*)&value);
+    ShaderGL_Impl_set_uniform_vec4_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_mat2(ShaderProgram *self, const char* name, mat2 value) {
-    if (!self || !name) return;  // Кэширование матриц и массивов слишком дорого и сложно, по этому тут нет.
-    int32_t loc = self->get_location(self, name);
-    glUniformMatrix2fv(loc, 1, GL_FALSE, (float*)value);
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_mat2_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_mat3(ShaderProgram *self, const char* name, mat3 value) {
-    if (!self || !name) return;  // Кэширование матриц и массивов слишком дорого и сложно, по этому тут нет.
-    int32_t loc = self->get_location(self, name);
-    glUniformMatrix3fv(loc, 1, GL_FALSE, (float*)value);
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_mat3_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_mat4(ShaderProgram *self, const char* name, mat4 value) {
-    if (!self || !name) return;  // Кэширование матриц и массивов слишком дорого и сложно, по этому тут нет.
-    int32_t loc = self->get_location(self, name);
-    glUniformMatrix4fv(loc, 1, GL_FALSE, (float*)value);
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_mat4_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_mat2x3(ShaderProgram *self, const char* name, mat2x3 value) {
-    if (!self || !name) return;  // Кэширование матриц и массивов слишком дорого и сложно, по этому тут нет.
-    int32_t loc = self->get_location(self, name);
-    glUniformMatrix2x3fv(loc, 1, GL_FALSE, (float*)value);
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_mat2x3_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_mat3x2(ShaderProgram *self, const char* name, mat3x2 value) {
-    if (!self || !name) return;  // Кэширование матриц и массивов слишком дорого и сложно, по этому тут нет.
-    int32_t loc = self->get_location(self, name);
-    glUniformMatrix3x2fv(loc, 1, GL_FALSE, (float*)value);
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_mat3x2_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_mat2x4(ShaderProgram *self, const char* name, mat2x4 value) {
-    if (!self || !name) return;  // Кэширование матриц и массивов слишком дорого и сложно, по этому тут нет.
-    int32_t loc = self->get_location(self, name);
-    glUniformMatrix2x4fv(loc, 1, GL_FALSE, (float*)value);
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_mat2x4_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_mat4x2(ShaderProgram *self, const char* name, mat4x2 value) {
-    if (!self || !name) return;  // Кэширование матриц и массивов слишком дорого и сложно, по этому тут нет.
-    int32_t loc = self->get_location(self, name);
-    glUniformMatrix4x2fv(loc, 1, GL_FALSE, (float*)value);
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_mat4x2_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_mat3x4(ShaderProgram *self, const char* name, mat3x4 value) {
-    if (!self || !name) return;  // Кэширование матриц и массивов слишком дорого и сложно, по этому тут нет.
-    int32_t loc = self->get_location(self, name);
-    glUniformMatrix3x4fv(loc, 1, GL_FALSE, (float*)value);
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_mat3x4_h(self, self->get_uniform(self, name), value);
 }
 
 
 static void ShaderGL_Impl_set_uniform_mat4x3(ShaderProgram *self, const char* name, mat4x3 value) {
-    if (!self || !name) return;  // Кэширование матриц и массивов слишком дорого и сложно, по этому тут нет.
-    int32_t loc = self->get_location(self, name);
-    glUniformMatrix4x3fv(loc, 1, GL_FALSE, (float*)value);
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_mat4x3_h(self, self->get_uniform(self, name), value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_int_array(ShaderProgram *self, const char* name, const int *values, int count) {
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_int_array_h(self, self->get_uniform(self, name), values, count);
+}
+
+
+static void ShaderGL_Impl_set_uniform_float_array(ShaderProgram *self, const char* name, const float *values, int count) {
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_float_array_h(self, self->get_uniform(self, name), values, count);
+}
+
+
+static void ShaderGL_Impl_set_uniform_vec2_array(ShaderProgram *self, const char* name, const Vec2f *values, int count) {
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_vec2_array_h(self, self->get_uniform(self, name), values, count);
+}
+
+
+static void ShaderGL_Impl_set_uniform_vec3_array(ShaderProgram *self, const char* name, const Vec3f *values, int count) {
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_vec3_array_h(self, self->get_uniform(self, name), values, count);
+}
+
+
+static void ShaderGL_Impl_set_uniform_vec4_array(ShaderProgram *self, const char* name, const Vec4f *values, int count) {
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_vec4_array_h(self, self->get_uniform(self, name), values, count);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat4_array(ShaderProgram *self, const char* name, const mat4 *values, int count) {
+    if (!self || !name) return;
+    ShaderGL_Impl_set_uniform_mat4_array_h(self, self->get_uniform(self, name), values, count);
+}
+
+
+// Установка значений по дескриптору (загрузка пропускается, если значение совпадает с кэшем):
+
+
+static void ShaderGL_Impl_set_uniform_bool_h(ShaderProgram *self, ShaderUniform uniform, bool value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (u->has_value && u->vbool == value) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    u->vbool = value;
+    u->has_value = true;
+    u->shadow_valid = 0;
+    self->uniform_uploads++;
+    glUniform1i(u->location, (int)value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_int_h(ShaderProgram *self, ShaderUniform uniform, int value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (u->has_value && u->vint == value) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    u->vint = value;
+    u->has_value = true;
+    u->shadow_valid = 0;
+    self->uniform_uploads++;
+    glUniform1i(u->location, value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_float_h(ShaderProgram *self, ShaderUniform uniform, float value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (u->has_value && cmp_float(u->vfloat, value)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    u->vfloat = value;
+    u->has_value = true;
+    u->shadow_valid = 0;
+    self->uniform_uploads++;
+    glUniform1f(u->location, value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_vec2_h(ShaderProgram *self, ShaderUniform uniform, Vec2f value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_vec(u, (float*)&value, 2)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniform2fv(u->location, 1, (float*)&value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_vec3_h(ShaderProgram *self, ShaderUniform uniform, Vec3f value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_vec(u, (float*)&value, 3)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniform3fv(u->location, 1, (float*)&value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_vec4_h(ShaderProgram *self, ShaderUniform uniform, Vec4f value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_vec(u, (float*)&value, 4)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniform4fv(u->location, 1, (float*)&value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat2_h(ShaderProgram *self, ShaderUniform uniform, mat2 value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_mat(u, (float*)value, 4)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniformMatrix2fv(u->location, 1, GL_FALSE, (float*)value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat3_h(ShaderProgram *self, ShaderUniform uniform, mat3 value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_mat(u, (float*)value, 9)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniformMatrix3fv(u->location, 1, GL_FALSE, (float*)value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat4_h(ShaderProgram *self, ShaderUniform uniform, mat4 value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_mat(u, (float*)value, 16)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniformMatrix4fv(u->location, 1, GL_FALSE, (float*)value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat2x3_h(ShaderProgram *self, ShaderUniform uniform, mat2x3 value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_mat(u, (float*)value, 6)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniformMatrix2x3fv(u->location, 1, GL_FALSE, (float*)value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat3x2_h(ShaderProgram *self, ShaderUniform uniform, mat3x2 value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_mat(u, (float*)value, 6)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniformMatrix3x2fv(u->location, 1, GL_FALSE, (float*)value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat2x4_h(ShaderProgram *self, ShaderUniform uniform, mat2x4 value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_mat(u, (float*)value, 8)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniformMatrix2x4fv(u->location, 1, GL_FALSE, (float*)value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat4x2_h(ShaderProgram *self, ShaderUniform uniform, mat4x2 value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_mat(u, (float*)value, 8)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniformMatrix4x2fv(u->location, 1, GL_FALSE, (float*)value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat3x4_h(ShaderProgram *self, ShaderUniform uniform, mat3x4 value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_mat(u, (float*)value, 12)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniformMatrix3x4fv(u->location, 1, GL_FALSE, (float*)value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat4x3_h(ShaderProgram *self, ShaderUniform uniform, mat4x3 value) {
+    if (!self) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_mat(u, (float*)value, 12)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniformMatrix4x3fv(u->location, 1, GL_FALSE, (float*)value);
+}
+
+
+static void ShaderGL_Impl_set_uniform_int_array_h(ShaderProgram *self, ShaderUniform uniform, const int *values, int count) {
+    if (!self || !values || count <= 0) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_array(self, u, values, sizeof(int) * (size_t)count)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniform1iv(u->location, count, values);
+}
+
+
+static void ShaderGL_Impl_set_uniform_float_array_h(ShaderProgram *self, ShaderUniform uniform, const float *values, int count) {
+    if (!self || !values || count <= 0) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_array(self, u, values, sizeof(float) * (size_t)count)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniform1fv(u->location, count, values);
+}
+
+
+static void ShaderGL_Impl_set_uniform_vec2_array_h(ShaderProgram *self, ShaderUniform uniform, const Vec2f *values, int count) {
+    if (!self || !values || count <= 0) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_array(self, u, values, sizeof(Vec2f) * (size_t)count)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniform2fv(u->location, count, (const float*)values);
+}
+
+
+static void ShaderGL_Impl_set_uniform_vec3_array_h(ShaderProgram *self, ShaderUniform uniform, const Vec3f *values, int count) {
+    if (!self || !values || count <= 0) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_array(self, u, values, sizeof(Vec3f) * (size_t)count)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniform3fv(u->location, count, (const float*)values);
+}
+
+
+static void ShaderGL_Impl_set_uniform_vec4_array_h(ShaderProgram *self, ShaderUniform uniform, const Vec4f *values, int count) {
+    if (!self || !values || count <= 0) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_array(self, u, values, sizeof(Vec4f) * (size_t)count)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniform4fv(u->location, count, (const float*)values);
+}
+
+
+static void ShaderGL_Impl_set_uniform_mat4_array_h(ShaderProgram *self, ShaderUniform uniform, const mat4 *values, int count) {
+    if (!self || !values || count <= 0) return;
+    ShaderUniformInfo *u = uniform_info(self, uniform);
+    if (!u) return;  // Униформа не найдена.
+    if (!update_cached_array(self, u, values, sizeof(mat4) * (size_t)count)) { self->uniform_skipped++; return; }  // Значение не изменилось.
+    self->uniform_uploads++;
+    glUniformMatrix4fv(u->location, count, GL_FALSE, (const float*)values);
+}
+
+
+// Привязка текстур к сэмплерам:
+
+
+static void ShaderGL_Impl_set_sampler2d(ShaderProgram *self, const char* name, Texture *texture) {
+    if (!self || !name) return;
+    ShaderGL_Impl_set_sampler2d_h(self, self->get_uniform(self, name), texture);
+}
+
+
+static void ShaderGL_Impl_set_sampler2d_h(ShaderProgram *self, ShaderUniform uniform, Texture *texture) {
+    if (!self || !uniform_info(self, uniform)) return;
+    uint32_t unit = TextureUnitsGL_bind(texture ? texture->id : 0);
+    ShaderGL_Impl_set_uniform_int_h(self, uniform, (int)unit);  // Номер юнита кэшируется как обычный int.
+}
+
+
+static void ShaderGL_Impl_set_sampler2d_array(ShaderProgram *self, const char* name, Texture *const *textures, int count) {
+    if (!self || !name) return;
+    ShaderGL_Impl_set_sampler2d_array_h(self, self->get_uniform(self, name), textures, count);
+}
+
+
+static void ShaderGL_Impl_set_sampler2d_array_h(ShaderProgram *self, ShaderUniform uniform, Texture *const *textures, int count) {
+    if (!self || !textures || count <= 0 || !uniform_info(self, uniform)) return;
+    if ((uint32_t)count > TextureUnitsGL_capacity()) {
+        fprintf(stderr, "ShaderGL_Impl_set_sampler2d_array_h: Too many textures (%d, max %u).\n", count, TextureUnitsGL_capacity());
+        return;
+    }
+    int units[STATE_GL_MAX_TEXTURE_UNITS];
+    for (int i = 0; i < count; i++) {
+        units[i] = (int)TextureUnitsGL_bind(textures[i] ? textures[i]->id : 0);
+    }
+    ShaderGL_Impl_set_uniform_int_array_h(self, uniform, units, count);
 }
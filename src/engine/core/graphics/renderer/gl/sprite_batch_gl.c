@@ -0,0 +1,188 @@
+//
+// sprite_batch_gl.c - Реализует пакетную отрисовку спрайтов на OpenGL.
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include "../../../mm/mm.h"
+#include "../../../varray.h"
+#include "../../gl.h"
+#include "../../renderer.h"
+#include "../../shader.h"
+#include "../../texture.h"
+#include "../../sprite_batch.h"
+#include "buffer_gc_gl.h"
+#include "state_gl.h"
+#include "stream_buffer_gl.h"
+#include "sprite_batch_gl.h"
+
+
+// Размер сегмента потокового буфера (столько вершин пакет пишет за кадр без роста буфера):
+#define SPRITE_BATCH_GL_STREAM_SIZE (SPRITE_BATCH_DEFAULT_CAPACITY * 4 * sizeof(SpriteBatchVertex))
+
+
+// Объявление функций:
+static void SpriteBatchGL_Impl_begin(SpriteBatch *self);
+static void SpriteBatchGL_Impl_end(SpriteBatch *self);
+static void SpriteBatchGL_Impl_flush(SpriteBatch *self);
+static void SpriteBatchGL_Impl__destroy_(SpriteBatch *self);
+
+
+// Настроить атрибуты вершин на текущий буфер OpenGL потокового буфера (VAO должен быть привязан):
+static void bind_stream_layout(SpriteBatchGL_Data *data) {
+    data->stream_id = data->stream->id;
+    StateGL_bind_buffer(GL_ARRAY_BUFFER, data->stream_id);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SpriteBatchVertex), (void*)offsetof(SpriteBatchVertex, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteBatchVertex), (void*)offsetof(SpriteBatchVertex, u));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SpriteBatchVertex), (void*)offsetof(SpriteBatchVertex, color));
+    glEnableVertexAttribArray(2);
+}
+
+
+// Создать объекты OpenGL пакета:
+static void create_objects(SpriteBatchGL_Data *data, Renderer *renderer) {
+    glGenVertexArrays(1, &data->vao);
+    glGenBuffers(1, &data->ibo);
+    data->stream = StreamBufferGL_create(GL_ARRAY_BUFFER, SPRITE_BATCH_GL_STREAM_SIZE);
+
+    // Индексы одинаковы для всех квадов, поэтому заполняем их один раз (0 1 2 2 3 0 на каждый квад):
+    size_t index_count = (size_t)SPRITE_BATCH_MAX_QUADS_PER_DRAW * 6;
+    uint16_t *indices = mm_alloc_tagged(index_count * sizeof(uint16_t), MM_TAG_RENDERER);
+    if (!indices) mm_alloc_error();
+    for (uint32_t q = 0; q < SPRITE_BATCH_MAX_QUADS_PER_DRAW; q++) {
+        uint16_t v = (uint16_t)(q * 4);
+        uint16_t *i = &indices[q * 6];
+        i[0] = v; i[1] = v + 1; i[2] = v + 2;
+        i[3] = v + 2; i[4] = v + 3; i[5] = v;
+    }
+
+    // Раскладка вершин (индексный буфер запоминается в VAO):
+    StateGL_bind_vao(data->vao);
+    StateGL_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, data->ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(uint16_t), indices, GL_STATIC_DRAW);
+    if (data->stream) bind_stream_layout(data);
+    StateGL_bind_vao(0);
+    mm_free(indices);
+
+    // Белая текстура для спрайтов без текстуры:
+    static const uint8_t white_pixel[4] = {255, 255, 255, 255};
+    data->white = Texture_create(renderer);
+    if (data->white) data->white->set_data(data->white, 1, 1, white_pixel, false, TEX_RGBA, TEX_RGBA, TEX_DATA_UBYTE);
+}
+
+
+// Регистрируем функции реализации апи для пакета спрайтов:
+void SpriteBatchGL_RegisterAPI(SpriteBatch *batch) {
+    SpriteBatchGL_Data *data = mm_calloc_tagged(1, sizeof(SpriteBatchGL_Data), MM_TAG_RENDERER);
+    if (!data) mm_alloc_error();
+    data->u_texture = SHADER_UNIFORM_INVALID;
+    create_objects(data, batch->renderer);
+
+    batch->data = data;
+    batch->begin = SpriteBatchGL_Impl_begin;
+    batch->end = SpriteBatchGL_Impl_end;
+    batch->flush = SpriteBatchGL_Impl_flush;
+    batch->_destroy_ = SpriteBatchGL_Impl__destroy_;
+}
+
+
+// Реализация API:
+
+
+static void SpriteBatchGL_Impl_begin(SpriteBatch *self) {
+    if (!self || self->_is_begin_) return;
+    VArray_clear(self->sprites);
+    self->draw_calls = 0;
+    self->vertices_drawn = 0;
+    self->sprites_drawn = 0;
+    self->_is_begin_ = true;
+}
+
+
+static void SpriteBatchGL_Impl_end(SpriteBatch *self) {
+    if (!self || !self->_is_begin_) return;
+    self->flush(self);
+    self->_is_begin_ = false;
+}
+
+
+static void SpriteBatchGL_Impl_flush(SpriteBatch *self) {
+    if (!self || VArray_len(self->sprites) == 0) return;
+    SpriteBatchGL_Data *data = (SpriteBatchGL_Data*)self->data;
+
+    ShaderProgram *shader = self->shader;
+    if (!shader) shader = self->renderer->get_default_shader(
+        self->renderer, RENDERER_SHADER_TEXTURE | RENDERER_SHADER_VERTEX_COLOR
+    );
+    if (!shader) {
+        VArray_clear(self->sprites);
+        return;
+    }
+
+    // Сортируем и собираем вершины:
+    SpriteBatch_build(self);
+    size_t vertex_bytes = VArray_len(self->vertices) * sizeof(SpriteBatchVertex);
+
+    // Все вершины уходят одним копированием в потоковый буфер. Смещение записи кратно размеру вершины,
+    // поэтому дальше оно просто добавляется к базовой вершине каждого вызова отрисовки:
+    size_t offset = 0;
+    void *memory = data->stream ? StreamBufferGL_map(data->stream, vertex_bytes, sizeof(SpriteBatchVertex), &offset) : NULL;
+    if (!memory) {
+        VArray_clear(self->sprites);
+        return;
+    }
+    memcpy(memory, self->vertices->data, vertex_bytes);
+    StreamBufferGL_unmap(data->stream);
+    uint32_t base_vertex = (uint32_t)(offset / sizeof(SpriteBatchVertex));
+
+    // Дескриптор сэмплера запрашиваем только при смене шейдера:
+    if (data->u_texture_shader != shader) {
+        data->u_texture = shader->get_uniform(shader, "u_texture");
+        data->u_texture_shader = shader;
+    }
+
+    shader->begin(shader);
+    StateGL_set_blend(true);
+    StateGL_bind_vao(data->vao);
+    if (data->stream_id != data->stream->id) bind_stream_layout(data);  // Потоковый буфер вырос и сменил буфер OpenGL.
+
+    // Одна группа текстуры - один вызов отрисовки (или несколько, если спрайтов больше, чем вмещают 16-битные индексы):
+    size_t run_count = VArray_len(self->runs);
+    for (size_t r = 0; r < run_count; r++) {
+        SpriteBatchRun *run = &VArray_at(self->runs, SpriteBatchRun, r);
+        shader->set_sampler2d_h(shader, data->u_texture, run->texture ? run->texture : data->white);
+        for (uint32_t done = 0; done < run->count;) {
+            uint32_t quads = run->count - done;
+            if (quads > SPRITE_BATCH_MAX_QUADS_PER_DRAW) quads = SPRITE_BATCH_MAX_QUADS_PER_DRAW;
+            glDrawElementsBaseVertex(GL_TRIANGLES, (int)(quads * 6), GL_UNSIGNED_SHORT, NULL, (int)(base_vertex + (run->first + done) * 4));
+            self->draw_calls++;
+            done += quads;
+        }
+    }
+
+    StateGL_bind_vao(0);
+    shader->end(shader);
+
+    self->vertices_drawn += VArray_len(self->vertices);
+    self->sprites_drawn += VArray_len(self->sprites);
+    VArray_clear(self->sprites);
+}
+
+
+static void SpriteBatchGL_Impl__destroy_(SpriteBatch *self) {
+    if (!self || !self->data) return;
+    SpriteBatchGL_Data *data = (SpriteBatchGL_Data*)self->data;
+    BufferGC_GL_push(BGC_GL_VAO, data->vao);  // Добавляем буферы в стек на уничтожение.
+    BufferGC_GL_push(BGC_GL_IBO, data->ibo);
+    StreamBufferGL_destroy(&data->stream);
+    Texture_destroy(&data->white);
+    mm_free(data);
+    self->data = NULL;
+}
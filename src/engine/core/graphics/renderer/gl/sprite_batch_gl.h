@@ -0,0 +1,34 @@
+//
+// sprite_batch_gl.h
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+
+
+// Объявление структур:
+typedef struct SpriteBatch SpriteBatch;
+typedef struct SpriteBatchGL_Data SpriteBatchGL_Data;
+typedef struct Texture Texture;
+typedef struct ShaderProgram ShaderProgram;
+typedef struct StreamBufferGL StreamBufferGL;
+
+
+// Объекты OpenGL пакета спрайтов:
+typedef struct SpriteBatchGL_Data {
+    uint32_t vao;        // Раскладка вершин спрайтов.
+    StreamBufferGL *stream;  // Потоковый вершинный буфер.
+    uint32_t stream_id;  // Буфер OpenGL, на который настроена раскладка (меняется при росте потокового буфера).
+    uint32_t ibo;        // Общие индексы квадов (заполняются один раз).
+    Texture *white;      // Белая текстура 1x1 для спрайтов без текстуры.
+    int32_t u_texture;   // Дескриптор сэмплера в шейдере (ShaderUniform).
+    ShaderProgram *u_texture_shader;  // Шейдер, для которого получен дескриптор.
+} SpriteBatchGL_Data;
+
+
+// Регистрируем функции реализации апи для пакета спрайтов:
+void SpriteBatchGL_RegisterAPI(SpriteBatch *batch);
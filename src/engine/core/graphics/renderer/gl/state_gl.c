@@ -0,0 +1,213 @@
+//
+// state_gl.c - Теневая копия состояния OpenGL (пропуск лишних привязок и запросов).
+//
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "../../gl.h"
+#include "buffer_gc_gl.h"
+#include "state_gl.h"
+
+
+// Создаём единую глобальную структуру:
+StateGL state_gl = {0};
+
+
+// Получить индекс точки привязки буфера (STATE_GL_BUFFER_TARGETS если она не отслеживается):
+static inline StateGL_BufferTarget buffer_target_index(uint32_t target) {
+    switch (target) {
+        case GL_ARRAY_BUFFER:         return STATE_GL_ARRAY_BUFFER;
+        case GL_ELEMENT_ARRAY_BUFFER: return STATE_GL_ELEMENT_ARRAY_BUFFER;
+        case GL_UNIFORM_BUFFER:       return STATE_GL_UNIFORM_BUFFER;
+        default:                      return STATE_GL_BUFFER_TARGETS;
+    }
+}
+
+
+// Заполнить все поля состояния одним значением:
+static void fill_state(uint32_t value) {
+    state_gl.program = value;
+    state_gl.active_unit = value;
+    for (int i = 0; i < STATE_GL_MAX_TEXTURE_UNITS; i++) state_gl.textures[i] = value;
+    state_gl.vao = value;
+    state_gl.draw_framebuffer = value;
+    state_gl.read_framebuffer = value;
+    for (int i = 0; i < STATE_GL_BUFFER_TARGETS; i++) state_gl.buffers[i] = value;
+    state_gl.blend = value;
+    state_gl.blend_src = value;
+    state_gl.blend_dst = value;
+    state_gl.depth_test = value;
+    state_gl.viewport_known = false;
+}
+
+
+// Инициализация после создания контекста (состояние по умолчанию у OpenGL известно):
+void StateGL_init() {
+    fill_state(0);
+    state_gl.blend_src = GL_ONE;
+    state_gl.blend_dst = GL_ZERO;
+    state_gl.issued = 0;
+    state_gl.elided = 0;
+}
+
+
+// Забыть состояние (после прямых вызовов gl* в обход кэша):
+void StateGL_reset() {
+    fill_state(STATE_GL_UNKNOWN);
+}
+
+
+// Сделать программу активной:
+void StateGL_use_program(uint32_t program) {
+    if (state_gl.program == program) { state_gl.elided++; return; }
+    glUseProgram(program);
+    state_gl.program = program;
+    state_gl.issued++;
+}
+
+
+// Сделать текстурный юнит активным:
+void StateGL_active_texture(uint32_t unit) {
+    if (state_gl.active_unit == unit) { state_gl.elided++; return; }
+    glActiveTexture(GL_TEXTURE0 + unit);
+    state_gl.active_unit = unit;
+    state_gl.issued++;
+}
+
+
+// Привязать текстуру GL_TEXTURE_2D к юниту:
+void StateGL_bind_texture(uint32_t unit, uint32_t texture) {
+    if (unit < STATE_GL_MAX_TEXTURE_UNITS && state_gl.textures[unit] == texture) { state_gl.elided++; return; }
+    StateGL_active_texture(unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (unit < STATE_GL_MAX_TEXTURE_UNITS) state_gl.textures[unit] = texture;
+    state_gl.issued++;
+}
+
+
+// Привязать VAO:
+void StateGL_bind_vao(uint32_t vao) {
+    if (state_gl.vao == vao) { state_gl.elided++; return; }
+    glBindVertexArray(vao);
+    state_gl.vao = vao;
+    state_gl.buffers[STATE_GL_ELEMENT_ARRAY_BUFFER] = STATE_GL_UNKNOWN;  // Индексный буфер хранится в VAO.
+    state_gl.issued++;
+}
+
+
+// Привязать буфер (target - GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER или GL_UNIFORM_BUFFER):
+void StateGL_bind_buffer(uint32_t target, uint32_t buffer) {
+    StateGL_BufferTarget index = buffer_target_index(target);
+    if (index != STATE_GL_BUFFER_TARGETS && state_gl.buffers[index] == buffer) { state_gl.elided++; return; }
+    glBindBuffer(target, buffer);
+    if (index != STATE_GL_BUFFER_TARGETS) state_gl.buffers[index] = buffer;
+    state_gl.issued++;
+}
+
+
+// Привязать буфер к индексированной точке привязки (меняет и общую точку target):
+void StateGL_bind_buffer_base(uint32_t target, uint32_t index, uint32_t buffer) {
+    glBindBufferBase(target, index, buffer);
+    StateGL_BufferTarget target_index = buffer_target_index(target);
+    if (target_index != STATE_GL_BUFFER_TARGETS) state_gl.buffers[target_index] = buffer;
+    state_gl.issued++;
+}
+
+
+// Привязать кадровый буфер (target - GL_FRAMEBUFFER, GL_DRAW_FRAMEBUFFER или GL_READ_FRAMEBUFFER):
+void StateGL_bind_framebuffer(uint32_t target, uint32_t framebuffer) {
+    bool draw = target != GL_READ_FRAMEBUFFER;
+    bool read = target != GL_DRAW_FRAMEBUFFER;
+    if ((!draw || state_gl.draw_framebuffer == framebuffer) && (!read || state_gl.read_framebuffer == framebuffer)) {
+        state_gl.elided++;
+        return;
+    }
+    glBindFramebuffer(target, framebuffer);
+    if (draw) state_gl.draw_framebuffer = framebuffer;
+    if (read) state_gl.read_framebuffer = framebuffer;
+    state_gl.issued++;
+}
+
+
+// Включить или выключить смешивание:
+void StateGL_set_blend(bool enabled) {
+    if (state_gl.blend == (uint32_t)enabled) { state_gl.elided++; return; }
+    if (enabled) glEnable(GL_BLEND);
+    else glDisable(GL_BLEND);
+    state_gl.blend = (uint32_t)enabled;
+    state_gl.issued++;
+}
+
+
+// Установить функцию смешивания:
+void StateGL_set_blend_func(uint32_t src, uint32_t dst) {
+    if (state_gl.blend_src == src && state_gl.blend_dst == dst) { state_gl.elided++; return; }
+    glBlendFunc(src, dst);
+    state_gl.blend_src = src;
+    state_gl.blend_dst = dst;
+    state_gl.issued++;
+}
+
+
+// Включить или выключить тест глубины:
+void StateGL_set_depth_test(bool enabled) {
+    if (state_gl.depth_test == (uint32_t)enabled) { state_gl.elided++; return; }
+    if (enabled) glEnable(GL_DEPTH_TEST);
+    else glDisable(GL_DEPTH_TEST);
+    state_gl.depth_test = (uint32_t)enabled;
+    state_gl.issued++;
+}
+
+
+// Установить область просмотра:
+void StateGL_set_viewport(int x, int y, int width, int height) {
+    if (state_gl.viewport_known && state_gl.viewport[0] == x && state_gl.viewport[1] == y &&
+        state_gl.viewport[2] == width && state_gl.viewport[3] == height) {
+        state_gl.elided++;
+        return;
+    }
+    glViewport(x, y, width, height);
+    state_gl.viewport[0] = x;
+    state_gl.viewport[1] = y;
+    state_gl.viewport[2] = width;
+    state_gl.viewport[3] = height;
+    state_gl.viewport_known = true;
+    state_gl.issued++;
+}
+
+
+// Забыть удалённые объекты (OpenGL сам отвязывает их при удалении):
+void StateGL_forget_deleted(BufferGC_GL_Type type, const uint32_t *ids, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t id = ids[i];
+        switch (type) {
+            case BGC_GL_TBO:
+                for (int u = 0; u < STATE_GL_MAX_TEXTURE_UNITS; u++) {
+                    if (state_gl.textures[u] == id) state_gl.textures[u] = 0;
+                }
+                break;
+            case BGC_GL_VAO:
+                if (state_gl.vao == id) {
+                    state_gl.vao = 0;
+                    state_gl.buffers[STATE_GL_ELEMENT_ARRAY_BUFFER] = STATE_GL_UNKNOWN;
+                }
+                break;
+            case BGC_GL_FBO:
+                if (state_gl.draw_framebuffer == id) state_gl.draw_framebuffer = 0;
+                if (state_gl.read_framebuffer == id) state_gl.read_framebuffer = 0;
+                break;
+            case BGC_GL_VBO:
+            case BGC_GL_IBO:
+            case BGC_GL_SSBO:
+                for (int b = 0; b < STATE_GL_BUFFER_TARGETS; b++) {
+                    if (state_gl.buffers[b] == id) state_gl.buffers[b] = 0;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
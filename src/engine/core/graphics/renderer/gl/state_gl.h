@@ -0,0 +1,103 @@
+//
+// state_gl.h - Теневая копия состояния OpenGL.
+//
+// Все *_GL реализации меняют состояние через эти функции: если значение уже стоит,
+// вызов OpenGL пропускается, а текущее значение берётся из копии без glGet*.
+// Если состояние поменяли в обход (прямыми вызовами gl*), вызовите StateGL_reset().
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "buffer_gc_gl.h"
+
+
+// Определения:
+#define STATE_GL_MAX_TEXTURE_UNITS 32          // Сколько текстурных юнитов отслеживается.
+#define STATE_GL_UNKNOWN           UINT32_MAX  // Значение неизвестно (следующая установка точно вызовет OpenGL).
+
+
+// Отслеживаемые точки привязки буферов:
+typedef enum StateGL_BufferTarget {
+    STATE_GL_ARRAY_BUFFER,          // GL_ARRAY_BUFFER.
+    STATE_GL_ELEMENT_ARRAY_BUFFER,  // GL_ELEMENT_ARRAY_BUFFER (часть состояния VAO).
+    STATE_GL_UNIFORM_BUFFER,        // GL_UNIFORM_BUFFER.
+    STATE_GL_BUFFER_TARGETS,        // Количество точек привязки.
+} StateGL_BufferTarget;
+
+
+// Объявление структур:
+typedef struct StateGL StateGL;
+
+
+// Теневая копия состояния:
+typedef struct StateGL {
+    uint32_t program;      // Активная программа.
+    uint32_t active_unit;  // Активный текстурный юнит.
+    uint32_t textures[STATE_GL_MAX_TEXTURE_UNITS];  // Текстуры GL_TEXTURE_2D на юнитах.
+    uint32_t vao;          // Привязанный VAO.
+    uint32_t draw_framebuffer;  // Кадровый буфер для рисования (GL_DRAW_FRAMEBUFFER).
+    uint32_t read_framebuffer;  // Кадровый буфер для чтения (GL_READ_FRAMEBUFFER).
+    uint32_t buffers[STATE_GL_BUFFER_TARGETS];      // Привязанные буферы.
+    uint32_t blend;        // Смешивание включено (0/1 или STATE_GL_UNKNOWN).
+    uint32_t blend_src;    // Функция смешивания (источник).
+    uint32_t blend_dst;    // Функция смешивания (приёмник).
+    uint32_t depth_test;   // Тест глубины включён (0/1 или STATE_GL_UNKNOWN).
+    int32_t viewport[4];   // Область просмотра.
+    bool viewport_known;   // Область просмотра известна.
+
+    // Статистика:
+    size_t issued;  // Сколько вызовов ушло в OpenGL.
+    size_t elided;  // Сколько вызовов пропущено, потому что состояние уже стояло.
+} StateGL;
+
+
+// Создаём единую глобальную структуру:
+extern StateGL state_gl;
+
+
+// Инициализация после создания контекста (состояние по умолчанию у OpenGL известно):
+void StateGL_init();
+
+// Забыть состояние (после прямых вызовов gl* в обход кэша):
+void StateGL_reset();
+
+// Сделать программу активной:
+void StateGL_use_program(uint32_t program);
+
+// Сделать текстурный юнит активным:
+void StateGL_active_texture(uint32_t unit);
+
+// Привязать текстуру GL_TEXTURE_2D к юниту:
+void StateGL_bind_texture(uint32_t unit, uint32_t texture);
+
+// Привязать VAO:
+void StateGL_bind_vao(uint32_t vao);
+
+// Привязать буфер (target - GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER или GL_UNIFORM_BUFFER):
+void StateGL_bind_buffer(uint32_t target, uint32_t buffer);
+
+// Привязать буфер к индексированной точке привязки (меняет и общую точку target):
+void StateGL_bind_buffer_base(uint32_t target, uint32_t index, uint32_t buffer);
+
+// Привязать кадровый буфер (target - GL_FRAMEBUFFER, GL_DRAW_FRAMEBUFFER или GL_READ_FRAMEBUFFER):
+void StateGL_bind_framebuffer(uint32_t target, uint32_t framebuffer);
+
+// Включить или выключить смешивание:
+void StateGL_set_blend(bool enabled);
+
+// Установить функцию смешивания:
+void StateGL_set_blend_func(uint32_t src, uint32_t dst);
+
+// Включить или выключить тест глубины:
+void StateGL_set_depth_test(bool enabled);
+
+// Установить область просмотра:
+void StateGL_set_viewport(int x, int y, int width, int height);
+
+// Забыть удалённые объекты (OpenGL сам отвязывает их при удалении):
+void StateGL_forget_deleted(BufferGC_GL_Type type, const uint32_t *ids, size_t count);
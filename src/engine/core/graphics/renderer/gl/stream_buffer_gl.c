@@ -0,0 +1,195 @@
+//
+// stream_buffer_gl.c - Потоковый буфер OpenGL (кольцо из сегментов) для данных, которые меняются каждый кадр.
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../../../mm/mm.h"
+#include "../../gl.h"
+#include "buffer_gc_gl.h"
+#include "state_gl.h"
+#include "stream_buffer_gl.h"
+
+
+// Флаги хранилища и отображения для persistent буфера:
+#define STREAM_PERSISTENT_FLAGS (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT)
+
+
+// Номер текущего кадра (общий для всех потоковых буферов):
+static uint64_t stream_buffer_gl_frame = 1;
+
+
+// Выделить хранилище буфера под текущий segment_size:
+static void allocate_storage(StreamBufferGL *stream) {
+    size_t total = stream->segment_size * STREAM_BUFFER_GL_SEGMENTS;
+
+    // Буфер без persistent можно взять из пула (его содержимое всё равно перезаписывается):
+    stream->id = stream->persistent ? 0 : BufferGC_GL_reuse(BGC_GL_VBO, BufferGC_GL_buffer_key(total, GL_STREAM_DRAW));
+    if (stream->id) {
+        stream->mapped = NULL;
+        stream->segment = 0;
+        stream->offset = 0;
+        return;
+    }
+    glGenBuffers(1, &stream->id);
+    StateGL_bind_buffer(stream->target, stream->id);
+    if (stream->persistent) {
+        glBufferStorage(stream->target, (GLsizeiptr)total, NULL, STREAM_PERSISTENT_FLAGS);
+        stream->mapped = glMapBufferRange(stream->target, 0, (GLsizeiptr)total, STREAM_PERSISTENT_FLAGS);
+        if (!stream->mapped) {
+            // Драйвер не дал отобразить буфер, откатываемся на запись через glMapBufferRange:
+            fprintf(stderr, "StreamBufferGL_create: Persistent mapping failed, falling back to orphaning.\n");
+            BufferGC_GL_push(BGC_GL_VBO, stream->id);
+            stream->persistent = false;
+            allocate_storage(stream);
+            return;
+        }
+    } else {
+        glBufferData(stream->target, (GLsizeiptr)total, NULL, GL_STREAM_DRAW);
+        stream->mapped = NULL;
+    }
+    stream->segment = 0;
+    stream->offset = 0;
+}
+
+
+// Освободить заборы и хранилище (буфер удаляется через BufferGC, когда видеокарта с ним закончит):
+static void release_storage(StreamBufferGL *stream) {
+    for (int i = 0; i < STREAM_BUFFER_GL_SEGMENTS; i++) {
+        if (stream->fences[i]) glDeleteSync(stream->fences[i]);
+        stream->fences[i] = NULL;
+    }
+    if (stream->id && stream->persistent) {
+        BufferGC_GL_push(BGC_GL_VBO, stream->id);  // Удаление буфера снимает и отображение.
+    } else if (stream->id) {
+        size_t total = stream->segment_size * STREAM_BUFFER_GL_SEGMENTS;
+        BufferGC_GL_recycle(BGC_GL_VBO, stream->id, BufferGC_GL_buffer_key(total, GL_STREAM_DRAW));
+    }
+    stream->id = 0;
+    stream->mapped = NULL;
+}
+
+
+// Поставить забор на текущий сегмент и перейти к следующему, дождавшись, пока видеокарта его освободит:
+static void advance_segment(StreamBufferGL *stream) {
+    if (stream->offset > 0) {
+        if (stream->fences[stream->segment]) glDeleteSync(stream->fences[stream->segment]);
+        stream->fences[stream->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    stream->segment = (stream->segment + 1) % STREAM_BUFFER_GL_SEGMENTS;
+    stream->offset = 0;
+
+    GLsync fence = stream->fences[stream->segment];
+    if (!fence) return;
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        stream->waits++;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);  // По 1 мс.
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    stream->fences[stream->segment] = NULL;
+}
+
+
+// Создать потоковый буфер (segment_size - сколько байт можно записать за кадр без роста):
+StreamBufferGL* StreamBufferGL_create(uint32_t target, size_t segment_size) {
+    if (segment_size == 0) return NULL;
+
+    StreamBufferGL *stream = mm_calloc_tagged(1, sizeof(StreamBufferGL), MM_TAG_RENDERER);
+    if (!stream) mm_alloc_error();
+
+    // Заполняем поля:
+    stream->target = target;
+    stream->segment_size = segment_size;
+    stream->persistent = GLAD_GL_VERSION_4_4 && glBufferStorage;
+    stream->frame = stream_buffer_gl_frame;
+    allocate_storage(stream);
+    return stream;
+}
+
+
+// Уничтожить потоковый буфер:
+void StreamBufferGL_destroy(StreamBufferGL **stream) {
+    if (!stream || !*stream) return;
+    StreamBufferGL_unmap(*stream);
+    release_storage(*stream);
+    mm_free(*stream);
+    *stream = NULL;
+}
+
+
+// Получить память под size байт с выравниванием alignment (любое, не обязательно степень двойки):
+void* StreamBufferGL_map(StreamBufferGL *stream, size_t size, size_t alignment, size_t *offset) {
+    if (!stream || size == 0) return NULL;
+    if (stream->_is_mapped_) StreamBufferGL_unmap(stream);
+    if (alignment == 0) alignment = 1;
+
+    // Данные не влезают даже в пустой сегмент - пересоздаём буфер побольше:
+    if (size + alignment > stream->segment_size) {
+        release_storage(stream);
+        stream->segment_size = (size + alignment) + (size + alignment) / 2;
+        allocate_storage(stream);
+    }
+
+    if (stream->persistent) {
+        // Новый кадр пишем в новый сегмент, чтобы на каждом сегменте стоял забор своего кадра:
+        if (stream->frame != stream_buffer_gl_frame && stream->offset > 0) advance_segment(stream);
+        // Выравнивается смещение от начала буфера, а не от начала сегмента:
+        size_t start = stream->segment * stream->segment_size;
+        size_t aligned = (start + stream->offset + alignment - 1) / alignment * alignment - start;
+        if (aligned + size > stream->segment_size) {
+            advance_segment(stream);  // В сегменте не хватает места - переходим к следующему.
+            start = stream->segment * stream->segment_size;
+            aligned = (start + alignment - 1) / alignment * alignment - start;
+        }
+        stream->offset = aligned + size;
+        stream->frame = stream_buffer_gl_frame;
+        stream->bytes += size;
+        StateGL_bind_buffer(stream->target, stream->id);
+        if (offset) *offset = start + aligned;
+        return stream->mapped + start + aligned;
+    }
+
+    // Без persistent: пишем в свободный конец буфера, а если места нет - отбрасываем хранилище:
+    size_t total = stream->segment_size * STREAM_BUFFER_GL_SEGMENTS;
+    size_t aligned = (stream->offset + alignment - 1) / alignment * alignment;
+    StateGL_bind_buffer(stream->target, stream->id);
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    if (aligned + size > total) {
+        glBufferData(stream->target, (GLsizeiptr)total, NULL, GL_STREAM_DRAW);
+        stream->orphans++;
+        aligned = 0;
+    }
+    void *memory = glMapBufferRange(stream->target, (GLintptr)aligned, (GLsizeiptr)size, access);
+    if (!memory) {
+        fprintf(stderr, "StreamBufferGL_map: glMapBufferRange failed.\n");
+        return NULL;
+    }
+    stream->offset = aligned + size;
+    stream->frame = stream_buffer_gl_frame;
+    stream->bytes += size;
+    stream->_is_mapped_ = true;
+    if (offset) *offset = aligned;
+    return memory;
+}
+
+
+// Закончить запись:
+void StreamBufferGL_unmap(StreamBufferGL *stream) {
+    if (!stream || !stream->_is_mapped_) return;
+    StateGL_bind_buffer(stream->target, stream->id);
+    glUnmapBuffer(stream->target);
+    stream->_is_mapped_ = false;
+}
+
+
+// Начать новый кадр для всех потоковых буферов (вызывает рендерер в конце кадра):
+void StreamBufferGL_next_frame() {
+    stream_buffer_gl_frame++;
+}
@@ -0,0 +1,65 @@
+//
+// stream_buffer_gl.h - Потоковый буфер OpenGL (кольцо из сегментов) для данных, которые меняются каждый кадр.
+//
+// На OpenGL 4.4+ буфер создаётся через glBufferStorage и отображается в память один раз (persistent + coherent):
+// запись - это обычный memcpy, без вызовов драйвера. Буфер делится на STREAM_BUFFER_GL_SEGMENTS сегментов,
+// после каждого кадра (или при заполнении сегмента) ставится glFenceSync, и перед повторной записью
+// в сегмент мы ждём, пока видеокарта закончит его читать.
+// На OpenGL 3.3 запись идёт через glMapBufferRange(INVALIDATE_RANGE | UNSYNCHRONIZED) в свободную часть
+// буфера, а когда место кончается - старое хранилище отбрасывается (orphaning) и запись начинается сначала.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "../../gl.h"
+
+
+// Определения:
+#define STREAM_BUFFER_GL_SEGMENTS 3  // Сколько кадров данных живёт в кольце одновременно.
+
+
+// Объявление структур:
+typedef struct StreamBufferGL StreamBufferGL;
+
+
+// Структура потокового буфера:
+typedef struct StreamBufferGL {
+    uint32_t id;            // Буфер OpenGL.
+    uint32_t target;        // Точка привязки (GL_ARRAY_BUFFER и т.д.).
+    size_t segment_size;    // Размер одного сегмента в байтах.
+    bool persistent;        // Буфер постоянно отображён в память (OpenGL 4.4+).
+    uint8_t *mapped;        // Отображение всего буфера (только persistent).
+    GLsync fences[STREAM_BUFFER_GL_SEGMENTS];  // Забор на каждом сегменте (NULL - сегмент свободен).
+    uint32_t segment;       // Текущий сегмент.
+    size_t offset;          // Сколько байт занято в текущем сегменте (persistent) или во всём буфере.
+    uint64_t frame;         // Кадр, в котором была последняя запись.
+    bool _is_mapped_;       // Запись начата (map без unmap).
+
+    // Статистика:
+    size_t waits;    // Сколько раз пришлось ждать видеокарту.
+    size_t orphans;  // Сколько раз хранилище было отброшено (только без persistent).
+    size_t bytes;    // Сколько байт записано всего.
+} StreamBufferGL;
+
+
+// Создать потоковый буфер (segment_size - сколько байт можно записать за кадр без роста):
+StreamBufferGL* StreamBufferGL_create(uint32_t target, size_t segment_size);
+
+// Уничтожить потоковый буфер:
+void StreamBufferGL_destroy(StreamBufferGL **stream);
+
+// Получить память под size байт с выравниванием alignment (любое, не обязательно степень двойки).
+// В offset возвращается смещение данных в буфере (для glVertexAttribPointer/базовой вершины).
+// Буфер привязывается к своей точке привязки. После записи обязательно вызвать StreamBufferGL_unmap:
+void* StreamBufferGL_map(StreamBufferGL *stream, size_t size, size_t alignment, size_t *offset);
+
+// Закончить запись:
+void StreamBufferGL_unmap(StreamBufferGL *stream);
+
+// Начать новый кадр для всех потоковых буферов (вызывает рендерер в конце кадра):
+void StreamBufferGL_next_frame();
@@ -13,6 +13,7 @@
 #include "../../image.h"
 #include "../../texture.h"
 #include "buffer_gc_gl.h"
+#include "state_gl.h"
 #include "texture_gl.h"
 
 
@@ -48,15 +49,19 @@ void TextureGL_RegisterAPI(Texture *texture) {
 
 static void TextureGL_Impl_begin(Texture *self) {
     if (!self || self->_is_begin_ || self->id == 0) return;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &self->_id_before_begin_);
-    glBindTexture(GL_TEXTURE_2D, self->id);
+    // Привязываем всегда к юниту 0 (после TextureUnitsGL_bind активным остаётся LRU-юнит >= 1),
+    // прошлую текстуру берём из теневой копии (без glGet*):
+    uint32_t previous = state_gl.textures[0];
+    self->_id_before_begin_ = previous == STATE_GL_UNKNOWN ? 0 : (int32_t)previous;
+    self->_unit_ = 0;
+    StateGL_bind_texture(self->_unit_, self->id);
     self->_is_begin_ = true;
 }
 
 
 static void TextureGL_Impl_end(Texture *self) {
     if (!self || !self->_is_begin_) return;
-    glBindTexture(GL_TEXTURE_2D, (uint32_t)self->_id_before_begin_);
+    StateGL_bind_texture(self->_unit_, (uint32_t)self->_id_before_begin_);
     self->_is_begin_ = false;
 }
 
@@ -90,14 +95,6 @@ static void TextureGL_Impl_set_data(
     self->width = width <= 0 ? 1 : width;
     self->height = height <= 0 ? 1 : height;
 
-    // Если текстура еще не создана, то создаем ее:
-    if (self->id == 0) glGenTextures(1, &self->id);
-    if (self->id == 0) {  // Если она так и не создалась, то выходим:
-        fprintf(stderr, "TextureGL_Impl_set_data: The texture could not be created.\n");
-        return;
-    }
-    self->begin(self);
-
     // Подбираем формат текстуры:
     int gl_tex_format;
     switch (tex_format) {
@@ -143,6 +140,28 @@ static void TextureGL_Impl_set_data(
     if (gl_tex_format == GL_RGB16F || gl_tex_format == GL_RGBA16F) gl_data_type = GL_HALF_FLOAT;
     else if (gl_tex_format == GL_RGB32F || gl_tex_format == GL_RGBA32F) gl_data_type = GL_FLOAT;
 
+    // Если текстура еще не создана, то берём такую же из пула или создаем новую:
+    self->_pool_key_ = BufferGC_GL_texture_key(self->width, self->height, (uint32_t)gl_tex_format, use_mipmap);
+    bool reused = false;
+    if (self->id == 0) {
+        self->id = BufferGC_GL_reuse(BGC_GL_TBO, self->_pool_key_);
+        reused = self->id != 0;
+        if (!reused) glGenTextures(1, &self->id);
+    }
+    if (self->id == 0) {  // Если она так и не создалась, то выходим:
+        fprintf(stderr, "TextureGL_Impl_set_data: The texture could not be created.\n");
+        return;
+    }
+    self->begin(self);
+
+    // У текстуры из пула остались параметры прошлого владельца, возвращаем значения OpenGL по умолчанию:
+    if (reused) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    }
+
     // Загрузка данных текстуры:
     glTexImage2D(GL_TEXTURE_2D, 0, gl_tex_format, self->width, self->height, 0, gl_data_format, gl_data_type, data);
 
@@ -156,7 +175,7 @@ static Image* TextureGL_Impl_get_image(Texture *self, int channels) {
     if (!self) return NULL;
 
     // Выделяем память под данные (указатель на блок сохраняется в img ниже):
-    unsigned char* data = mm_alloc(self->width * self->height * channels);
+    unsigned char* data = mm_alloc_tagged(self->width * self->height * channels, MM_TAG_IMAGE);
     if (!data) mm_alloc_error();
 
     // Подбираем формат данных:
@@ -173,7 +192,7 @@ static Image* TextureGL_Impl_get_image(Texture *self, int channels) {
     self->end(self);
 
     // Создаём изображение:
-    Image* img = mm_alloc(sizeof(Image));
+    Image* img = mm_alloc_tagged(sizeof(Image), MM_TAG_IMAGE);
     if (!img) mm_alloc_error();
 
     img->width = self->width;
@@ -187,30 +206,38 @@ static Image* TextureGL_Impl_get_image(Texture *self, int channels) {
 
 static void TextureGL_Impl_set_filter(Texture *self, int name, int param) {
     if (!self) return;
-    self->begin(self);
+    bool was_begin = self->_is_begin_;  // Если текстура уже привязана - не отвязываем её.
+    if (!was_begin) self->begin(self);
     glTexParameteri(GL_TEXTURE_2D, name, param);
-    self->end(self);
+    if (!was_begin) self->end(self);
 }
 
 
 static void TextureGL_Impl_set_linear(Texture *self) {
     if (!self) return;
+    bool was_begin = self->_is_begin_;  // Привязываем один раз на оба параметра.
+    if (!was_begin) self->begin(self);
     self->set_filter(self, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     self->set_filter(self, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (!was_begin) self->end(self);
 }
 
 
 static void TextureGL_Impl_set_pixelized(Texture *self) {
     if (!self) return;
+    bool was_begin = self->_is_begin_;  // Привязываем один раз на оба параметра.
+    if (!was_begin) self->begin(self);
     self->set_filter(self, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     self->set_filter(self, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    if (!was_begin) self->end(self);
 }
 
 
 static void TextureGL_Impl__destroy_(Texture *self) {
     if (!self) return;
-    glBindTexture(GL_TEXTURE_2D, 0);
-    BufferGC_GL_push(BGC_GL_TBO, self->id);  // Добавляем буфер в стек на уничтожение.
+    if (self->_is_begin_) self->end(self);
+    // Добавляем текстуру в стек на уничтожение или в пул (привязки OpenGL снимет сам):
+    BufferGC_GL_recycle(BGC_GL_TBO, self->id, self->_pool_key_);
     self->_is_begin_ = false;
     self->id = 0;
 }
@@ -0,0 +1,64 @@
+//
+// texture_units_gl.c - Распределение текстурных юнитов OpenGL (LRU).
+//
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "../../gl.h"
+#include "state_gl.h"
+#include "texture_units_gl.h"
+
+
+// Создаём единую глобальную структуру:
+TextureUnitsGL texture_units_gl = {0};
+
+
+// Инициализация после создания контекста (после StateGL_init):
+void TextureUnitsGL_init() {
+    int32_t max_units = 0;
+    glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &max_units);
+    if (max_units > STATE_GL_MAX_TEXTURE_UNITS) max_units = STATE_GL_MAX_TEXTURE_UNITS;
+    if (max_units <= TEXTURE_UNITS_GL_RESERVED) max_units = TEXTURE_UNITS_GL_RESERVED + 1;
+
+    memset(&texture_units_gl, 0, sizeof(texture_units_gl));
+    texture_units_gl.count = (uint32_t)max_units;
+}
+
+
+// Сколько текстур можно держать на юнитах одновременно:
+uint32_t TextureUnitsGL_capacity() {
+    if (texture_units_gl.count <= TEXTURE_UNITS_GL_RESERVED) return 0;
+    return texture_units_gl.count - TEXTURE_UNITS_GL_RESERVED;
+}
+
+
+// Привязать текстуру к юниту (или найти юнит, где она уже лежит). Возвращает номер юнита:
+uint32_t TextureUnitsGL_bind(uint32_t texture) {
+    TextureUnitsGL *units = &texture_units_gl;
+    if (units->count <= TEXTURE_UNITS_GL_RESERVED) TextureUnitsGL_init();
+    units->clock++;
+
+    // Что лежит на юнитах, знает теневая копия состояния. Поэтому если юнит перепривязали
+    // в обход распределителя (или текстуру удалили), мы просто не найдём на нём свою текстуру:
+    uint32_t victim = TEXTURE_UNITS_GL_RESERVED;
+    for (uint32_t unit = TEXTURE_UNITS_GL_RESERVED; unit < units->count; unit++) {
+        if (state_gl.textures[unit] == texture) {
+            units->last_use[unit] = units->clock;
+            units->hits++;
+            return unit;
+        }
+        if (units->last_use[unit] < units->last_use[victim]) victim = unit;
+    }
+
+    // Занимаем самый давно использованный юнит (свободные юниты никогда не использовались и идут первыми):
+    uint32_t previous = state_gl.textures[victim];
+    if (previous != 0 && previous != STATE_GL_UNKNOWN) units->evictions++;
+    StateGL_bind_texture(victim, texture);
+    units->last_use[victim] = units->clock;
+    units->misses++;
+    return victim;
+}
@@ -0,0 +1,53 @@
+//
+// texture_units_gl.h - Распределение текстурных юнитов OpenGL (LRU).
+//
+// Юнит 0 зарезервирован под Texture.begin/end (загрузка и настройка текстур).
+// Остальные юниты раздаются текстурам для отрисовки: текстура остаётся привязанной к своему юниту,
+// пока её не вытеснит другая, поэтому повторная привязка недавно использованной текстуры ничего не стоит.
+// Вытесняется юнит, который дольше всех не использовался. Значит, если привязать подряд не больше
+// TextureUnitsGL_capacity() разных текстур, ни одна из них не вытеснит другую (так работают пакетные отрисовки).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "state_gl.h"
+
+
+// Определения:
+#define TEXTURE_UNITS_GL_RESERVED 1  // Сколько юнитов с начала не раздаётся (юнит 0 - для begin/end).
+
+
+// Объявление структур:
+typedef struct TextureUnitsGL TextureUnitsGL;
+
+
+// Распределитель текстурных юнитов:
+typedef struct TextureUnitsGL {
+    uint32_t count;  // Сколько юнитов используется (не больше STATE_GL_MAX_TEXTURE_UNITS).
+    uint64_t clock;  // Счётчик обращений (отметка времени для LRU).
+    uint64_t last_use[STATE_GL_MAX_TEXTURE_UNITS];  // Когда юнит использовался последний раз.
+
+    // Статистика:
+    size_t hits;       // Текстура уже была на юните.
+    size_t misses;     // Текстуру пришлось привязать.
+    size_t evictions;  // При привязке была вытеснена другая текстура.
+} TextureUnitsGL;
+
+
+// Создаём единую глобальную структуру:
+extern TextureUnitsGL texture_units_gl;
+
+
+// Инициализация после создания контекста (после StateGL_init):
+void TextureUnitsGL_init();
+
+// Сколько текстур можно держать на юнитах одновременно:
+uint32_t TextureUnitsGL_capacity();
+
+// Привязать текстуру к юниту (или найти юнит, где она уже лежит). Возвращает номер юнита:
+uint32_t TextureUnitsGL_bind(uint32_t texture);
@@ -7,12 +7,17 @@
 #include <stdio.h>
 #include <string.h>
 #include "../mm/mm.h"
-#include "../darray.h"
+#include "../varray.h"
+#include "../hashmap.h"
 #include "renderer.h"
 #include "realization.h"
 #include "shader.h"
 
 
+// Папка для кэша скомпилированных программ (пустая строка - кэш выключен):
+static char shader_binary_cache_dir[SHADER_BINARY_CACHE_DIR_MAX] = {0};
+
+
 // Объявление функций:
 static char* ShaderProgram_Impl_get_error(ShaderProgram *self);
 
@@ -21,7 +26,7 @@ static char* ShaderProgram_Impl_get_error(ShaderProgram *self);
 ShaderProgram* ShaderProgram_create(Renderer *renderer, const char *vert, const char *frag, const char *geom) {
     if (!renderer) return NULL;
 
-    ShaderProgram *shader = mm_calloc(1, sizeof(ShaderProgram));
+    ShaderProgram *shader = mm_calloc_tagged(1, sizeof(ShaderProgram), MM_TAG_SHADER);
     if (!shader) mm_alloc_error();
 
     // Заполняем поля:
@@ -33,9 +38,9 @@ ShaderProgram* ShaderProgram_create(Renderer *renderer, const char *vert, const
     shader->id = 0;
     shader->_id_before_begin_ = 0;
     shader->get_error = ShaderProgram_Impl_get_error;
-    shader->uniform_locations = DArray_create(92);
-    shader->uniform_values = DArray_create(92);
-    // shader->sampler_units = DArray_create(92);
+    shader->uniforms = VArray_create(sizeof(ShaderUniformInfo), 16);
+    shader->uniform_names = HashMap_create(HASHMAP_KEY_STRING, sizeof(ShaderUniform), 32);
+    shader->uniform_shadow = VArray_create(1, 256);
 
     // Регистрируем функции для определенного рендерера:
     switch (renderer->type) {
@@ -48,7 +53,7 @@ ShaderProgram* ShaderProgram_create(Renderer *renderer, const char *vert, const
         default: {
             const char* err = "Unknown renderer type.";
             fprintf(stderr, "ShaderProgram_create: %s\n", err);
-            shader->error = mm_alloc(strlen(err) + 1);
+            shader->error = mm_alloc_tagged(strlen(err) + 1, MM_TAG_SHADER);
             if (!shader->error) mm_alloc_error();
             memcpy(shader->error, err, strlen(err) + 1);
             return shader;
@@ -63,27 +68,9 @@ void ShaderProgram_destroy(ShaderProgram **shader) {
     if (!shader || !*shader) return;
 
     // Освобождаем кэш:
-    if ((*shader)->uniform_locations) {
-        for (size_t i = 0; i < DArray_len((*shader)->uniform_locations); i++) {
-            ShaderCacheUniformLocation *u = DArray_get((*shader)->uniform_locations, i);
-            if (u) {
-                mm_free(u->name);
-                mm_free(u);
-            }
-        }
-        DArray_destroy(&(*shader)->uniform_locations);
-    }
-    if ((*shader)->uniform_values) {
-        for (size_t i = 0; i < DArray_len((*shader)->uniform_values); i++) {
-            ShaderCacheUniformValue *u = DArray_get((*shader)->uniform_values, i);
-            if (u) mm_free(u);
-        }
-        DArray_destroy(&(*shader)->uniform_values);
-    }
-    // if ((*shader)->sampler_units) {
-    //     // ...
-    //     DArray_destroy(&(*shader)->sampler_units);
-    // }
+    VArray_destroy(&(*shader)->uniforms);
+    HashMap_destroy(&(*shader)->uniform_names);
+    VArray_destroy(&(*shader)->uniform_shadow);
 
     // Удаляем сам шейдер:
     (*shader)->_destroy_(*shader);
@@ -95,6 +82,27 @@ void ShaderProgram_destroy(ShaderProgram **shader) {
 }
 
 
+// Установить папку для кэша скомпилированных программ (NULL - кэш выключен):
+void ShaderProgram_set_binary_cache_dir(const char *dir) {
+    if (!dir) {
+        shader_binary_cache_dir[0] = '\0';
+        return;
+    }
+    size_t len = strlen(dir);
+    if (len >= SHADER_BINARY_CACHE_DIR_MAX) {
+        fprintf(stderr, "ShaderProgram_set_binary_cache_dir: Path is too long (max %d).\n", SHADER_BINARY_CACHE_DIR_MAX - 1);
+        return;
+    }
+    memcpy(shader_binary_cache_dir, dir, len + 1);
+}
+
+
+// Получить папку для кэша скомпилированных программ (NULL если кэш выключен):
+const char* ShaderProgram_get_binary_cache_dir(void) {
+    return shader_binary_cache_dir[0] ? shader_binary_cache_dir : NULL;
+}
+
+
 // Реализация API:
 
 
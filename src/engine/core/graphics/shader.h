@@ -11,55 +11,41 @@
 #include "../math.h"
 
 
-// Виды значений юниформов для кэша:
-typedef enum ShaderCacheUniformType {
-    SHADERCACHE_UNIFORM_BOOL,
-    SHADERCACHE_UNIFORM_INT,
-    SHADERCACHE_UNIFORM_FLOAT,
-    SHADERCACHE_UNIFORM_VEC2,
-    SHADERCACHE_UNIFORM_VEC3,
-    SHADERCACHE_UNIFORM_VEC4,
-    // Что-то ещё? ...
-} ShaderCacheUniformType;
+// Определения:
+#define SHADER_UNIFORM_INVALID -1          // Дескриптор юниформа, которого нет в шейдере.
+#define SHADER_BINARY_CACHE_DIR_MAX 512    // Максимальная длина пути к папке кэша программ.
 
 
 // Объявление структур:
 typedef struct ShaderProgram ShaderProgram;
+typedef struct ShaderUniformInfo ShaderUniformInfo;
 typedef struct Renderer Renderer;
-typedef struct DArray DArray;
-typedef struct ShaderCacheUniformLocation ShaderCacheUniformLocation;
-typedef struct ShaderCacheUniformValue ShaderCacheUniformValue;
+typedef struct Texture Texture;
+typedef struct VArray VArray;
+typedef struct HashMap HashMap;
 
-
-// Единица кэша локаций юниформов:
-typedef struct ShaderCacheUniformLocation {
-    char *name;        // Имя юниформа.
-    int32_t location;  // Позиция в шейдере.
-} ShaderCacheUniformLocation;
+// Дескриптор юниформа - индекс в таблице рефлексии шейдера. Получается один раз через get_uniform,
+// после чего установка значения по нему стоит одно обращение к массиву и сравнение с кэшем:
+typedef int32_t ShaderUniform;
 
 
-// Единица кэша значений юниформов:
-typedef struct ShaderCacheUniformValue {
-    ShaderCacheUniformType type;  // Тип значения.
+// Запись таблицы рефлексии юниформов (заполняется после линковки программы):
+typedef struct ShaderUniformInfo {
     int32_t location;  // Позиция в шейдере.
-    union {  // Данные:
+    uint32_t type;     // Тип юниформа в API рендерера (0 - неизвестен).
+    int32_t count;     // Размер массива (1 - не массив).
+    bool has_value;    // В кэше лежит последнее установленное значение.
+    uint32_t shadow_offset;  // Смещение теневой копии массива в uniform_shadow.
+    uint32_t shadow_size;    // Размер теневой копии массива в байтах (0 - ещё не выделена).
+    uint32_t shadow_valid;   // Сколько байт теневой копии совпадает с тем, что загружено в шейдер.
+    union {  // Кэш последнего значения (для массивов - теневая копия в uniform_shadow):
         bool vbool;
         int32_t vint;
         float vfloat;
-        float vec2[2];
-        float vec3[3];
-        float vec4[4];
-        // Что-то ещё? ...
+        float vec[4];
+        float mat[16];
     };
-} ShaderCacheUniformValue;
-
-
-// Единица кэша сэмплеров:
-// TODO сделать TextureUnits.
-// typedef struct ShaderCacheSampler {
-//     char *name;
-//     uint32_t unit;
-// } ShaderCacheSampler;
+} ShaderUniformInfo;
 
 
 // Структура шейдера:
@@ -73,20 +59,34 @@ typedef struct ShaderProgram {
     bool _is_begin_;
     int32_t _id_before_begin_;
 
-    // Динамические списки для кэша параметров шейдера:
-    DArray *uniform_locations;  // Кэш позиций uniform.
-    DArray *uniform_values;     // Кэш значений uniform (всё кроме массивов и матриц).
-    // DArray *sampler_units;      // Кэш привязки текстурных юнитов к названиям униформов.
+    // Состояние асинхронной компиляции:
+    bool _compiling_;      // Программа отправлена драйверу, статусы ещё не проверены.
+    uint32_t _program_;    // Программа, которая компилируется.
+    uint32_t _stages_[3];  // Отдельные шейдеры этой программы (вершинный, фрагментный, геометрический).
+    bool _use_cache_;      // Сохранить программу в кэш после компиляции.
+    uint64_t _cache_key_;  // Ключ кэша программы.
+
+    // Рефлексия юниформов и кэш их значений:
+    VArray *uniforms;        // Таблица юниформов (ShaderUniformInfo), индекс в ней - это ShaderUniform.
+    HashMap *uniform_names;  // Имя юниформа -> ShaderUniform (отсутствующие тоже кэшируются, как SHADER_UNIFORM_INVALID).
+    VArray *uniform_shadow;  // Теневые копии массивов юниформов (байты).
+
+    // Статистика загрузки юниформов (можно обнулять в любой момент):
+    size_t uniform_uploads;  // Сколько значений отправлено в шейдер.
+    size_t uniform_skipped;  // Сколько загрузок пропущено, потому что значение не изменилось.
 
     // Функции:
 
-    void  (*compile)   (ShaderProgram *self);  // Компиляция шейдеров в программу.
-    char* (*get_error) (ShaderProgram *self);  // Получить ошибку компиляции или линковки.
-    void  (*begin)     (ShaderProgram *self);  // Активация программы.
-    void  (*end)       (ShaderProgram *self);  // Деактивация программы.
-    void  (*_destroy_) (ShaderProgram *self);  // Внутренняя функция для удаления самого шейдера.
+    void  (*compile)       (ShaderProgram *self);  // Компиляция шейдеров в программу.
+    void  (*compile_async) (ShaderProgram *self);  // Отправить шейдеры на компиляцию, не дожидаясь результата.
+    bool  (*is_ready)      (ShaderProgram *self);  // Завершена ли компиляция (успешно или с ошибкой).
+    char* (*get_error)     (ShaderProgram *self);  // Получить ошибку компиляции или линковки.
+    void  (*begin)         (ShaderProgram *self);  // Активация программы.
+    void  (*end)           (ShaderProgram *self);  // Деактивация программы.
+    void  (*_destroy_)     (ShaderProgram *self);  // Внутренняя функция для удаления самого шейдера.
 
-    int32_t (*get_location) (ShaderProgram *self, const char* name);  // Получить локацию переменной.
+    int32_t       (*get_location) (ShaderProgram *self, const char* name);  // Получить локацию переменной.
+    ShaderUniform (*get_uniform)  (ShaderProgram *self, const char* name);  // Получить дескриптор юниформа.
 
     void (*set_uniform_bool)  (ShaderProgram *self, const char* name, bool value);   // Установить значение bool.
     void (*set_uniform_int)   (ShaderProgram *self, const char* name, int value);    // Установить значение int.
@@ -106,9 +106,49 @@ typedef struct ShaderProgram {
     void (*set_uniform_mat3x4) (ShaderProgram *self, const char* name, mat3x4 value);  // Установить значение mat3x4.
     void (*set_uniform_mat4x3) (ShaderProgram *self, const char* name, mat4x3 value);  // Установить значение mat4x3.
 
-    // TODO: сделать код для работы с текстурными юнитами чтобы можно было сделать функции ниже:
-    // void (*set_sampler2d) (ShaderProgram *self, const char* name, uint32_t texture_id);
-    // void (*set_sampler3d) (ShaderProgram *self, const char* name, uint32_t texture_id);
+    // Установка значений по дескриптору юниформа (без поиска по имени):
+    void (*set_uniform_bool_h)  (ShaderProgram *self, ShaderUniform uniform, bool  value);  // Установить значение bool.
+    void (*set_uniform_int_h)   (ShaderProgram *self, ShaderUniform uniform, int   value);  // Установить значение int.
+    void (*set_uniform_float_h) (ShaderProgram *self, ShaderUniform uniform, float value);  // Установить значение float.
+
+    void (*set_uniform_vec2_h) (ShaderProgram *self, ShaderUniform uniform, Vec2f value);  // Установить значение vec2.
+    void (*set_uniform_vec3_h) (ShaderProgram *self, ShaderUniform uniform, Vec3f value);  // Установить значение vec3.
+    void (*set_uniform_vec4_h) (ShaderProgram *self, ShaderUniform uniform, Vec4f value);  // Установить значение vec4.
+
+    void (*set_uniform_mat2_h)   (ShaderProgram *self, ShaderUniform uniform, mat2   value);  // Установить значение mat2.
+    void (*set_uniform_mat3_h)   (ShaderProgram *self, ShaderUniform uniform, mat3   value);  // Установить значение mat3.
+    void (*set_uniform_mat4_h)   (ShaderProgram *self, ShaderUniform uniform, mat4   value);  // Установить значение mat4.
+    void (*set_uniform_mat2x3_h) (ShaderProgram *self, ShaderUniform uniform, mat2x3 value);  // Установить значение mat2x3.
+    void (*set_uniform_mat3x2_h) (ShaderProgram *self, ShaderUniform uniform, mat3x2 value);  // Установить значение mat3x2.
+    void (*set_uniform_mat2x4_h) (ShaderProgram *self, ShaderUniform uniform, mat2x4 value);  // Установить значение mat2x4.
+    void (*set_uniform_mat4x2_h) (ShaderProgram *self, ShaderUniform uniform, mat4x2 value);  // Установить значение mat4x2.
+    void (*set_uniform_mat3x4_h) (ShaderProgram *self, ShaderUniform uniform, mat3x4 value);  // Установить значение mat3x4.
+    void (*set_uniform_mat4x3_h) (ShaderProgram *self, ShaderUniform uniform, mat4x3 value);  // Установить значение mat4x3.
+
+    // Установка массивов (count элементов с начала массива):
+    void (*set_uniform_int_array)   (ShaderProgram *self, const char* name, const int   *values, int count);  // Установить массив int.
+    void (*set_uniform_float_array) (ShaderProgram *self, const char* name, const float *values, int count);  // Установить массив float.
+    void (*set_uniform_vec2_array)  (ShaderProgram *self, const char* name, const Vec2f *values, int count);  // Установить массив vec2.
+    void (*set_uniform_vec3_array)  (ShaderProgram *self, const char* name, const Vec3f *values, int count);  // Установить массив vec3.
+    void (*set_uniform_vec4_array)  (ShaderProgram *self, const char* name, const Vec4f *values, int count);  // Установить массив vec4.
+    void (*set_uniform_mat4_array)  (ShaderProgram *self, const char* name, const mat4  *values, int count);  // Установить массив mat4.
+
+    void (*set_uniform_int_array_h)   (ShaderProgram *self, ShaderUniform uniform, const int   *values, int count);  // Установить массив int.
+    void (*set_uniform_float_array_h) (ShaderProgram *self, ShaderUniform uniform, const float *values, int count);  // Установить массив float.
+    void (*set_uniform_vec2_array_h)  (ShaderProgram *self, ShaderUniform uniform, const Vec2f *values, int count);  // Установить массив vec2.
+    void (*set_uniform_vec3_array_h)  (ShaderProgram *self, ShaderUniform uniform, const Vec3f *values, int count);  // Установить массив vec3.
+    void (*set_uniform_vec4_array_h)  (ShaderProgram *self, ShaderUniform uniform, const Vec4f *values, int count);  // Установить массив vec4.
+    void (*set_uniform_mat4_array_h)  (ShaderProgram *self, ShaderUniform uniform, const mat4  *values, int count);  // Установить массив mat4.
+
+    // Привязка текстур к сэмплерам. Текстура получает текстурный юнит рендерера (и остаётся на нём, пока
+    // её не вытеснят), а номер юнита кэшируется в юниформе как обычный int, поэтому повторная
+    // привязка той же текстуры к тому же сэмплеру ничего не стоит:
+    void (*set_sampler2d)   (ShaderProgram *self, const char* name, Texture *texture);              // Привязать текстуру к sampler2D.
+    void (*set_sampler2d_h) (ShaderProgram *self, ShaderUniform uniform, Texture *texture);  // Привязать текстуру к sampler2D.
+
+    // Привязать count текстур к массиву sampler2D (count не больше количества свободных юнитов рендерера):
+    void (*set_sampler2d_array)   (ShaderProgram *self, const char* name, Texture *const *textures, int count);
+    void (*set_sampler2d_array_h) (ShaderProgram *self, ShaderUniform uniform, Texture *const *textures, int count);
 } ShaderProgram;
 
 
@@ -117,3 +157,10 @@ ShaderProgram* ShaderProgram_create(Renderer *renderer, const char *vert, const
 
 // Уничтожить шейдерную программу:
 void ShaderProgram_destroy(ShaderProgram **shader);
+
+// Установить папку для кэша скомпилированных программ (NULL - кэш выключен).
+// Кэш привязан к исходникам шейдеров, видеокарте, драйверу и ОС, и пересобирается сам при их изменении:
+void ShaderProgram_set_binary_cache_dir(const char *dir);
+
+// Получить папку для кэша скомпилированных программ (NULL если кэш выключен):
+const char* ShaderProgram_get_binary_cache_dir(void);
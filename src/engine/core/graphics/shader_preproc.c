@@ -0,0 +1,342 @@
+//
+// shader_preproc.c - Препроцессор исходников шейдеров и кэш вариантов (перестановок) шейдеров.
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "../mm/mm.h"
+#include "../hashmap.h"
+#include "../files.h"
+#include "shader.h"
+#include "shader_preproc.h"
+
+
+// Собранный вариант шейдера:
+typedef struct ShaderVariant {
+    ShaderProgram *program;  // Программа варианта.
+    char *sources[3];        // Исходники после препроцессора (программа хранит только указатели на них).
+} ShaderVariant;
+
+
+// Растущая строка для результата препроцессора:
+typedef struct PreprocBuffer {
+    char *data;
+    size_t len;
+    size_t cap;
+} PreprocBuffer;
+
+
+// Виртуальные подключаемые файлы (имя -> char*):
+static HashMap *preproc_includes = NULL;
+
+
+// Дописать n байт в строку:
+static void buffer_append(PreprocBuffer *buf, const char *str, size_t n) {
+    if (n == 0) return;
+    if (buf->len + n + 1 > buf->cap) {
+        size_t new_cap = buf->cap ? buf->cap * 2 : 1024;
+        while (new_cap < buf->len + n + 1) new_cap *= 2;
+        buf->data = mm_realloc(buf->data, new_cap);
+        if (!buf->data) mm_alloc_error();
+        buf->cap = new_cap;
+    }
+    memcpy(buf->data + buf->len, str, n);
+    buf->len += n;
+    buf->data[buf->len] = '\0';
+}
+
+
+// Дописать строку:
+static inline void buffer_append_str(PreprocBuffer *buf, const char *str) {
+    buffer_append(buf, str, strlen(str));
+}
+
+
+// Пропустить пробелы и табы:
+static inline const char* skip_spaces(const char *str, const char *end) {
+    while (str < end && (*str == ' ' || *str == '\t')) str++;
+    return str;
+}
+
+
+// Строка является директивой name (после пробелов и '#')? Возвращает указатель после имени директивы или NULL:
+static const char* match_directive(const char *line, const char *end, const char *name) {
+    const char *p = skip_spaces(line, end);
+    if (p >= end || *p != '#') return NULL;
+    p = skip_spaces(p + 1, end);
+    size_t len = strlen(name);
+    if ((size_t)(end - p) < len || strncmp(p, name, len) != 0) return NULL;
+    return p + len;
+}
+
+
+// Дописать директиву #line (следующая строка результата получит номер line):
+static void buffer_append_line(PreprocBuffer *buf, int line) {
+    char line_directive[32];
+    int len = snprintf(line_directive, sizeof(line_directive), "#line %d\n", line);
+    if (len > 0) buffer_append(buf, line_directive, (size_t)len);
+}
+
+
+// Подключить файл name (если он ещё не подключён):
+static bool preprocess_include(PreprocBuffer *out, const char *name, HashMap *included, int depth);
+
+
+// Обработать исходник (рекурсивно для подключаемых файлов). first_line - номер первой строки source:
+static bool preprocess(PreprocBuffer *out, const char *source, int first_line, HashMap *included, int depth) {
+    if (depth > SHADER_PREPROC_MAX_DEPTH) {
+        fprintf(stderr, "ShaderPreproc_process: #include nesting is too deep (max %d).\n", SHADER_PREPROC_MAX_DEPTH);
+        return false;
+    }
+
+    const char *line = source;
+    for (int line_number = first_line; *line; line_number++) {
+        const char *end = strchr(line, '\n');
+        const char *next = end ? end + 1 : line + strlen(line);
+        if (!end) end = next;
+
+        const char *args = match_directive(line, end, "include");
+        if (!args) {
+            buffer_append(out, line, (size_t)(next - line));
+            if (next == end) buffer_append(out, "\n", 1);  // Последняя строка без переноса.
+            line = next;
+            continue;
+        }
+
+        // Достаём имя файла из "имя" или <имя>:
+        args = skip_spaces(args, end);
+        char close = (args < end && *args == '<') ? '>' : '"';
+        const char *name_end = (args < end) ? memchr(args + 1, close, (size_t)(end - args - 1)) : NULL;
+        if (args >= end || (*args != '"' && *args != '<') || !name_end || name_end - args - 1 >= 256) {
+            fprintf(stderr, "ShaderPreproc_process: Bad #include directive: \"%.*s\".\n", (int)(end - line), line);
+            return false;
+        }
+        char name[256];
+        memcpy(name, args + 1, (size_t)(name_end - args - 1));
+        name[name_end - args - 1] = '\0';
+        line = next;
+
+        // Раскрываем файл и возвращаем нумерацию строк подключающего исходника:
+        if (!preprocess_include(out, name, included, depth)) return false;
+        buffer_append_line(out, line_number + 1);
+    }
+    return true;
+}
+
+
+// Подключить файл name (если он ещё не подключён):
+static bool preprocess_include(PreprocBuffer *out, const char *name, HashMap *included, int depth) {
+    // Каждый файл подключается только один раз:
+    if (HashMap_get_str(included, name)) return true;
+    HashMap_put_str(included, name, NULL);
+
+    // Сначала ищем среди виртуальных файлов, потом на диске:
+    char **virtual_source = preproc_includes ? HashMap_get_str(preproc_includes, name) : NULL;
+    if (virtual_source) {
+        buffer_append_line(out, 1);
+        return preprocess(out, *virtual_source, 1, included, depth + 1);
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", SHADER_PREPROC_INCLUDE_DIR, name);
+    char *file_source = fs_load_file(path, "r");
+    if (!file_source) {
+        fprintf(stderr, "ShaderPreproc_process: Include \"%s\" not found.\n", name);
+        return false;
+    }
+    buffer_append_line(out, 1);
+    bool ok = preprocess(out, file_source, 1, included, depth + 1);
+    mm_free(file_source);
+    return ok;
+}
+
+
+// Зарегистрировать виртуальный подключаемый файл (исходник копируется, повторная регистрация заменяет его):
+void ShaderPreproc_register_include(const char *name, const char *source) {
+    if (!name || !source) return;
+    if (!preproc_includes) preproc_includes = HashMap_create(HASHMAP_KEY_STRING, sizeof(char*), 16);
+
+    size_t len = strlen(source);
+    char *copy = mm_alloc_tagged(len + 1, MM_TAG_SHADER);
+    if (!copy) mm_alloc_error();
+    memcpy(copy, source, len + 1);
+
+    char **existing = HashMap_get_str(preproc_includes, name);
+    if (existing) {
+        mm_free(*existing);
+        *existing = copy;
+    } else {
+        HashMap_put_str(preproc_includes, name, &copy);
+    }
+}
+
+
+// Удалить все виртуальные подключаемые файлы:
+void ShaderPreproc_destroy(void) {
+    if (!preproc_includes) return;
+    size_t iter = 0;
+    char **source;
+    while ((source = HashMap_next(preproc_includes, &iter, NULL, NULL))) mm_free(*source);
+    HashMap_destroy(&preproc_includes);
+}
+
+
+// Обработать исходник: раскрыть #include и вставить #define. Результат освобождается через mm_free (NULL при ошибке):
+char* ShaderPreproc_process(const char *source, const char *const *defines, size_t define_count) {
+    if (!source) return NULL;
+    PreprocBuffer out = {0};
+
+    // Всё до строки #version включительно копируем как есть (#version должен идти первым):
+    const char *body = source;
+    int version_line = 0;
+    for (const char *line = source; *line;) {
+        const char *end = strchr(line, '\n');
+        const char *next = end ? end + 1 : line + strlen(line);
+        version_line++;
+        if (match_directive(line, end ? end : next, "version")) {
+            buffer_append(&out, source, (size_t)(next - source));
+            if (!end) buffer_append(&out, "\n", 1);
+            body = next;
+            break;
+        }
+        line = next;
+    }
+    if (body == source) version_line = 0;  // #version нет, вставляем определения в самое начало.
+
+    // Вставляем определения и возвращаем нумерацию строк, чтобы ошибки указывали на строки исходника:
+    for (size_t i = 0; i < define_count; i++) {
+        if (!defines[i]) continue;
+        buffer_append_str(&out, "#define ");
+        buffer_append_str(&out, defines[i]);
+        buffer_append(&out, "\n", 1);
+    }
+    buffer_append_line(&out, version_line + 1);
+
+    // Раскрываем подключаемые файлы:
+    HashMap *included = HashMap_create(HASHMAP_KEY_STRING, 1, 16);
+    bool ok = preprocess(&out, body, version_line + 1, included, 0);
+    HashMap_destroy(&included);
+    if (!ok) {
+        mm_free(out.data);
+        return NULL;
+    }
+    return out.data;
+}
+
+
+// Скопировать строку (NULL -> NULL):
+static char* copy_string(const char *str) {
+    if (!str) return NULL;
+    size_t len = strlen(str);
+    char *copy = mm_alloc_tagged(len + 1, MM_TAG_SHADER);
+    if (!copy) mm_alloc_error();
+    memcpy(copy, str, len + 1);
+    return copy;
+}
+
+
+// Создать набор вариантов шейдера (исходники и имена флагов копируются):
+ShaderVariants* ShaderVariants_create(
+    Renderer *renderer, const char *vert, const char *frag, const char *geom,
+    const char *const *flags, uint32_t flag_count
+) {
+    if (!renderer) return NULL;
+    if (flag_count > SHADER_VARIANTS_MAX_FLAGS) {
+        fprintf(stderr, "ShaderVariants_create: Too many flags (max %d).\n", SHADER_VARIANTS_MAX_FLAGS);
+        return NULL;
+    }
+
+    ShaderVariants *variants = mm_calloc_tagged(1, sizeof(ShaderVariants), MM_TAG_SHADER);
+    if (!variants) mm_alloc_error();
+
+    variants->renderer = renderer;
+    variants->vertex = copy_string(vert);
+    variants->fragment = copy_string(frag);
+    variants->geometry = copy_string(geom);
+    for (uint32_t i = 0; i < flag_count; i++) variants->flags[i] = copy_string(flags[i]);
+    variants->flag_count = flag_count;
+    variants->programs = HashMap_create(HASHMAP_KEY_INT, sizeof(ShaderVariant), 8);
+    return variants;
+}
+
+
+// Уничтожить набор вариантов вместе со всеми программами:
+void ShaderVariants_destroy(ShaderVariants **variants) {
+    if (!variants || !*variants) return;
+    ShaderVariants *v = *variants;
+
+    size_t iter = 0;
+    ShaderVariant *variant;
+    while ((variant = HashMap_next(v->programs, &iter, NULL, NULL))) {
+        ShaderProgram_destroy(&variant->program);
+        for (int i = 0; i < 3; i++) mm_free(variant->sources[i]);
+    }
+    HashMap_destroy(&v->programs);
+
+    for (uint32_t i = 0; i < v->flag_count; i++) mm_free(v->flags[i]);
+    mm_free(v->vertex);
+    mm_free(v->fragment);
+    mm_free(v->geometry);
+    mm_free(v);
+    *variants = NULL;
+}
+
+
+// Найти или собрать (без компиляции) вариант по маске флагов:
+static ShaderProgram* variant_program(ShaderVariants *variants, uint32_t mask) {
+    if (variants->flag_count < 32) mask &= (1u << variants->flag_count) - 1;  // Неизвестные флаги отбрасываем.
+
+    ShaderVariant *cached = HashMap_get_int(variants->programs, mask);
+    if (cached) return cached->program;
+
+    // Определения из установленных флагов:
+    const char *defines[SHADER_VARIANTS_MAX_FLAGS];
+    size_t define_count = 0;
+    for (uint32_t i = 0; i < variants->flag_count; i++) {
+        if (mask & (1u << i)) defines[define_count++] = variants->flags[i];
+    }
+
+    // Прогоняем исходники через препроцессор:
+    ShaderVariant variant = {0};
+    const char *sources[3] = {variants->vertex, variants->fragment, variants->geometry};
+    for (int i = 0; i < 3; i++) {
+        if (!sources[i]) continue;
+        variant.sources[i] = ShaderPreproc_process(sources[i], defines, define_count);
+        if (!variant.sources[i]) {
+            fprintf(stderr, "ShaderVariants_get: Preprocessing variant 0x%x failed.\n", mask);
+            for (int j = 0; j < 3; j++) mm_free(variant.sources[j]);
+            return NULL;
+        }
+    }
+
+    variant.program = ShaderProgram_create(variants->renderer, variant.sources[0], variant.sources[1], variant.sources[2]);
+    HashMap_put_int(variants->programs, mask, &variant);
+    return variant.program;
+}
+
+
+// Программа ещё не отправлена на компиляцию:
+static inline bool program_not_compiled(ShaderProgram *program) {
+    return !program->id && !program->_compiling_ && !program->error;
+}
+
+
+// Получить вариант по маске флагов (при первом обращении собирается и компилируется):
+ShaderProgram* ShaderVariants_get(ShaderVariants *variants, uint32_t mask) {
+    if (!variants) return NULL;
+    ShaderProgram *program = variant_program(variants, mask);
+    if (program && program_not_compiled(program)) program->compile(program);
+    return program;
+}
+
+
+// Отправить вариант на асинхронную компиляцию заранее, не дожидаясь её:
+void ShaderVariants_precompile(ShaderVariants *variants, uint32_t mask) {
+    if (!variants) return;
+    ShaderProgram *program = variant_program(variants, mask);
+    if (program && program_not_compiled(program)) program->compile_async(program);
+}
@@ -0,0 +1,69 @@
+//
+// shader_preproc.h - Препроцессор исходников шейдеров и кэш вариантов (перестановок) шейдеров.
+//
+// Препроцессор раскрывает #include "имя" (сначала из зарегистрированных виртуальных файлов,
+// потом из папки data/shaders) и вставляет #define сразу после строки #version.
+// Каждый файл подключается только один раз (как с #pragma once).
+//
+// Варианты шейдеров: один исходник с #ifdef ветками собирается в отдельные программы под
+// каждый набор флагов. Вариант выбирается при отрисовке по маске флагов, поэтому в самом
+// шейдере не остаётся ветвлений по юниформам.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// Определения:
+#define SHADER_PREPROC_INCLUDE_DIR "data/shaders"  // Папка, где ищутся подключаемые файлы.
+#define SHADER_PREPROC_MAX_DEPTH   16              // Максимальная вложенность #include.
+#define SHADER_VARIANTS_MAX_FLAGS  32              // Максимальное количество флагов вариантов.
+
+
+// Объявление структур:
+typedef struct ShaderProgram ShaderProgram;
+typedef struct Renderer Renderer;
+typedef struct HashMap HashMap;
+typedef struct ShaderVariants ShaderVariants;
+
+
+// Набор вариантов одного шейдера:
+typedef struct ShaderVariants {
+    Renderer *renderer;  // Рендерер, для которого создаются программы.
+    char *vertex;        // Исходник вершинного шейдера (копия, до препроцессора).
+    char *fragment;      // Исходник фрагментного шейдера (копия, до препроцессора).
+    char *geometry;      // Исходник геометрического шейдера (копия, до препроцессора, может быть NULL).
+    char *flags[SHADER_VARIANTS_MAX_FLAGS];  // Имена флагов (бит i маски -> #define flags[i]).
+    uint32_t flag_count;                     // Количество флагов.
+    HashMap *programs;   // Маска флагов -> собранный вариант.
+} ShaderVariants;
+
+
+// Зарегистрировать виртуальный подключаемый файл (исходник копируется, повторная регистрация заменяет его):
+void ShaderPreproc_register_include(const char *name, const char *source);
+
+// Удалить все виртуальные подключаемые файлы:
+void ShaderPreproc_destroy(void);
+
+// Обработать исходник: раскрыть #include и вставить #define. Результат освобождается через mm_free (NULL при ошибке):
+char* ShaderPreproc_process(const char *source, const char *const *defines, size_t define_count);
+
+// Создать набор вариантов шейдера (исходники и имена флагов копируются):
+ShaderVariants* ShaderVariants_create(
+    Renderer *renderer, const char *vert, const char *frag, const char *geom,
+    const char *const *flags, uint32_t flag_count
+);
+
+// Уничтожить набор вариантов вместе со всеми программами:
+void ShaderVariants_destroy(ShaderVariants **variants);
+
+// Получить вариант по маске флагов (при первом обращении собирается и компилируется):
+ShaderProgram* ShaderVariants_get(ShaderVariants *variants, uint32_t mask);
+
+// Отправить вариант на асинхронную компиляцию заранее, не дожидаясь её:
+void ShaderVariants_precompile(ShaderVariants *variants, uint32_t mask);
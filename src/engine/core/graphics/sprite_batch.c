@@ -0,0 +1,204 @@
+//
+// sprite_batch.c - Пакетная отрисовка 2D спрайтов (общая часть: накопление и сборка вершин).
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <math.h>
+#include "../mm/mm.h"
+#include "../varray.h"
+#include "../hashmap.h"
+#include "renderer.h"
+#include "realization.h"
+#include "sprite_batch.h"
+
+
+// Объявление функций:
+static void SpriteBatch_Impl_draw(SpriteBatch *self, const SpriteBatchSprite *sprite);
+static void SpriteBatch_Impl_draw_texture(SpriteBatch *self, Texture *texture, float x, float y, float width, float height, Vec4f color);
+
+
+// Создать пакет спрайтов (capacity - сколько спрайтов вмещает без роста, 0 - по умолчанию):
+SpriteBatch* SpriteBatch_create(Renderer *renderer, size_t capacity) {
+    if (!renderer) return NULL;
+    if (capacity == 0) capacity = SPRITE_BATCH_DEFAULT_CAPACITY;
+
+    SpriteBatch *batch = mm_calloc_tagged(1, sizeof(SpriteBatch), MM_TAG_RENDERER);
+    if (!batch) mm_alloc_error();
+
+    // Заполняем поля:
+    batch->renderer = renderer;
+    batch->shader = NULL;
+    batch->sort = SPRITE_BATCH_SORT_TEXTURE;
+    batch->_is_begin_ = false;
+    batch->data = NULL;
+    batch->sprites = VArray_create(sizeof(SpriteBatchSprite), capacity);
+    batch->vertices = VArray_create(sizeof(SpriteBatchVertex), capacity * 4);
+    batch->runs = VArray_create(sizeof(SpriteBatchRun), 16);
+    batch->slots = HashMap_create(HASHMAP_KEY_INT, sizeof(uint32_t), 16);
+
+    // Накопление спрайтов не зависит от рендерера:
+    batch->draw = SpriteBatch_Impl_draw;
+    batch->draw_texture = SpriteBatch_Impl_draw_texture;
+
+    // Регистрируем функции для определенного рендерера:
+    switch (renderer->type) {
+        case RENDERER_OPENGL:
+            SpriteBatchGL_RegisterAPI(batch);
+            break;
+
+        // Other renderers.
+
+        default: {
+            const char* err = "Unknown renderer type.";
+            fprintf(stderr, "SpriteBatch_create: %s\n", err);
+            SpriteBatch_destroy(&batch);
+            return NULL;
+        }
+    }
+    return batch;
+}
+
+
+// Уничтожить пакет спрайтов:
+void SpriteBatch_destroy(SpriteBatch **batch) {
+    if (!batch || !*batch) return;
+
+    // Удаляем объекты рендерера:
+    if ((*batch)->_destroy_) (*batch)->_destroy_(*batch);
+
+    // Освобождаем массивы:
+    VArray_destroy(&(*batch)->sprites);
+    VArray_destroy(&(*batch)->vertices);
+    VArray_destroy(&(*batch)->runs);
+    HashMap_destroy(&(*batch)->slots);
+
+    // Освобождаем структуру:
+    mm_free(*batch);
+    *batch = NULL;
+}
+
+
+// Записать 4 вершины спрайта (против часовой стрелки, начиная с левого нижнего угла):
+static inline void write_quad(SpriteBatchVertex *v, const SpriteBatchSprite *s) {
+    float x0 = -s->origin.x, y0 = -s->origin.y;
+    float x1 = x0 + s->size.x, y1 = y0 + s->size.y;
+    float corners[4][2] = {{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+    float uvs[4][2] = {{s->uv.x, s->uv.y}, {s->uv.z, s->uv.y}, {s->uv.z, s->uv.w}, {s->uv.x, s->uv.w}};
+    uint32_t color = Renderer_pack_color(s->color);
+
+    // Поворот считаем только когда он есть:
+    float cs = 1.0f, sn = 0.0f;
+    if (s->rotation != 0.0f) {
+        cs = cosf(s->rotation);
+        sn = sinf(s->rotation);
+    }
+    for (int i = 0; i < 4; i++) {
+        v[i].x = s->position.x + corners[i][0] * cs - corners[i][1] * sn;
+        v[i].y = s->position.y + corners[i][0] * sn + corners[i][1] * cs;
+        v[i].z = 0.0f;
+        v[i].u = uvs[i][0];
+        v[i].v = uvs[i][1];
+        v[i].color = color;
+    }
+}
+
+
+// Найти группу текстуры или завести новую (last - кэш последней найденной группы):
+static uint32_t texture_slot(SpriteBatch *batch, Texture *texture, Texture **last_texture, uint32_t *last_slot) {
+    if (*last_texture == texture && *last_slot != UINT32_MAX) return *last_slot;
+    uint32_t *slot = HashMap_get_int(batch->slots, (uint64_t)(uintptr_t)texture);
+    uint32_t index;
+    if (slot) {
+        index = *slot;
+    } else {
+        index = (uint32_t)VArray_len(batch->runs);
+        SpriteBatchRun *run = VArray_push(batch->runs, NULL);
+        run->texture = texture;
+        HashMap_put_int(batch->slots, (uint64_t)(uintptr_t)texture, &index);
+    }
+    *last_texture = texture;
+    *last_slot = index;
+    return index;
+}
+
+
+// Собрать накопленные спрайты в вершины и вызовы отрисовки (для реализаций рендереров):
+void SpriteBatch_build(SpriteBatch *batch) {
+    if (!batch) return;
+    size_t count = VArray_len(batch->sprites);
+    VArray_clear(batch->runs);
+    VArray_resize(batch->vertices, count * 4);
+    if (count == 0) return;
+
+    SpriteBatchSprite *sprites = batch->sprites->data;
+    SpriteBatchVertex *vertices = batch->vertices->data;
+
+    // Без сортировки: новая группа на каждой смене текстуры:
+    if (batch->sort == SPRITE_BATCH_SORT_DEFERRED) {
+        SpriteBatchRun *run = NULL;
+        for (size_t i = 0; i < count; i++) {
+            if (!run || run->texture != sprites[i].texture) {
+                run = VArray_push(batch->runs, NULL);
+                run->texture = sprites[i].texture;
+                run->first = (uint32_t)i;
+            }
+            run->count++;
+            write_quad(&vertices[i * 4], &sprites[i]);
+        }
+        return;
+    }
+
+    // Сортировка подсчётом по текстуре (устойчивая, за два прохода без сравнений).
+    // Первый проход: считаем спрайты каждой текстуры:
+    HashMap_clear(batch->slots);
+    Texture *last_texture = NULL;
+    uint32_t last_slot = UINT32_MAX;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t slot = texture_slot(batch, sprites[i].texture, &last_texture, &last_slot);
+        VArray_at(batch->runs, SpriteBatchRun, slot).count++;
+    }
+
+    // Раскладываем группы подряд в порядке первого появления текстуры:
+    size_t run_count = VArray_len(batch->runs);
+    SpriteBatchRun *runs = batch->runs->data;
+    uint32_t first = 0;
+    for (size_t r = 0; r < run_count; r++) {
+        runs[r].first = first;
+        first += runs[r].count;
+        runs[r].count = 0;  // Дальше используется как курсор записи.
+    }
+
+    // Второй проход: пишем вершины каждого спрайта сразу на своё место:
+    last_texture = NULL;
+    last_slot = UINT32_MAX;
+    for (size_t i = 0; i < count; i++) {
+        SpriteBatchRun *run = &runs[texture_slot(batch, sprites[i].texture, &last_texture, &last_slot)];
+        write_quad(&vertices[(size_t)(run->first + run->count) * 4], &sprites[i]);
+        run->count++;
+    }
+}
+
+
+// Реализация API:
+
+
+static void SpriteBatch_Impl_draw(SpriteBatch *self, const SpriteBatchSprite *sprite) {
+    if (!self || !sprite) return;
+    VArray_push(self->sprites, sprite);
+}
+
+
+static void SpriteBatch_Impl_draw_texture(SpriteBatch *self, Texture *texture, float x, float y, float width, float height, Vec4f color) {
+    if (!self) return;
+    SpriteBatchSprite *sprite = VArray_push(self->sprites, NULL);
+    sprite->texture = texture;
+    sprite->position = (Vec2f){x, y};
+    sprite->size = (Vec2f){width, height};
+    sprite->uv = (Vec4f){0.0f, 0.0f, 1.0f, 1.0f};
+    sprite->color = color;
+}
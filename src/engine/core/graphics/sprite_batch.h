@@ -0,0 +1,112 @@
+//
+// sprite_batch.h - Пакетная отрисовка 2D спрайтов.
+//
+// Спрайты копятся между begin и end, а при flush (или end) сортируются по текстуре, превращаются
+// в вершины и отправляются в видеокарту одной загрузкой. Дальше на каждую текстуру идёт один вызов
+// отрисовки (или несколько, если спрайтов больше SPRITE_BATCH_MAX_QUADS_PER_DRAW).
+// Рисуется дефолтным шейдером (вариант RENDERER_SHADER_TEXTURE | RENDERER_SHADER_VERTEX_COLOR).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "../math.h"
+
+
+// Определения:
+#define SPRITE_BATCH_DEFAULT_CAPACITY    1024   // Сколько спрайтов вмещает пакет без роста.
+#define SPRITE_BATCH_MAX_QUADS_PER_DRAW  16384  // Спрайтов на один вызов отрисовки (индексы 16 бит).
+
+
+// Порядок отрисовки спрайтов:
+typedef enum SpriteBatchSort {
+    SPRITE_BATCH_SORT_TEXTURE,   // Группировать по текстуре (меньше вызовов отрисовки, порядок внутри текстуры сохраняется).
+    SPRITE_BATCH_SORT_DEFERRED,  // В порядке добавления (новый вызов отрисовки на каждой смене текстуры).
+} SpriteBatchSort;
+
+
+// Объявление структур:
+typedef struct SpriteBatch SpriteBatch;
+typedef struct SpriteBatchSprite SpriteBatchSprite;
+typedef struct SpriteBatchVertex SpriteBatchVertex;
+typedef struct SpriteBatchRun SpriteBatchRun;
+typedef struct Renderer Renderer;
+typedef struct Texture Texture;
+typedef struct ShaderProgram ShaderProgram;
+typedef struct VArray VArray;
+typedef struct HashMap HashMap;
+
+
+// Параметры спрайта:
+typedef struct SpriteBatchSprite {
+    Texture *texture;  // Текстура (NULL - белая текстура, то есть просто цветной прямоугольник).
+    Vec2f position;    // Позиция точки origin в мире.
+    Vec2f size;        // Размер спрайта (уже с учётом масштаба).
+    Vec2f origin;      // Точка вращения относительно левого нижнего угла спрайта.
+    float rotation;    // Угол поворота в радианах.
+    Vec4f uv;          // Область текстуры (u0, v0, u1, v1).
+    Vec4f color;       // Цвет (умножается на текстуру).
+} SpriteBatchSprite;
+
+
+// Вершина спрайта (то, что уходит в вершинный буфер):
+typedef struct SpriteBatchVertex {
+    float x, y, z;   // Позиция (a_position).
+    float u, v;      // Текстурные координаты (a_texcoord).
+    uint32_t color;  // Цвет RGBA8 (a_color).
+} SpriteBatchVertex;
+
+
+// Подряд идущие спрайты с одной текстурой (один вызов отрисовки):
+typedef struct SpriteBatchRun {
+    Texture *texture;  // Текстура.
+    uint32_t first;    // Первый спрайт (индекс в вершинах / 4).
+    uint32_t count;    // Количество спрайтов.
+} SpriteBatchRun;
+
+
+// Структура пакета спрайтов:
+typedef struct SpriteBatch {
+    Renderer *renderer;      // Рендерер.
+    ShaderProgram *shader;   // Шейдер пакета (NULL - дефолтный шейдер с текстурой и цветом вершин).
+    SpriteBatchSort sort;    // Порядок отрисовки.
+    bool _is_begin_;
+    void *data;              // Данные реализации рендерера.
+
+    // Накопленные спрайты и результат их сборки:
+    VArray *sprites;   // Спрайты (SpriteBatchSprite) в порядке добавления.
+    VArray *vertices;  // Вершины (SpriteBatchVertex) в порядке отрисовки.
+    VArray *runs;      // Группы спрайтов с одной текстурой (SpriteBatchRun) в порядке отрисовки.
+    HashMap *slots;    // Текстура -> индекс её группы в runs (uint32_t), только при сортировке.
+
+    // Статистика с последнего begin (обычно это кадр):
+    size_t draw_calls;      // Сколько вызовов отрисовки выполнено.
+    size_t vertices_drawn;  // Сколько вершин отправлено.
+    size_t sprites_drawn;   // Сколько спрайтов нарисовано.
+
+    // Функции:
+
+    void (*begin) (SpriteBatch *self);  // Начать пакет (сбрасывает статистику).
+    void (*end)   (SpriteBatch *self);  // Нарисовать накопленное и закончить пакет.
+    void (*flush) (SpriteBatch *self);  // Нарисовать накопленное, не заканчивая пакет.
+    void (*draw)  (SpriteBatch *self, const SpriteBatchSprite *sprite);  // Добавить спрайт.
+
+    // Добавить спрайт текстуры целиком (позиция - левый нижний угол):
+    void (*draw_texture) (SpriteBatch *self, Texture *texture, float x, float y, float width, float height, Vec4f color);
+
+    void (*_destroy_) (SpriteBatch *self);  // Внутренняя функция для удаления объектов рендерера.
+} SpriteBatch;
+
+
+// Создать пакет спрайтов (capacity - сколько спрайтов вмещает без роста, 0 - по умолчанию):
+SpriteBatch* SpriteBatch_create(Renderer *renderer, size_t capacity);
+
+// Уничтожить пакет спрайтов:
+void SpriteBatch_destroy(SpriteBatch **batch);
+
+// Собрать накопленные спрайты в вершины и вызовы отрисовки (для реализаций рендереров):
+void SpriteBatch_build(SpriteBatch *batch);
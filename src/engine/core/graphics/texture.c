@@ -5,16 +5,45 @@
 
 // Подключаем:
 #include <stdio.h>
+#include <stdatomic.h>
 #include "../mm/mm.h"
+#include "../pool.h"
 #include "realization.h"
 #include "texture.h"
 
 
+// Пул структур текстур (создаётся первой текстурой, уничтожается вместе с рендерером, см. Texture_destroy_pool).
+// Texture_destroy можно вызывать из рабочих потоков, поэтому пул под спинлоком:
+static ObjectPool *texture_pool = NULL;
+static atomic_flag texture_pool_lock = ATOMIC_FLAG_INIT;
+
+
+// Захват и освобождение спинлока пула:
+static inline void texture_pool_acquire(void) {
+    while (atomic_flag_test_and_set_explicit(&texture_pool_lock, memory_order_acquire));
+}
+
+static inline void texture_pool_release(void) {
+    atomic_flag_clear_explicit(&texture_pool_lock, memory_order_release);
+}
+
+
+// Вернуть структуру текстуры в пул:
+static void texture_pool_free(Texture *texture) {
+    texture_pool_acquire();
+    ObjectPool_free(texture_pool, texture);
+    texture_pool_release();
+}
+
+
 // Создать текстуру:
 Texture* Texture_create(Renderer *renderer) {
     if (!renderer) return NULL;
 
-    Texture *texture = mm_calloc(1, sizeof(Texture));
+    texture_pool_acquire();
+    if (!texture_pool) texture_pool = ObjectPool_create_tagged(sizeof(Texture), 0, MM_TAG_TEXTURE);
+    Texture *texture = ObjectPool_alloc(texture_pool, NULL);
+    texture_pool_release();
     if (!texture) mm_alloc_error();
 
     // Заполняем поля:
@@ -36,6 +65,7 @@ Texture* Texture_create(Renderer *renderer) {
         default: {
             const char* err = "Unknown renderer type.";
             fprintf(stderr, "Texture_create: %s\n", err);
+            texture_pool_free(texture);
             return NULL;
         }
     }
@@ -51,6 +81,19 @@ void Texture_destroy(Texture **texture) {
     (*texture)->_destroy_(*texture);
 
     // Освобождаем структуру:
-    mm_free(*texture);
+    texture_pool_free(*texture);
     *texture = NULL;
 }
+
+
+// Уничтожить пул структур текстур (вызывается при уничтожении рендерера, когда текстур уже нет):
+void Texture_destroy_pool(void) {
+    texture_pool_acquire();
+    if (texture_pool && ObjectPool_len(texture_pool) > 0) {
+        // Живые текстуры указывают в пул, поэтому не трогаем его (утечку покажет mm):
+        fprintf(stderr, "Texture_destroy_pool: %zu textures are still alive.\n", ObjectPool_len(texture_pool));
+    } else {
+        ObjectPool_destroy(&texture_pool);
+    }
+    texture_pool_release();
+}
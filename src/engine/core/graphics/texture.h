@@ -6,6 +6,7 @@
 
 
 // Подключаем:
+#include <stdint.h>
 #include <stdbool.h>
 
 
@@ -45,6 +46,8 @@ typedef struct Texture {
     int channels;
     bool _is_begin_;
     int32_t _id_before_begin_;
+    uint32_t _unit_;  // Текстурный юнит, к которому привязана текстура между begin и end.
+    uint64_t _pool_key_;  // Ключ пула переиспользования рендерера (размер и формат хранилища).
 
     // Функции:
 
@@ -66,5 +69,9 @@ typedef struct Texture {
 // Создать текстуру:
 Texture* Texture_create(Renderer *renderer);
 
-// Уничтожить текстуру:
+// Уничтожить текстуру (можно из любого потока, если текстура не активирована через begin:
+// объект OpenGL удалит поток рендерера через BufferGC, а структура возвращается в пул под блокировкой):
 void Texture_destroy(Texture **texture);
+
+// Уничтожить пул структур текстур (вызывается при уничтожении рендерера, когда текстур уже нет):
+void Texture_destroy_pool(void);
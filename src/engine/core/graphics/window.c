@@ -23,7 +23,7 @@ WinConfig* Window_create_config(
     void (*hide)    (Window *self),
     void (*destroy) (Window *self)
 ) {
-    WinConfig* config = (WinConfig*)mm_calloc(1, sizeof(WinConfig));
+    WinConfig* config = (WinConfig*)mm_calloc_tagged(1, sizeof(WinConfig), MM_TAG_WINDOW);
     if (!config) mm_alloc_error();
 
     // Заполняем поля (значениями по умолчанию):
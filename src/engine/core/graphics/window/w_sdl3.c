@@ -11,6 +11,7 @@
 #include <string.h>
 #include <SDL3/SDL.h>
 #include "../../mm/mm.h"
+#include "../../mm/frame.h"
 #include "../../math.h"
 #include "../../input.h"
 #include "../image.h"
@@ -147,11 +148,11 @@ static void WindowSDL3_RegisterAPI(Window *window) {
 
 // Создать окно:
 Window* WindowSDL3_create(WinConfig *config, Renderer *renderer) {
-    Window *window = (Window*)mm_alloc(sizeof(Window));
+    Window *window = (Window*)mm_alloc_tagged(sizeof(Window), MM_TAG_WINDOW);
     if (!window) mm_alloc_error();
 
     // Создаём локальные переменные окна:
-    WindowSDL3_Vars *winvars = (WindowSDL3_Vars*)mm_calloc(1, sizeof(WindowSDL3_Vars));
+    WindowSDL3_Vars *winvars = (WindowSDL3_Vars*)mm_calloc_tagged(1, sizeof(WindowSDL3_Vars), MM_TAG_WINDOW);
     if (!winvars) mm_alloc_error();
 
     // Создаём систему ввода:
@@ -342,6 +343,9 @@ static void WindowSDL3_MainLoop(Window *self, WinConfig *cfg) {
             }
         }
 
+        // Время кадра для шейдеров (в блоке данных кадра):
+        self->renderer->set_time(self->renderer, (float)self->get_time(self));
+
         // Обработка основных функций (обновление и отрисовка):
         if (cfg->update) cfg->update(self, self->input, self->get_dtime(self));
         if (cfg->render) cfg->render(self, self->renderer, self->get_dtime(self));
@@ -349,6 +353,10 @@ static void WindowSDL3_MainLoop(Window *self, WinConfig *cfg) {
         // Очищаем все буфера (массивное удаление всех буферов за раз):
         self->renderer->buffers_flush(self->renderer);
 
+        // Сбрасываем временную память кадра и подводим статистику памяти:
+        mm_frame_reset();
+        mm_stats_next_frame();
+
         // Проверяем что окно хотят закрыть:
         if (WinVars->closing) {
             WindowSDL3_Closing_stage(self);
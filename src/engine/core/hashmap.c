@@ -0,0 +1,349 @@
+//
+// hashmap.c - Хэш-таблица с открытой адресацией (Robin Hood).
+//
+// При вставке запись, которая ушла от своей желаемой ячейки дальше, чем текущая,
+// занимает её место ("забирает у богатых"). Поэтому расстояния поиска остаются
+// короткими и ровными, а поиск отсутствующего ключа заканчивается, как только
+// встретилась запись ближе к своей ячейке, чем искомая. Удаление - со сдвигом
+// следующих записей назад, без "надгробий".
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include "mm/mm.h"
+#include "hashmap.h"
+
+
+// Определения:
+#define HASHMAP_NOT_FOUND SIZE_MAX
+
+
+// Объявление функций:
+static void HashMap_rehash(HashMap *map, size_t new_capacity);
+
+
+// Посчитать хэш строки (FNV-1a):
+uint64_t HashMap_hash_str(const char *key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char *c = (const unsigned char*)key; *c; c++) {
+        hash ^= *c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+// Посчитать хэш целого числа (перемешивание splitmix64):
+uint64_t HashMap_hash_int(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+
+// Указатель на значение ячейки:
+static inline void* value_at(HashMap *map, size_t index) {
+    return map->values + index * map->value_size;
+}
+
+
+// Сравнить ключ ячейки с искомым.
+// Ветвимся по str_key, а не по key_type: публичные функции уже проверили, что вид ключа совпадает
+// с таблицей, а так целочисленный путь (str_key == NULL) заведомо не доходит до строковых функций:
+static inline bool key_equals(HashMap *map, HashMapSlot *slot, const char *str_key, uint64_t int_key) {
+    if (str_key) return strcmp(map->strings + slot->key, str_key) == 0;
+    return slot->key == int_key;
+}
+
+
+// Найти ячейку с ключом (HASHMAP_NOT_FOUND если нет):
+static size_t find_slot(HashMap *map, uint64_t hash, const char *str_key, uint64_t int_key) {
+    size_t mask = map->capacity - 1;
+    size_t index = hash & mask;
+    for (uint32_t dist = 1;; dist++) {
+        HashMapSlot *slot = &map->slots[index];
+        if (slot->dist < dist) return HASHMAP_NOT_FOUND;  // Пусто, или ключ был бы раньше.
+        if (slot->hash == hash && key_equals(map, slot, str_key, int_key)) return index;
+        index = (index + 1) & mask;
+    }
+}
+
+
+// Скопировать строковый ключ в пул строк. Возвращает смещение строки:
+static uint64_t intern_string(HashMap *map, const char *key) {
+    size_t size = strlen(key) + 1;
+    if (map->strings_len + size > map->strings_cap) {
+        size_t new_cap = map->strings_cap ? map->strings_cap * 2 : 256;
+        while (new_cap < map->strings_len + size) new_cap *= 2;
+        map->strings = mm_realloc(map->strings, new_cap);
+        if (!map->strings) mm_alloc_error();
+        map->strings_cap = new_cap;
+    }
+    uint64_t offset = map->strings_len;
+    memcpy(map->strings + offset, key, size);
+    map->strings_len += size;
+    return offset;
+}
+
+
+// Вставить новую запись (ключа точно нет в таблице). Возвращает индекс ячейки с новой записью:
+static size_t insert_slot(HashMap *map, uint64_t hash, uint64_t key, const void *value) {
+    char *cur_value = map->scratch;
+    char *tmp_value = map->scratch + map->value_size;
+    if (value) memcpy(cur_value, value, map->value_size);
+    else memset(cur_value, 0, map->value_size);
+
+    HashMapSlot cur = { .hash = hash, .key = key, .dist = 1 };
+    size_t mask = map->capacity - 1;
+    size_t index = hash & mask;
+    size_t result = HASHMAP_NOT_FOUND;
+    for (;;) {
+        HashMapSlot *slot = &map->slots[index];
+
+        // Пустая ячейка - кладём запись:
+        if (slot->dist == 0) {
+            *slot = cur;
+            memcpy(value_at(map, index), cur_value, map->value_size);
+            return result == HASHMAP_NOT_FOUND ? index : result;
+        }
+
+        // Запись в ячейке ближе к своему месту - забираем ячейку, а её запись двигаем дальше:
+        if (slot->dist < cur.dist) {
+            HashMapSlot swap = *slot;
+            *slot = cur;
+            cur = swap;
+            memcpy(tmp_value, value_at(map, index), map->value_size);
+            memcpy(value_at(map, index), cur_value, map->value_size);
+            memcpy(cur_value, tmp_value, map->value_size);
+            if (result == HASHMAP_NOT_FOUND) result = index;
+        }
+        index = (index + 1) & mask;
+        cur.dist++;
+    }
+}
+
+
+// Вставить или заменить значение:
+static void* put_slot(HashMap *map, uint64_t hash, const char *str_key, uint64_t int_key, const void *value) {
+    size_t index = find_slot(map, hash, str_key, int_key);
+    if (index != HASHMAP_NOT_FOUND) {
+        if (value) memmove(value_at(map, index), value, map->value_size);  // value может быть этим же значением.
+        else memset(value_at(map, index), 0, map->value_size);
+        return value_at(map, index);
+    }
+
+    // Держим заполненность не выше 7/8, а пул строк переполнен - тоже перестраиваем таблицу,
+    // чтобы выкинуть строки удалённых ключей:
+    size_t key_size = str_key ? strlen(str_key) + 1 : 0;
+    bool grow = (map->len + 1) * 8 > map->capacity * 7;
+    bool strings_full = str_key && map->strings_len + key_size > map->strings_cap;
+
+    // Ключ и значение могут указывать в память самой таблицы (например, ключ из HashMap_next),
+    // а перестройка и рост пула строк её освобождают. Поэтому сначала копируем их:
+    char *key_copy = NULL;
+    if (grow || strings_full) {
+        if (value) {
+            char *value_copy = map->scratch + map->value_size * 2;
+            memcpy(value_copy, value, map->value_size);
+            value = value_copy;
+        }
+        if (str_key) {
+            key_copy = mm_alloc(key_size);
+            if (!key_copy) mm_alloc_error();
+            memcpy(key_copy, str_key, key_size);
+            str_key = key_copy;
+        }
+    }
+
+    if (grow) HashMap_rehash(map, map->capacity * 2);
+    if (str_key && map->strings_len + key_size > map->strings_cap) HashMap_rehash(map, map->capacity);
+
+    uint64_t key = str_key ? intern_string(map, str_key) : int_key;
+    index = insert_slot(map, hash, key, value);
+    map->len++;
+    mm_free(key_copy);
+    return value_at(map, index);
+}
+
+
+// Удалить запись со сдвигом следующих записей назад:
+static bool remove_slot(HashMap *map, size_t index) {
+    if (index == HASHMAP_NOT_FOUND) return false;
+    size_t mask = map->capacity - 1;
+    size_t next = (index + 1) & mask;
+    while (map->slots[next].dist > 1) {
+        map->slots[index] = map->slots[next];
+        map->slots[index].dist--;
+        memcpy(value_at(map, index), value_at(map, next), map->value_size);
+        index = next;
+        next = (next + 1) & mask;
+    }
+    map->slots[index].dist = 0;
+    map->len--;
+    return true;
+}
+
+
+// Перестроить таблицу с новым размером (заодно пул строк очищается от удалённых ключей):
+static void HashMap_rehash(HashMap *map, size_t new_capacity) {
+    HashMapSlot *old_slots = map->slots;
+    char *old_values = map->values;
+    char *old_strings = map->strings;
+    size_t old_capacity = map->capacity;
+
+    map->slots = mm_calloc(new_capacity, sizeof(HashMapSlot));
+    map->values = mm_alloc(new_capacity * map->value_size);
+    if (!map->slots || !map->values) mm_alloc_error();
+    map->capacity = new_capacity;
+    map->strings = NULL;
+    map->strings_len = 0;
+    map->strings_cap = 0;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        HashMapSlot *slot = &old_slots[i];
+        if (slot->dist == 0) continue;
+        uint64_t key = map->key_type == HASHMAP_KEY_STRING ? intern_string(map, old_strings + slot->key) : slot->key;
+        insert_slot(map, slot->hash, key, old_values + i * map->value_size);
+    }
+
+    mm_free(old_slots);
+    mm_free(old_values);
+    mm_free(old_strings);
+}
+
+
+// Создать хэш-таблицу:
+HashMap* HashMap_create(HashMapKeyType key_type, size_t value_size, size_t initial_capacity) {
+    if (value_size == 0) return NULL;
+
+    // Размер таблицы - степень двойки (чтобы индекс считался маской):
+    size_t capacity = HASHMAP_DEFAULT_CAPACITY;
+    while (capacity < initial_capacity) capacity *= 2;
+
+    HashMap *map = (HashMap*)mm_alloc(sizeof(HashMap));
+    if (!map) mm_alloc_error();
+    map->key_type = key_type;
+    map->value_size = value_size;
+    map->capacity = capacity;
+    map->len = 0;
+    map->slots = mm_calloc(capacity, sizeof(HashMapSlot));
+    map->values = mm_alloc(capacity * value_size);
+    map->scratch = mm_alloc(value_size * 3);
+    if (!map->slots || !map->values || !map->scratch) mm_alloc_error();
+    map->strings = NULL;
+    map->strings_len = 0;
+    map->strings_cap = 0;
+    return map;
+}
+
+
+// Уничтожить хэш-таблицу:
+void HashMap_destroy(HashMap **map) {
+    if (!map || !*map) return;
+    mm_free((*map)->slots);
+    mm_free((*map)->values);
+    mm_free((*map)->strings);
+    mm_free((*map)->scratch);
+    mm_free(*map);
+    *map = NULL;
+}
+
+
+// Получить значение по строковому ключу (NULL если нет):
+void* HashMap_get_str(HashMap *map, const char *key) {
+    if (!key) return NULL;
+    return HashMap_get_str_h(map, key, HashMap_hash_str(key));
+}
+
+
+// Получить значение по строковому ключу с посчитанным хэшем (NULL если нет):
+void* HashMap_get_str_h(HashMap *map, const char *key, uint64_t hash) {
+    if (!map || !key || map->key_type != HASHMAP_KEY_STRING || map->len == 0) return NULL;
+    size_t index = find_slot(map, hash, key, 0);
+    return index == HASHMAP_NOT_FOUND ? NULL : value_at(map, index);
+}
+
+
+// Вставить или заменить значение по строковому ключу (value NULL - значение из нулей). Возвращает указатель на значение:
+void* HashMap_put_str(HashMap *map, const char *key, const void *value) {
+    if (!key) return NULL;
+    return HashMap_put_str_h(map, key, HashMap_hash_str(key), value);
+}
+
+
+// Вставить или заменить значение по строковому ключу с посчитанным хэшем:
+void* HashMap_put_str_h(HashMap *map, const char *key, uint64_t hash, const void *value) {
+    if (!map || !key || map->key_type != HASHMAP_KEY_STRING) return NULL;
+    return put_slot(map, hash, key, 0, value);
+}
+
+
+// Удалить запись по строковому ключу:
+bool HashMap_remove_str(HashMap *map, const char *key) {
+    if (!map || !key || map->key_type != HASHMAP_KEY_STRING || map->len == 0) return false;
+    return remove_slot(map, find_slot(map, HashMap_hash_str(key), key, 0));
+}
+
+
+// Получить значение по целочисленному ключу (NULL если нет):
+void* HashMap_get_int(HashMap *map, uint64_t key) {
+    if (!map || map->key_type != HASHMAP_KEY_INT || map->len == 0) return NULL;
+    size_t index = find_slot(map, HashMap_hash_int(key), NULL, key);
+    return index == HASHMAP_NOT_FOUND ? NULL : value_at(map, index);
+}
+
+
+// Вставить или заменить значение по целочисленному ключу (value NULL - значение из нулей). Возвращает указатель на значение:
+void* HashMap_put_int(HashMap *map, uint64_t key, const void *value) {
+    if (!map || map->key_type != HASHMAP_KEY_INT) return NULL;
+    return put_slot(map, HashMap_hash_int(key), NULL, key, value);
+}
+
+
+// Удалить запись по целочисленному ключу:
+bool HashMap_remove_int(HashMap *map, uint64_t key) {
+    if (!map || map->key_type != HASHMAP_KEY_INT || map->len == 0) return false;
+    return remove_slot(map, find_slot(map, HashMap_hash_int(key), NULL, key));
+}
+
+
+// Обход таблицы: начните с *iter = 0, возвращает значение следующей записи или NULL в конце.
+// Ключ записи пишется в str_key или int_key (в зависимости от вида ключей, можно NULL):
+void* HashMap_next(HashMap *map, size_t *iter, const char **str_key, uint64_t *int_key) {
+    if (!map || !iter) return NULL;
+    for (; *iter < map->capacity; (*iter)++) {
+        HashMapSlot *slot = &map->slots[*iter];
+        if (slot->dist == 0) continue;
+        if (map->key_type == HASHMAP_KEY_STRING) {
+            if (str_key) *str_key = map->strings + slot->key;
+        } else if (int_key) {
+            *int_key = slot->key;
+        }
+        return value_at(map, (*iter)++);
+    }
+    return NULL;
+}
+
+
+// Получить количество записей:
+size_t HashMap_len(HashMap *map) {
+    if (!map) return 0;
+    return map->len;
+}
+
+
+// Очистить таблицу:
+void HashMap_clear(HashMap *map) {
+    if (!map) return;
+    memset(map->slots, 0, map->capacity * sizeof(HashMapSlot));
+    map->len = 0;
+    map->strings_len = 0;
+}
@@ -0,0 +1,103 @@
+//
+// hashmap.h - Хэш-таблица с открытой адресацией (Robin Hood).
+//
+// Ключи - строки или целые числа (uint64_t). Значения фиксированного размера хранятся
+// прямо в таблице, строковые ключи копируются в общий пул строк таблицы, так что на
+// одну запись не делается ни одного отдельного выделения памяти.
+// Для горячих мест есть варианты функций с заранее посчитанным хэшем (суффикс _h).
+// ВНИМАНИЕ: Указатели на значения становятся недействительными после вставки или удаления!
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// Определения:
+#define HASHMAP_DEFAULT_CAPACITY 16  // Размер таблицы по умолчанию.
+
+
+// Виды ключей:
+typedef enum HashMapKeyType {
+    HASHMAP_KEY_STRING,  // Строковые ключи (копируются в таблицу).
+    HASHMAP_KEY_INT,     // Целочисленные ключи (uint64_t).
+} HashMapKeyType;
+
+
+// Объявление структур:
+typedef struct HashMapSlot HashMapSlot;
+typedef struct HashMap HashMap;
+
+
+// Ячейка таблицы:
+typedef struct HashMapSlot {
+    uint64_t hash;  // Хэш ключа.
+    uint64_t key;   // Целочисленный ключ или смещение строки в пуле строк.
+    uint32_t dist;  // Расстояние от желаемой ячейки + 1 (0 - ячейка пустая).
+} HashMapSlot;
+
+
+// Структура хэш-таблицы:
+typedef struct HashMap {
+    HashMapKeyType key_type;  // Вид ключей.
+    size_t value_size;        // Размер значения.
+    size_t capacity;          // Количество ячеек (степень двойки).
+    size_t len;               // Количество записей.
+    HashMapSlot *slots;       // Ячейки.
+    char *values;             // Значения (capacity * value_size).
+    char *strings;            // Пул строковых ключей.
+    size_t strings_len;       // Сколько байт пула занято.
+    size_t strings_cap;       // Размер пула.
+    char *scratch;            // Временный буфер для перестановки значений и копии вставляемого значения.
+} HashMap;
+
+
+// Посчитать хэш строки (FNV-1a):
+uint64_t HashMap_hash_str(const char *key);
+
+// Посчитать хэш целого числа:
+uint64_t HashMap_hash_int(uint64_t key);
+
+// Создать хэш-таблицу:
+HashMap* HashMap_create(HashMapKeyType key_type, size_t value_size, size_t initial_capacity);
+
+// Уничтожить хэш-таблицу:
+void HashMap_destroy(HashMap **map);
+
+// Получить значение по строковому ключу (NULL если нет):
+void* HashMap_get_str(HashMap *map, const char *key);
+
+// Получить значение по строковому ключу с посчитанным хэшем (NULL если нет):
+void* HashMap_get_str_h(HashMap *map, const char *key, uint64_t hash);
+
+// Вставить или заменить значение по строковому ключу (value NULL - значение из нулей). Возвращает указатель на значение:
+void* HashMap_put_str(HashMap *map, const char *key, const void *value);
+
+// Вставить или заменить значение по строковому ключу с посчитанным хэшем:
+void* HashMap_put_str_h(HashMap *map, const char *key, uint64_t hash, const void *value);
+
+// Удалить запись по строковому ключу:
+bool HashMap_remove_str(HashMap *map, const char *key);
+
+// Получить значение по целочисленному ключу (NULL если нет):
+void* HashMap_get_int(HashMap *map, uint64_t key);
+
+// Вставить или заменить значение по целочисленному ключу (value NULL - значение из нулей). Возвращает указатель на значение:
+void* HashMap_put_int(HashMap *map, uint64_t key, const void *value);
+
+// Удалить запись по целочисленному ключу:
+bool HashMap_remove_int(HashMap *map, uint64_t key);
+
+// Обход таблицы: начните с *iter = 0, возвращает значение следующей записи или NULL в конце.
+// Ключ записи пишется в str_key или int_key (в зависимости от вида ключей, можно NULL):
+void* HashMap_next(HashMap *map, size_t *iter, const char **str_key, uint64_t *int_key);
+
+// Получить количество записей:
+size_t HashMap_len(HashMap *map);
+
+// Очистить таблицу:
+void HashMap_clear(HashMap *map);
@@ -26,13 +26,13 @@ static bool* Input_Impl_get_key_up(Window *self);
 
 // Создать структуру мыши:
 Input_MouseState* Input_MouseState_create(int max_keys) {
-    Input_MouseState *ms = (Input_MouseState*)mm_calloc(1, sizeof(Input_MouseState));
+    Input_MouseState *ms = (Input_MouseState*)mm_calloc_tagged(1, sizeof(Input_MouseState), MM_TAG_INPUT);
     if (!ms) mm_alloc_error();
     ms->max_keys = max_keys;
     ms->visible = true;
-    ms->pressed = (bool*)mm_calloc(max_keys, sizeof(bool));
-    ms->down    = (bool*)mm_calloc(max_keys, sizeof(bool));
-    ms->up      = (bool*)mm_calloc(max_keys, sizeof(bool));
+    ms->pressed = (bool*)mm_calloc_tagged(max_keys, sizeof(bool), MM_TAG_INPUT);
+    ms->down    = (bool*)mm_calloc_tagged(max_keys, sizeof(bool), MM_TAG_INPUT);
+    ms->up      = (bool*)mm_calloc_tagged(max_keys, sizeof(bool), MM_TAG_INPUT);
     if (!ms->pressed || !ms->down || !ms->up) {
         if (ms->pressed) mm_free(ms->pressed);
         if (ms->down) mm_free(ms->down);
@@ -57,12 +57,12 @@ void Input_MouseState_destroy(Input_MouseState **mouse_state) {
 
 // Создать структуру клавиатуры:
 Input_KeyboardState* Input_KeyboardState_create(int max_keys) {
-    Input_KeyboardState *kb = (Input_KeyboardState*)mm_calloc(1, sizeof(Input_KeyboardState));
+    Input_KeyboardState *kb = (Input_KeyboardState*)mm_calloc_tagged(1, sizeof(Input_KeyboardState), MM_TAG_INPUT);
     if (!kb) mm_alloc_error();
     kb->max_keys = max_keys;
-    kb->pressed = (bool*)mm_calloc(max_keys, sizeof(bool));
-    kb->down    = (bool*)mm_calloc(max_keys, sizeof(bool));
-    kb->up      = (bool*)mm_calloc(max_keys, sizeof(bool));
+    kb->pressed = (bool*)mm_calloc_tagged(max_keys, sizeof(bool), MM_TAG_INPUT);
+    kb->down    = (bool*)mm_calloc_tagged(max_keys, sizeof(bool), MM_TAG_INPUT);
+    kb->up      = (bool*)mm_calloc_tagged(max_keys, sizeof(bool), MM_TAG_INPUT);
     if (!kb->pressed || !kb->down || !kb->up) {
         if (kb->pressed) mm_free(kb->pressed);
         if (kb->down) mm_free(kb->down);
@@ -92,7 +92,7 @@ Input* Input_create(
     void (*set_mouse_pos) (Window *self, int x, int y),
     void (*set_mouse_visible) (Window *self, bool visible)
 ) {
-    Input *input = (Input*)mm_alloc(sizeof(Input));
+    Input *input = (Input*)mm_alloc_tagged(sizeof(Input), MM_TAG_INPUT);
     if (!input) mm_alloc_error();
 
     // Заполняем поля:
@@ -0,0 +1,186 @@
+//
+// frame.c - Кадровый линейный аллокатор (временная память на один кадр).
+//
+// Если буфер кадра переполнился, память берётся через mm_alloc и освобождается
+// вместе с буфером. При следующем использовании переполненный буфер увеличивается,
+// так что переполнения случаются только пока аллокатор "разогревается".
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include "mm.h"
+#include "frame.h"
+
+
+// Блок выделенный при переполнении буфера (заголовок перед данными):
+typedef struct MM_FrameOverflow {
+    struct MM_FrameOverflow *next;  // Следующий блок.
+    size_t size;                    // Размер данных блока.
+} MM_FrameOverflow;
+
+
+// Один буфер кадра:
+typedef struct MM_FrameArena {
+    char *data;                  // Память буфера.
+    size_t capacity;             // Размер буфера.
+    size_t used;                 // Сколько занято.
+    size_t overflow_count;       // Количество переполнений.
+    size_t overflow_size;        // Байт выделено при переполнениях.
+    MM_FrameOverflow *overflow;  // Список блоков выделенных при переполнении.
+} MM_FrameArena;
+
+
+// Состояние кадрового аллокатора:
+static MM_FrameArena mm_frame_arenas[2] = {0};
+static size_t mm_frame_current = 0;
+static size_t mm_frame_peak = 0;
+static size_t mm_frame_total_overflows = 0;
+static bool mm_frame_inited = false;
+
+
+// Выровнять размер:
+static inline size_t align_up(size_t size, size_t align) {
+    return (size + align - 1) & ~(align - 1);
+}
+
+
+// Освободить блоки переполнения и сбросить буфер:
+static void arena_release(MM_FrameArena *arena) {
+    MM_FrameOverflow *block = arena->overflow;
+    while (block) {
+        MM_FrameOverflow *next = block->next;
+        mm_free(block);
+        block = next;
+    }
+    arena->overflow = NULL;
+    arena->used = 0;
+    arena->overflow_count = 0;
+    arena->overflow_size = 0;
+}
+
+
+// Инициализировать кадровый аллокатор с заданным размером буфера (необязательно, иначе размер по умолчанию):
+void mm_frame_init(size_t capacity) {
+    if (mm_frame_inited) mm_frame_destroy();
+    if (capacity == 0) capacity = MM_FRAME_DEFAULT_CAPACITY;
+    capacity = align_up(capacity, MM_FRAME_ALIGNMENT);
+
+    for (int i = 0; i < 2; i++) {
+        mm_frame_arenas[i].data = mm_alloc_tagged(capacity, MM_TAG_FRAME);
+        mm_frame_arenas[i].capacity = capacity;
+        arena_release(&mm_frame_arenas[i]);
+    }
+    mm_frame_current = 0;
+    mm_frame_inited = true;
+}
+
+
+// Уничтожить кадровый аллокатор:
+void mm_frame_destroy() {
+    if (!mm_frame_inited) return;
+    for (int i = 0; i < 2; i++) {
+        arena_release(&mm_frame_arenas[i]);
+        mm_free(mm_frame_arenas[i].data);
+        mm_frame_arenas[i].data = NULL;
+        mm_frame_arenas[i].capacity = 0;
+    }
+    mm_frame_inited = false;
+}
+
+
+// Выделить память до конца следующего кадра:
+void* mm_frame_alloc(size_t size) {
+    if (!mm_frame_inited) mm_frame_init(0);
+    MM_FrameArena *arena = &mm_frame_arenas[mm_frame_current];
+    size = align_up(size ? size : 1, MM_FRAME_ALIGNMENT);
+
+    // Основной путь - просто сдвигаем указатель:
+    if (arena->used + size <= arena->capacity) {
+        void *ptr = arena->data + arena->used;
+        arena->used += size;
+        return ptr;
+    }
+
+    // Переполнение - выделяем через менеджер памяти и запоминаем блок:
+    MM_FrameOverflow *block = mm_alloc_tagged(align_up(sizeof(MM_FrameOverflow), MM_FRAME_ALIGNMENT) + size, MM_TAG_FRAME);
+    block->size = size;
+    block->next = arena->overflow;
+    arena->overflow = block;
+    arena->overflow_count++;
+    arena->overflow_size += size;
+    mm_frame_total_overflows++;
+    return (char*)block + align_up(sizeof(MM_FrameOverflow), MM_FRAME_ALIGNMENT);
+}
+
+
+// Выделить память с обнулением до конца следующего кадра:
+void* mm_frame_calloc(size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;  // Переполнение count * size.
+    void *ptr = mm_frame_alloc(count * size);
+    memset(ptr, 0, count * size);
+    return ptr;
+}
+
+
+// Форматировать строку во временную память кадра:
+char* mm_frame_format(const char *fmt, ...) {
+    if (!fmt) return NULL;
+    va_list args;
+    va_start(args, fmt);
+    int needed = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (needed < 0) return NULL;
+
+    char *str = mm_frame_alloc((size_t)needed + 1);
+    va_start(args, fmt);
+    vsnprintf(str, (size_t)needed + 1, fmt, args);
+    va_end(args);
+    return str;
+}
+
+
+// Сменить кадр (вызывается автоматически в цикле окна):
+void mm_frame_reset() {
+    if (!mm_frame_inited) return;
+
+    // Запоминаем пик использования кадра:
+    MM_FrameArena *arena = &mm_frame_arenas[mm_frame_current];
+    size_t frame_size = arena->used + arena->overflow_size;
+    if (frame_size > mm_frame_peak) mm_frame_peak = frame_size;
+
+    // Переключаемся на другой буфер. Его данные (позапрошлый кадр) больше не нужны:
+    mm_frame_current ^= 1;
+    arena = &mm_frame_arenas[mm_frame_current];
+
+    // Если буфер переполнялся - увеличиваем его, чтобы в следующий раз всё влезло:
+    size_t needed = arena->used + arena->overflow_size;
+    if (needed > arena->capacity) {
+        size_t capacity = arena->capacity;
+        while (capacity < needed) capacity *= 2;
+        mm_free(arena->data);
+        arena->data = mm_alloc_tagged(capacity, MM_TAG_FRAME);
+        arena->capacity = capacity;
+    }
+    arena_release(arena);
+}
+
+
+// Получить статистику кадрового аллокатора:
+MM_FrameStats mm_frame_get_stats() {
+    MM_FrameArena *current = &mm_frame_arenas[mm_frame_current];
+    MM_FrameArena *last = &mm_frame_arenas[mm_frame_current ^ 1];
+    return (MM_FrameStats){
+        .capacity = current->capacity,
+        .used = current->used,
+        .peak = mm_frame_peak,
+        .overflow_count = last->overflow_count,
+        .overflow_size = last->overflow_size,
+        .total_overflows = mm_frame_total_overflows,
+    };
+}
@@ -0,0 +1,55 @@
+//
+// frame.h - Кадровый линейный аллокатор (временная память на один кадр).
+//
+// Память выделяется простым сдвигом указателя и освобождается вся разом.
+// Используются два буфера по очереди: данные выделенные в кадре N живут до конца кадра N+1.
+// Работает только в главном потоке (в потоке цикла окна).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+
+
+// Определения:
+#define MM_FRAME_DEFAULT_CAPACITY (4 * 1024 * 1024)  // Размер одного буфера по умолчанию (4 мб).
+#define MM_FRAME_ALIGNMENT 16                        // Выравнивание выделяемых блоков.
+
+
+// Объявление структур:
+typedef struct MM_FrameStats MM_FrameStats;
+
+
+// Статистика кадрового аллокатора:
+typedef struct MM_FrameStats {
+    size_t capacity;         // Размер одного буфера в байтах.
+    size_t used;             // Сколько байт занято в текущем кадре.
+    size_t peak;             // Максимум байт, занятых за один кадр (с учетом переполнений).
+    size_t overflow_count;   // Сколько выделений не влезло в буфер в прошлом кадре.
+    size_t overflow_size;    // Сколько байт не влезло в буфер в прошлом кадре.
+    size_t total_overflows;  // Сколько выделений не влезло в буфер за всё время.
+} MM_FrameStats;
+
+
+// Инициализировать кадровый аллокатор с заданным размером буфера (необязательно, иначе размер по умолчанию):
+void mm_frame_init(size_t capacity);
+
+// Уничтожить кадровый аллокатор:
+void mm_frame_destroy();
+
+// Выделить память до конца следующего кадра:
+void* mm_frame_alloc(size_t size);
+
+// Выделить память с обнулением до конца следующего кадра:
+void* mm_frame_calloc(size_t count, size_t size);
+
+// Форматировать строку во временную память кадра:
+char* mm_frame_format(const char *fmt, ...);
+
+// Сменить кадр (вызывается автоматически в цикле окна):
+void mm_frame_reset();
+
+// Получить статистику кадрового аллокатора:
+MM_FrameStats mm_frame_get_stats();
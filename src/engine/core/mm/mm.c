@@ -1,10 +1,17 @@
 //
 // mm.c - Исходник реализовывающий базовую работу менеджера памяти.
 //
-// Пока что просто обертка над обычным malloc, но позволяет отслеживать
-// использование памяти, и получать размер блока памяти. Отслеживание
+// Обертка над выбранным бэкендом аллокатора (malloc или slab), которая позволяет
+// отслеживать использование памяти, и получать размер блока памяти. Отслеживание
 // памяти является атомарным, что подходит для многопоточности.
 //
+// Счётчики статистики разбиты на шарды: каждый поток пишет в свой шард (своя
+// строка кэша), а при чтении шарды суммируются. Так параллельные выделения
+// памяти не борются за одну общую переменную.
+//
+// Каждый блок хранит свой тег, поэтому память учитывается раздельно по тегам
+// (текстуры, шейдеры, массивы и т.д.), а для тегов можно задать бюджеты.
+//
 
 
 // Подключаем:
@@ -14,21 +21,233 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
 #include <stdatomic.h>
+#include "slab.h"
+#include "profiler.h"
 #include "mm.h"
 
 
-// Определения функций аллокатора которые используются в этой обертке (пока что используется базовый аллокатор):
-void* (*_m_alloc)   (size_t s)           = malloc;
-void* (*_m_calloc)  (size_t c, size_t s) = calloc;
-void* (*_m_realloc) (void *p, size_t s)  = realloc;
-void  (*_m_free)    (void *p)            = free;
+// Обертки над базовым аллокатором (размер блока ему не нужен):
+static void* std_realloc(void *p, size_t old_s, size_t s) { (void)old_s; return realloc(p, s); }
+static void  std_free(void *p, size_t s) { (void)s; free(p); }
+
+
+// Определения функций аллокатора которые используются в этой обертке (по умолчанию базовый аллокатор):
+// Функциям освобождения и расширения передаётся полный размер блока (с заголовком).
+void* (*_m_alloc)   (size_t s)                        = malloc;
+void* (*_m_calloc)  (size_t c, size_t s)              = calloc;
+void* (*_m_realloc) (void *p, size_t old_s, size_t s) = std_realloc;
+void  (*_m_free)    (void *p, size_t s)               = std_free;
+static MM_Backend _m_backend = MM_BACKEND_MALLOC;  // Текущий бэкенд.
+
+
+// Информация о блоке (всегда лежит прямо перед данными блока):
+typedef struct MM_BlockInfo {
+    size_t   size;         // Размер блока (сколько запросили).
+    uint16_t offset;       // Смещение данных от начала сырого блока.
+    uint8_t  align_shift;  // Выравнивание блока как степень двойки (0 - стандартное).
+    uint8_t  tag;          // Тег блока (MM_Tag).
+    uint32_t sample;       // Номер сэмпла профайлера (0 - блок не попал в сэмплы).
+} MM_BlockInfo;
 
 
 // Сколько памяти используется в байтах:
-static const size_t _header_size = sizeof(size_t) * 8;  // Выравнивание по 8 байт для SSE, AVX/2, кэша и чётных адресов.
-static atomic_size_t mm_total_allocated_blocks = 0;     // Количество выделенных блоков.
-static atomic_size_t mm_used_size = 0;                  // Количество используемой виртуальной памяти.
+#ifdef MM_COMPACT_HEADER
+    static const size_t _header_size = sizeof(MM_BlockInfo);  // Компактный заголовок (16 байт).
+#else
+    static const size_t _header_size = sizeof(size_t) * 8;    // Выравнивание по 8 байт для SSE, AVX/2, кэша и чётных адресов.
+#endif
+
+// Количество шардов статистики:
+#define MM_STATS_SHARDS 64
+
+
+// Шард статистики (на отдельной строке кэша). Значения в шарде могут "уходить в минус"
+// если блок освобождается в другом потоке, но сумма по всем шардам всегда верная:
+typedef struct MM_StatsShard {
+    _Alignas(64) atomic_size_t used;  // Количество используемой виртуальной памяти.
+    atomic_size_t overhead;           // Сколько памяти ушло на заголовки и выравнивание.
+    atomic_size_t blocks;             // Количество выделенных блоков.
+    atomic_size_t allocs;             // Сколько всего было выделений (только растёт).
+    atomic_size_t alloc_size;         // Сколько всего байт было выделено (только растёт).
+    atomic_size_t tag_used[MM_TAG_COUNT];    // Используемая память по тегам.
+    atomic_size_t tag_blocks[MM_TAG_COUNT];  // Количество блоков по тегам.
+    atomic_size_t base;               // Значение used на последней границе кадра.
+    atomic_size_t rise;               // Наибольший рост used над base с границы кадра (пик внутри кадра).
+} MM_StatsShard;
+
+static MM_StatsShard mm_shards[MM_STATS_SHARDS];        // Шарды статистики.
+static atomic_size_t mm_shards_next = 0;                // Счётчик для раздачи шардов потокам.
+static _Thread_local MM_StatsShard *mm_shard = NULL;    // Шард текущего потока.
+
+// Статистика по кадрам (обновляется в mm_stats_next_frame):
+static atomic_size_t mm_peak_used_size = 0;   // Пиковое использование памяти.
+static atomic_size_t mm_frame_base_used = 0;  // Использование памяти на последней границе кадра.
+static size_t mm_frame_allocs = 0;            // Выделений за прошлый кадр.
+static size_t mm_frame_alloc_size = 0;        // Байт выделено за прошлый кадр.
+static size_t mm_last_allocs = 0;             // Всего выделений на начало кадра.
+static size_t mm_last_alloc_size = 0;         // Всего байт выделено на начало кадра.
+
+// Бюджеты тегов:
+static atomic_size_t mm_tag_budgets[MM_TAG_COUNT];  // Бюджет тега в байтах (0 - без ограничения).
+static bool mm_tag_over_budget[MM_TAG_COUNT];       // Превышение бюджета уже было выведено.
+
+// Названия тегов:
+static const char *mm_tag_names[MM_TAG_COUNT] = {
+    "general", "texture", "shader", "image", "darray", "renderer", "window", "input", "physics", "frame",
+};
+
+
+// Получить шард статистики текущего потока:
+static inline MM_StatsShard* stats_shard() {
+    if (!mm_shard) mm_shard = &mm_shards[atomic_fetch_add(&mm_shards_next, 1) % MM_STATS_SHARDS];
+    return mm_shard;
+}
+
+
+// Добавить значение в шард (без упорядочивания, нужна только атомарность):
+static inline void shard_add(atomic_size_t *counter, size_t value) {
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+
+// Просуммировать поле по всем шардам:
+static size_t shards_sum(size_t field_offset) {
+    size_t sum = 0;
+    for (size_t i = 0; i < MM_STATS_SHARDS; i++) {
+        atomic_size_t *counter = (atomic_size_t*)((char*)&mm_shards[i] + field_offset);
+        sum += atomic_load_explicit(counter, memory_order_relaxed);
+    }
+    return sum;
+}
+#define SHARDS_SUM(field) shards_sum(offsetof(MM_StatsShard, field))
+#define SHARDS_SUM_TAG(field, tag) shards_sum(offsetof(MM_StatsShard, field) + sizeof(atomic_size_t) * (tag))
+
+
+// Увеличить used шарда и запомнить его наибольший рост с границы кадра (чтобы видеть пики внутри кадра).
+// Рост считается со знаком: used шарда может "уходить в минус" из-за освобождений в других потоках:
+static inline void shard_grow(MM_StatsShard *shard, size_t size) {
+    size_t used = atomic_fetch_add_explicit(&shard->used, size, memory_order_relaxed) + size;
+    size_t rise = used - atomic_load_explicit(&shard->base, memory_order_relaxed);
+    size_t peak = atomic_load_explicit(&shard->rise, memory_order_relaxed);
+    while ((ptrdiff_t)rise > (ptrdiff_t)peak &&
+           !atomic_compare_exchange_weak_explicit(&shard->rise, &peak, rise, memory_order_relaxed, memory_order_relaxed));
+}
+
+
+// Обновить пиковое использование памяти. Кроме текущего значения учитывается пик внутри кадра:
+// использование на границе кадра плюс наибольший рост одного шарда (точно, если память
+// в кадре выделяет один поток, иначе - оценка):
+static inline size_t update_peak(size_t used) {
+    size_t rise = 0;
+    for (size_t i = 0; i < MM_STATS_SHARDS; i++) {
+        size_t shard_rise = atomic_load_explicit(&mm_shards[i].rise, memory_order_relaxed);
+        if ((ptrdiff_t)shard_rise > (ptrdiff_t)rise) rise = shard_rise;
+    }
+    size_t frame_peak = atomic_load_explicit(&mm_frame_base_used, memory_order_relaxed) + rise;
+    if (frame_peak > used) used = frame_peak;
+    size_t peak = atomic_load(&mm_peak_used_size);
+    while (used > peak && !atomic_compare_exchange_weak(&mm_peak_used_size, &peak, used));
+    return used > peak ? used : peak;
+}
+
+
+// Получить информацию о блоке:
+static inline MM_BlockInfo* block_info(void *ptr) {
+    return (MM_BlockInfo*)((char*)ptr - sizeof(MM_BlockInfo));
+}
+
+
+// Получить выравнивание блока (0 - стандартное):
+static inline size_t block_align(MM_BlockInfo *info) {
+    return info->align_shift ? (size_t)1 << info->align_shift : 0;
+}
+
+
+// Полный размер сырого блока (заголовок + выравнивание + данные):
+static inline size_t block_raw_size(size_t size, size_t align) {
+    return _header_size + size + (align > MM_BASE_ALIGNMENT ? align - MM_BASE_ALIGNMENT : 0);
+}
+
+
+// Разметить сырой блок и учесть его в статистике:
+static inline void* block_setup(char *raw_ptr, size_t size, size_t align, MM_Tag tag, const char *file, int line) {
+    // Выравниваем начало данных (без выравнивания это просто raw_ptr + _header_size):
+    // [... заголовок ...|MM_BlockInfo|сам блок] <- весь блок.
+    uintptr_t addr = (uintptr_t)raw_ptr + _header_size;
+    if (align > MM_BASE_ALIGNMENT) addr = (addr + align - 1) & ~(uintptr_t)(align - 1);
+    void *ptr = (void*)addr;
+
+    MM_BlockInfo *info = block_info(ptr);
+    info->size = size;
+    info->offset = (uint16_t)((char*)ptr - raw_ptr);
+    info->align_shift = 0;
+    if (align > MM_BASE_ALIGNMENT) while (((size_t)1 << info->align_shift) < align) info->align_shift++;
+    info->tag = (uint8_t)tag;
+    info->sample = mm_profiler_tick(size) ? mm_profiler_record(ptr, size, (uint8_t)tag, file, line) : 0;
+
+    MM_StatsShard *shard = stats_shard();
+    shard_grow(shard, size);
+    shard_add(&shard->overhead, block_raw_size(size, block_align(info)) - size);
+    shard_add(&shard->blocks, 1);
+    shard_add(&shard->allocs, 1);
+    shard_add(&shard->alloc_size, size);
+    shard_add(&shard->tag_used[tag], size);
+    shard_add(&shard->tag_blocks[tag], 1);
+    return ptr;
+}
+
+
+// Выделить и разметить блок:
+static void* block_alloc(size_t size, size_t align, MM_Tag tag, const char *file, int line, bool zero) {
+    if ((unsigned)tag >= MM_TAG_COUNT) tag = MM_TAG_GENERAL;
+    char *raw_ptr = zero ? _m_calloc(1, block_raw_size(size, align)) : _m_alloc(block_raw_size(size, align));
+    if (!raw_ptr) { mm_alloc_error(); return NULL; }
+    return block_setup(raw_ptr, size, align, tag, file, line);
+}
+
+
+// Установить бэкенд аллокатора (можно только пока нет выделенных блоков):
+bool mm_set_backend(MM_Backend backend) {
+    if (backend == _m_backend) return true;
+    if (mm_get_total_allocated_blocks() > 0) {
+        fprintf(stderr, "mm_set_backend: Backend cannot be changed while %zu blocks are allocated.\n",
+                mm_get_total_allocated_blocks());
+        return false;
+    }
+
+    switch (backend) {
+        case MM_BACKEND_MALLOC:
+            _m_alloc = malloc;
+            _m_calloc = calloc;
+            _m_realloc = std_realloc;
+            _m_free = std_free;
+            break;
+
+        case MM_BACKEND_SLAB:
+            _m_alloc = slab_alloc;
+            _m_calloc = slab_calloc;
+            _m_realloc = slab_realloc;
+            _m_free = slab_free;
+            break;
+
+        default:
+            return false;
+    }
+    _m_backend = backend;
+    return true;
+}
+
+
+// Получить текущий бэкенд аллокатора:
+MM_Backend mm_get_backend() { return _m_backend; }
+
+
+// Вызовите перед завершением рабочего потока, чтобы вернуть его кэш памяти в общий доступ:
+void mm_thread_release() {
+    if (_m_backend == MM_BACKEND_SLAB) slab_thread_release();
+}
 
 
 // Получить размер заголовка блока в байтах:
@@ -36,15 +255,104 @@ size_t mm_get_block_header_size() { return _header_size; }
 
 
 // Получить количество выделенных блоков:
-size_t mm_get_total_allocated_blocks() { return mm_total_allocated_blocks; }
+size_t mm_get_total_allocated_blocks() { return SHARDS_SUM(blocks); }
 
 
-// Получить абсолютный размер используемой памяти в байтах с учётом заголовков блоков:
-size_t mm_get_absolute_used_size() { return mm_used_size + _header_size * mm_total_allocated_blocks; }
+// Получить абсолютный размер используемой памяти в байтах с учётом заголовков блоков и выравнивания:
+size_t mm_get_absolute_used_size() { return SHARDS_SUM(used) + SHARDS_SUM(overhead); }
 
 
 // Получить сколько всего используется памяти в байтах этим менеджером памяти:
-size_t mm_get_used_size() { return mm_used_size; }
+size_t mm_get_used_size() { return SHARDS_SUM(used); }
+
+
+// Получить пиковое использование памяти в байтах (включая пики внутри кадра):
+size_t mm_get_peak_used_size() { return update_peak(mm_get_used_size()); }
+
+
+// Получить сколько всего было выделений памяти:
+size_t mm_get_total_allocs() { return SHARDS_SUM(allocs); }
+
+
+// Получить количество выделений памяти за прошлый кадр:
+size_t mm_get_frame_allocs() { return mm_frame_allocs; }
+
+
+// Получить сколько байт было выделено за прошлый кадр:
+size_t mm_get_frame_alloc_size() { return mm_frame_alloc_size; }
+
+
+// Подвести статистику памяти за кадр и проверить бюджеты тегов (вызывается автоматически в цикле окна):
+void mm_stats_next_frame() {
+    size_t allocs = SHARDS_SUM(allocs);
+    size_t alloc_size = SHARDS_SUM(alloc_size);
+    mm_frame_allocs = allocs - mm_last_allocs;
+    mm_frame_alloc_size = alloc_size - mm_last_alloc_size;
+    mm_last_allocs = allocs;
+    mm_last_alloc_size = alloc_size;
+    size_t used = mm_get_used_size();
+    update_peak(used);
+
+    // Пик кадра учтён - начинаем отсчёт роста шардов заново:
+    for (size_t i = 0; i < MM_STATS_SHARDS; i++) {
+        atomic_store_explicit(&mm_shards[i].base, atomic_load_explicit(&mm_shards[i].used, memory_order_relaxed), memory_order_relaxed);
+        atomic_store_explicit(&mm_shards[i].rise, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&mm_frame_base_used, used, memory_order_relaxed);
+
+    // Проверяем бюджеты (предупреждаем один раз, пока тег не вернётся в бюджет):
+    for (int tag = 0; tag < MM_TAG_COUNT; tag++) {
+        size_t budget = atomic_load_explicit(&mm_tag_budgets[tag], memory_order_relaxed);
+        if (!budget) continue;
+        size_t used = mm_get_tag_used_size(tag);
+        if (used > budget && !mm_tag_over_budget[tag]) {
+            fprintf(stderr, "mm: Memory tag \"%s\" is over budget: %zu b used of %zu b.\n", mm_tag_names[tag], used, budget);
+        }
+        mm_tag_over_budget[tag] = used > budget;
+    }
+}
+
+
+// Получить название тега:
+const char* mm_get_tag_name(MM_Tag tag) {
+    if ((unsigned)tag >= MM_TAG_COUNT) return "unknown";
+    return mm_tag_names[tag];
+}
+
+
+// Получить сколько памяти в байтах используется под тег:
+size_t mm_get_tag_used_size(MM_Tag tag) {
+    if ((unsigned)tag >= MM_TAG_COUNT) return 0;
+    return SHARDS_SUM_TAG(tag_used, tag);
+}
+
+
+// Получить количество выделенных блоков с тегом:
+size_t mm_get_tag_blocks(MM_Tag tag) {
+    if ((unsigned)tag >= MM_TAG_COUNT) return 0;
+    return SHARDS_SUM_TAG(tag_blocks, tag);
+}
+
+
+// Установить бюджет тега в байтах (0 - без ограничения). При превышении выводится предупреждение:
+void mm_set_tag_budget(MM_Tag tag, size_t budget) {
+    if ((unsigned)tag >= MM_TAG_COUNT) return;
+    atomic_store(&mm_tag_budgets[tag], budget);
+}
+
+
+// Получить бюджет тега в байтах (0 - без ограничения):
+size_t mm_get_tag_budget(MM_Tag tag) {
+    if ((unsigned)tag >= MM_TAG_COUNT) return 0;
+    return atomic_load(&mm_tag_budgets[tag]);
+}
+
+
+// Получить тег блока:
+MM_Tag mm_get_block_tag(void *ptr) {
+    if (!ptr) return MM_TAG_GENERAL;
+    return (MM_Tag)block_info(ptr)->tag;
+}
 
 
 // Получить сколько всего используется памяти в килобайтах этим менеджером памяти:
@@ -62,59 +370,92 @@ double mm_get_used_size_gb() { return mm_get_used_size() / 1024.0 / 1024.0 / 102
 // Получить размер блока в байтах:
 size_t mm_get_block_size(void *ptr) {
     if (!ptr) return 0;
-    return *(size_t*)((char*)ptr - _header_size);
+    return block_info(ptr)->size;
 }
 
 
 // Добавить байты к использованной памяти (атомарно):
 void mm_used_size_add(size_t size) {
-    atomic_fetch_add(&mm_used_size, size);
+    shard_grow(stats_shard(), size);
 }
 
 
 // Вычесть байты из использованной памяти (атомарно):
 void mm_used_size_sub(size_t size) {
-    atomic_fetch_sub(&mm_used_size, size);
+    shard_add(&stats_shard()->used, (size_t)0 - size);
 }
 
 
 // Выделение памяти:
-void* mm_alloc(size_t size) {
-    // Выделяем с запасом под данные размера блока с учетом выравнивания:
-    // [размер блока в size_t|сам блок] <- весь блок.
-    // ptr = (void*)(raw_ptr + _header_size) -> получить сам блок.
-    // raw_ptr = (void*)(ptr - _header_size) -> получить весь блок.
-    char *raw_ptr = _m_alloc(_header_size + size);
-    if (!raw_ptr) { mm_alloc_error(); return NULL; }
-    *(size_t*)raw_ptr = size;  // Сохраняем размер.
-    void *ptr = raw_ptr + _header_size;
-    mm_used_size_add(mm_get_block_size(ptr));
-    mm_total_allocated_blocks++;
-    return ptr;
+void* (mm_alloc)(size_t size) {
+    return block_alloc(size, 0, MM_TAG_GENERAL, NULL, 0, false);
 }
 
 
 // Выделение памяти с обнулением:
-void* mm_calloc(size_t count, size_t size) {
-    char *raw_ptr = _m_calloc(1, _header_size + count * size);
-    if (!raw_ptr){ mm_alloc_error(); return NULL; }
-    *(size_t*)raw_ptr = count * size;  // Сохраняем размер.
-    void *ptr = raw_ptr + _header_size;
-    mm_used_size_add(mm_get_block_size(ptr));
-    mm_total_allocated_blocks++;
-    return ptr;
+void* (mm_calloc)(size_t count, size_t size) {
+    return block_alloc(count * size, 0, MM_TAG_GENERAL, NULL, 0, true);
+}
+
+
+// Выделение памяти с тегом и местом выделения (используйте макросы mm_alloc_tagged/mm_calloc_tagged):
+void* mm_alloc_at(size_t size, MM_Tag tag, const char *file, int line) {
+    return block_alloc(size, 0, tag, file, line, false);
+}
+
+
+// Выделение памяти с обнулением с тегом и местом выделения:
+void* mm_calloc_at(size_t count, size_t size, MM_Tag tag, const char *file, int line) {
+    return block_alloc(count * size, 0, tag, file, line, true);
+}
+
+
+// Выделение памяти с выравниванием (степень двойки, например 16/32/64 для SIMD и строк кэша):
+void* mm_alloc_aligned(size_t size, size_t alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment > MM_MAX_ALIGNMENT) {
+        fprintf(stderr, "mm_alloc_aligned: Alignment %zu is not a power of two up to %d.\n", alignment, MM_MAX_ALIGNMENT);
+        return NULL;
+    }
+    return block_alloc(size, alignment, MM_TAG_GENERAL, NULL, 0, false);
 }
 
 
-// Расширение блока памяти:
+// Расширение блока памяти (тег блока сохраняется):
 void* mm_realloc(void *ptr, size_t new_size) {
     if (!ptr) return mm_alloc(new_size);  // Если NULL -> обычный alloc.
-    void *raw_ptr = (char*)ptr - _header_size;
-    void *new_raw_ptr = _m_realloc(raw_ptr, _header_size + new_size);
+    MM_BlockInfo *info = block_info(ptr);
+    size_t old_size = info->size;
+    MM_Tag tag = (MM_Tag)info->tag;
+    uint32_t sample = info->sample;
+
+    // Выровненный блок переносим вручную, чтобы сохранить выравнивание:
+    if (info->align_shift) {
+        void *new_ptr = block_alloc(new_size, block_align(info), tag, NULL, 0, false);
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+        if (sample) {
+            // Сэмпл переезжает вместе с данными:
+            mm_profiler_release(block_info(new_ptr)->sample, new_ptr);
+            mm_profiler_update(sample, ptr, new_ptr, new_size);
+            block_info(new_ptr)->sample = sample;
+            info->sample = 0;
+        }
+        mm_free(ptr);
+        return new_ptr;
+    }
+
+    char *raw_ptr = (char*)ptr - info->offset;
+    char *new_raw_ptr = _m_realloc(raw_ptr, block_raw_size(old_size, 0), block_raw_size(new_size, 0));
     if (!new_raw_ptr) { mm_alloc_error(); return NULL; }
-    mm_used_size_add(new_size - *(size_t*)new_raw_ptr);
-    *(size_t*)new_raw_ptr = new_size;
-    return (char*)new_raw_ptr + _header_size;
+    void *new_ptr = new_raw_ptr + _header_size;
+    block_info(new_ptr)->size = new_size;
+    if (sample) mm_profiler_update(sample, ptr, new_ptr, new_size);
+    MM_StatsShard *shard = stats_shard();
+    if (new_size > old_size) shard_grow(shard, new_size - old_size);
+    else shard_add(&shard->used, new_size - old_size);
+    shard_add(&shard->tag_used[tag], new_size - old_size);
+    shard_add(&shard->allocs, 1);
+    shard_add(&shard->alloc_size, new_size);
+    return new_ptr;
 }
 
 
@@ -132,9 +473,16 @@ char* mm_strdup(const char *str) {
 // Освобождение памяти:
 void mm_free(void *ptr) {
     if (!ptr) return;
-    mm_used_size_sub(mm_get_block_size(ptr));
-    mm_total_allocated_blocks--;
-    _m_free((char*)ptr - _header_size);
+    MM_BlockInfo *info = block_info(ptr);
+    size_t raw_size = block_raw_size(info->size, block_align(info));
+    if (info->sample) mm_profiler_release(info->sample, ptr);
+    MM_StatsShard *shard = stats_shard();
+    shard_add(&shard->used, (size_t)0 - info->size);
+    shard_add(&shard->overhead, (size_t)0 - (raw_size - info->size));
+    shard_add(&shard->blocks, (size_t)0 - 1);
+    shard_add(&shard->tag_used[info->tag], (size_t)0 - info->size);
+    shard_add(&shard->tag_blocks[info->tag], (size_t)0 - 1);
+    _m_free((char*)ptr - info->offset, raw_size);
 }
 
 
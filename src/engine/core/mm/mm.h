@@ -8,20 +8,93 @@
 // Подключаем:
 #include <stddef.h>
 #include <stdlib.h>
+#include <stdbool.h>
 
 
+// Определения:
+// Определите MM_COMPACT_HEADER при сборке, чтобы заголовок блока занимал 16 байт вместо 64.
+// Определите MM_PROFILE_SITES при сборке, чтобы профайлер знал места выделения и для mm_alloc/mm_calloc.
+#define MM_BASE_ALIGNMENT 16     // Выравнивание блоков без явного указания выравнивания.
+#define MM_MAX_ALIGNMENT  32768  // Максимальное выравнивание для mm_alloc_aligned.
+
+
+// Виды бэкендов аллокатора:
+typedef enum MM_Backend {
+    MM_BACKEND_MALLOC,  // Базовый malloc/free.
+    MM_BACKEND_SLAB,    // Slab-аллокатор с классами размеров и кэшами потоков (см. slab.h).
+} MM_Backend;
+
+
+// Теги памяти (раздельный учёт и бюджеты для подсистем):
+typedef enum MM_Tag {
+    MM_TAG_GENERAL,   // Всё остальное.
+    MM_TAG_TEXTURE,   // Текстуры.
+    MM_TAG_SHADER,    // Шейдеры и их кэши.
+    MM_TAG_IMAGE,     // Изображения (пиксели на стороне процессора).
+    MM_TAG_DARRAY,    // Динамические массивы.
+    MM_TAG_RENDERER,  // Рендерер.
+    MM_TAG_WINDOW,    // Окно.
+    MM_TAG_INPUT,     // Ввод.
+    MM_TAG_PHYSICS,   // Физика.
+    MM_TAG_FRAME,     // Кадровый аллокатор.
+    MM_TAG_COUNT      // Количество тегов.
+} MM_Tag;
+
+
+// Установить бэкенд аллокатора (можно только пока нет выделенных блоков):
+bool mm_set_backend(MM_Backend backend);
+
+// Получить текущий бэкенд аллокатора:
+MM_Backend mm_get_backend();
+
+// Вызовите перед завершением рабочего потока, чтобы вернуть его кэш памяти в общий доступ:
+void mm_thread_release();
+
 // Получить размер заголовка блока в байтах:
 size_t mm_get_block_header_size();
 
 // Получить количество выделенных блоков:
 size_t mm_get_total_allocated_blocks();
 
-// Получить абсолютный размер используемой памяти в байтах с учётом заголовков блоков:
+// Получить абсолютный размер используемой памяти в байтах с учётом заголовков блоков и выравнивания:
 size_t mm_get_absolute_used_size();
 
 // Получить сколько всего используется памяти в байтах этим менеджером памяти:
 size_t mm_get_used_size();
 
+// Получить пиковое использование памяти в байтах (включая пики внутри кадра, см. mm_stats_next_frame):
+size_t mm_get_peak_used_size();
+
+// Получить сколько всего было выделений памяти:
+size_t mm_get_total_allocs();
+
+// Получить количество выделений памяти за прошлый кадр:
+size_t mm_get_frame_allocs();
+
+// Получить сколько байт было выделено за прошлый кадр:
+size_t mm_get_frame_alloc_size();
+
+// Подвести статистику памяти за кадр и проверить бюджеты тегов (вызывается автоматически в цикле окна):
+void mm_stats_next_frame();
+
+// Получить название тега:
+const char* mm_get_tag_name(MM_Tag tag);
+
+// Получить сколько памяти в байтах используется под тег:
+size_t mm_get_tag_used_size(MM_Tag tag);
+
+// Получить количество выделенных блоков с тегом:
+size_t mm_get_tag_blocks(MM_Tag tag);
+
+// Установить бюджет тега в байтах (0 - без ограничения). При превышении выводится предупреждение:
+void mm_set_tag_budget(MM_Tag tag, size_t budget);
+
+// Получить бюджет тега в байтах (0 - без ограничения):
+size_t mm_get_tag_budget(MM_Tag tag);
+
+// Получить тег блока:
+MM_Tag mm_get_block_tag(void *ptr);
+
 // Получить сколько всего используется памяти в килобайтах этим менеджером памяти:
 double mm_get_used_size_kb();
 
@@ -46,7 +119,23 @@ void* mm_alloc(size_t size);
 // Выделение памяти с обнулением:
 void* mm_calloc(size_t count, size_t size);
 
-// Расширение блока памяти:
+// Выделение памяти с тегом и местом выделения (используйте макросы mm_alloc_tagged/mm_calloc_tagged):
+void* mm_alloc_at(size_t size, MM_Tag tag, const char *file, int line);
+
+// Выделение памяти с обнулением с тегом и местом выделения:
+void* mm_calloc_at(size_t count, size_t size, MM_Tag tag, const char *file, int line);
+
+// Выделение памяти с тегом (место выделения запоминается для профайлера):
+#define mm_alloc_tagged(size, tag) mm_alloc_at((size), (tag), __FILE__, __LINE__)
+
+// Выделение памяти с обнулением с тегом (место выделения запоминается для профайлера):
+#define mm_calloc_tagged(count, size, tag) mm_calloc_at((count), (size), (tag), __FILE__, __LINE__)
+
+// Выделение памяти с выравниванием (степень двойки, например 16/32/64 для SIMD и строк кэша).
+// Освобождается обычным mm_free, mm_realloc сохраняет выравнивание:
+void* mm_alloc_aligned(size_t size, size_t alignment);
+
+// Расширение блока памяти (тег блока сохраняется):
 void* mm_realloc(void *ptr, size_t new_size);
 
 // Копирование строки:
@@ -57,3 +146,10 @@ void mm_free(void *ptr);
 
 // Вызовите если получите проблему при выделении памяти:
 void mm_alloc_error();
+
+
+// Запоминаем места выделения и для обычных функций:
+#ifdef MM_PROFILE_SITES
+    #define mm_alloc(size) mm_alloc_at((size), MM_TAG_GENERAL, __FILE__, __LINE__)
+    #define mm_calloc(count, size) mm_calloc_at((count), (size), MM_TAG_GENERAL, __FILE__, __LINE__)
+#endif
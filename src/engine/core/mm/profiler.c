@@ -0,0 +1,251 @@
+//
+// profiler.c - Сэмплирующий профайлер кучи для mm (места выделения памяти).
+//
+// У каждого потока есть свой счётчик байт до следующего сэмпла, так что на обычном
+// пути выделения памяти нет ни блокировок, ни общих переменных. Интервал между
+// сэмплами случайный (в среднем равен частоте), чтобы не "попадать в такт" с
+// повторяющимися выделениями. Каждый сэмпл представляет примерно "частоту" байт,
+// поэтому в отчёте выводится оценка объёма памяти по месту выделения.
+//
+// Номер сэмпла хранится в заголовке блока, так что при освобождении блока сэмпл
+// помечается как освобождённый за O(1). Если сэмпл уже вытеснен из кольцевого
+// буфера - освобождение просто игнорируется.
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "mm.h"
+#include "profiler.h"
+
+
+// Сэмпл выделения памяти:
+typedef struct MM_ProfSample {
+    const char *file;  // Файл места выделения (NULL - неизвестно).
+    int line;          // Строка места выделения.
+    uint8_t tag;       // Тег блока.
+    bool live;         // Блок ещё не освобождён.
+    size_t size;       // Размер блока.
+    size_t rate;       // Частота сэмплирования на момент записи.
+    void *ptr;         // Указатель на блок.
+} MM_ProfSample;
+
+
+// Место выделения памяти в отчёте:
+typedef struct MM_ProfSite {
+    const char *file;
+    int line;
+    uint8_t tag;
+    size_t samples;       // Количество сэмплов.
+    size_t live_samples;  // Количество не освобождённых сэмплов.
+    size_t bytes;         // Оценка выделенных байт.
+    size_t live_bytes;    // Оценка используемых байт.
+} MM_ProfSite;
+
+
+// Состояние профайлера:
+static MM_ProfSample prof_ring[MM_PROFILER_RING_SIZE];  // Кольцевой буфер сэмплов.
+static size_t prof_next = 0;                             // Сколько всего записано сэмплов.
+static atomic_flag prof_lock = ATOMIC_FLAG_INIT;         // Спинлок кольцевого буфера.
+static atomic_size_t prof_rate = 0;                      // Частота сэмплирования (0 - выключен).
+static _Thread_local size_t prof_countdown = 0;          // Сколько байт осталось до следующего сэмпла.
+static _Thread_local uint32_t prof_seed = 0;             // Состояние генератора случайных чисел потока.
+
+
+// Захват и освобождение спинлока:
+static inline void prof_lock_acquire() {
+    while (atomic_flag_test_and_set_explicit(&prof_lock, memory_order_acquire));
+}
+
+static inline void prof_lock_release() {
+    atomic_flag_clear_explicit(&prof_lock, memory_order_release);
+}
+
+
+// Случайный интервал до следующего сэмпла (от rate/2 до rate*3/2):
+static size_t prof_next_interval(size_t rate) {
+    if (!prof_seed) prof_seed = (uint32_t)(uintptr_t)&prof_seed | 1;
+    prof_seed ^= prof_seed << 13;  // xorshift32.
+    prof_seed ^= prof_seed >> 17;
+    prof_seed ^= prof_seed << 5;
+    size_t interval = rate / 2 + (size_t)prof_seed % (rate + 1);
+    return interval ? interval : 1;
+}
+
+
+// Установить частоту сэмплирования в байтах (0 - профайлер выключен):
+void mm_profiler_set_rate(size_t bytes) {
+    atomic_store(&prof_rate, bytes);
+}
+
+
+// Получить частоту сэмплирования в байтах:
+size_t mm_profiler_get_rate() {
+    return atomic_load(&prof_rate);
+}
+
+
+// Очистить все сэмплы:
+void mm_profiler_clear() {
+    prof_lock_acquire();
+    memset(prof_ring, 0, sizeof(prof_ring));
+    prof_next = 0;
+    prof_lock_release();
+}
+
+
+// Учесть выделение в счётчике сэмплирования. Возвращает true если это выделение надо записать:
+bool mm_profiler_tick(size_t size) {
+    size_t rate = atomic_load_explicit(&prof_rate, memory_order_relaxed);
+    if (!rate) return false;
+    if (!prof_countdown) prof_countdown = prof_next_interval(rate);
+    if (prof_countdown > size) {
+        prof_countdown -= size;
+        return false;
+    }
+    prof_countdown = prof_next_interval(rate);
+    return true;
+}
+
+
+// Записать сэмпл выделения. Возвращает номер сэмпла для заголовка блока (0 - не записан):
+uint32_t mm_profiler_record(void *ptr, size_t size, uint8_t tag, const char *file, int line) {
+    size_t rate = atomic_load_explicit(&prof_rate, memory_order_relaxed);
+    prof_lock_acquire();
+    size_t index = prof_next++ % MM_PROFILER_RING_SIZE;
+    prof_ring[index] = (MM_ProfSample){
+        .file = file,
+        .line = line,
+        .tag = tag,
+        .live = true,
+        .size = size,
+        .rate = rate,
+        .ptr = ptr,
+    };
+    prof_lock_release();
+    return (uint32_t)index + 1;
+}
+
+
+// Блок с сэмплом перемещён или изменил размер:
+void mm_profiler_update(uint32_t sample, void *old_ptr, void *new_ptr, size_t new_size) {
+    if (!sample || sample > MM_PROFILER_RING_SIZE) return;
+    prof_lock_acquire();
+    MM_ProfSample *s = &prof_ring[sample - 1];
+    if (s->live && s->ptr == old_ptr) {
+        s->size = new_size;
+        s->ptr = new_ptr;
+    }
+    prof_lock_release();
+}
+
+
+// Блок с сэмплом освобождён:
+void mm_profiler_release(uint32_t sample, void *ptr) {
+    if (!sample || sample > MM_PROFILER_RING_SIZE) return;
+    prof_lock_acquire();
+    MM_ProfSample *s = &prof_ring[sample - 1];
+    if (s->live && s->ptr == ptr) s->live = false;
+    prof_lock_release();
+}
+
+
+// Сколько байт представляет сэмпл:
+static inline size_t prof_sample_weight(const MM_ProfSample *s) {
+    return s->size > s->rate ? s->size : s->rate;
+}
+
+
+// Сравнение сэмплов по месту выделения (для группировки):
+static int prof_compare_samples(const void *a, const void *b) {
+    const MM_ProfSample *sa = a, *sb = b;
+    if (sa->file != sb->file) {
+        if (!sa->file) return -1;
+        if (!sb->file) return 1;
+        int cmp = strcmp(sa->file, sb->file);
+        if (cmp) return cmp;
+    }
+    if (sa->line != sb->line) return sa->line < sb->line ? -1 : 1;
+    return (int)sa->tag - (int)sb->tag;
+}
+
+
+// Сравнение мест выделения по используемой памяти (по убыванию):
+static int prof_compare_sites(const void *a, const void *b) {
+    const MM_ProfSite *sa = a, *sb = b;
+    if (sa->live_bytes != sb->live_bytes) return sa->live_bytes < sb->live_bytes ? 1 : -1;
+    if (sa->bytes != sb->bytes) return sa->bytes < sb->bytes ? 1 : -1;
+    return 0;
+}
+
+
+// Вывести отчёт по тегам и местам выделения памяти:
+void mm_profiler_report(FILE *out) {
+    if (!out) return;
+
+    // Отчёт по тегам:
+    fprintf(out, "\n---------------- MM report ----------------\n");
+    fprintf(out, "Memory used: %zu b, blocks: %zu, peak: %zu b.\n",
+            mm_get_used_size(), mm_get_total_allocated_blocks(), mm_get_peak_used_size());
+    fprintf(out, "%-10s %14s %10s %14s\n", "Tag", "Used (b)", "Blocks", "Budget (b)");
+    for (int tag = 0; tag < MM_TAG_COUNT; tag++) {
+        size_t budget = mm_get_tag_budget(tag);
+        fprintf(out, "%-10s %14zu %10zu ", mm_get_tag_name(tag), mm_get_tag_used_size(tag), mm_get_tag_blocks(tag));
+        if (budget) fprintf(out, "%14zu%s\n", budget, mm_get_tag_used_size(tag) > budget ? " (over budget!)" : "");
+        else fprintf(out, "%14s\n", "-");
+    }
+
+    // Копируем сэмплы, чтобы не держать блокировку во время сортировки и вывода.
+    // Временная память берётся напрямую из malloc, чтобы отчёт не влиял на статистику:
+    size_t rate = mm_profiler_get_rate();
+    MM_ProfSample *samples = malloc(sizeof(prof_ring));
+    MM_ProfSite *sites = malloc(sizeof(MM_ProfSite) * MM_PROFILER_RING_SIZE);
+    if (!samples || !sites) {
+        free(samples);
+        free(sites);
+        fprintf(out, "mm_profiler_report: Not enough memory for the site report.\n");
+        return;
+    }
+    prof_lock_acquire();
+    size_t count = prof_next < MM_PROFILER_RING_SIZE ? prof_next : MM_PROFILER_RING_SIZE;
+    size_t total = prof_next;
+    memcpy(samples, prof_ring, sizeof(MM_ProfSample) * count);
+    prof_lock_release();
+
+    // Группируем сэмплы по месту выделения:
+    qsort(samples, count, sizeof(MM_ProfSample), prof_compare_samples);
+    size_t site_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        MM_ProfSample *s = &samples[i];
+        if (i == 0 || prof_compare_samples(s, &samples[i - 1]) != 0) {
+            sites[site_count++] = (MM_ProfSite){ .file = s->file, .line = s->line, .tag = s->tag };
+        }
+        MM_ProfSite *site = &sites[site_count - 1];
+        site->samples++;
+        site->bytes += prof_sample_weight(s);
+        if (s->live) {
+            site->live_samples++;
+            site->live_bytes += prof_sample_weight(s);
+        }
+    }
+    qsort(sites, site_count, sizeof(MM_ProfSite), prof_compare_sites);
+
+    // Отчёт по местам выделения:
+    fprintf(out, "\nSampled sites (rate: %zu b, samples: %zu of %zu total):\n", rate, count, total);
+    if (site_count) fprintf(out, "%14s %14s %8s  %-10s %s\n", "Live (~b)", "Total (~b)", "Samples", "Tag", "Site");
+    for (size_t i = 0; i < site_count; i++) {
+        MM_ProfSite *site = &sites[i];
+        fprintf(out, "%14zu %14zu %8zu  %-10s %s:%d\n", site->live_bytes, site->bytes, site->samples,
+                mm_get_tag_name(site->tag), site->file ? site->file : "(unknown)", site->line);
+    }
+    fprintf(out, "-------------------------------------------\n\n");
+
+    free(samples);
+    free(sites);
+}
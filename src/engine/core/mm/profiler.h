@@ -0,0 +1,51 @@
+//
+// profiler.h - Сэмплирующий профайлер кучи для mm (места выделения памяти).
+//
+// Профайлер записывает примерно одно выделение на каждые N выделенных байт (N - частота
+// сэмплирования) в кольцевой буфер фиксированного размера: файл, строку, тег и размер.
+// Так его можно держать включённым даже в релизе. Место выделения известно для
+// mm_alloc_tagged/mm_calloc_tagged всегда, а для mm_alloc/mm_calloc - только при сборке
+// с определением MM_PROFILE_SITES.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// Определения:
+#define MM_PROFILER_RING_SIZE    4096          // Сколько последних сэмплов хранится в кольцевом буфере.
+#define MM_PROFILER_DEFAULT_RATE (512 * 1024)  // Частота сэмплирования по умолчанию (в среднем 1 сэмпл на 512 кб).
+
+
+// Установить частоту сэмплирования в байтах (0 - профайлер выключен):
+void mm_profiler_set_rate(size_t bytes);
+
+// Получить частоту сэмплирования в байтах:
+size_t mm_profiler_get_rate();
+
+// Очистить все сэмплы:
+void mm_profiler_clear();
+
+// Вывести отчёт по тегам и местам выделения памяти:
+void mm_profiler_report(FILE *out);
+
+
+// Внутренние функции (используются в mm.c):
+
+// Учесть выделение в счётчике сэмплирования. Возвращает true если это выделение надо записать:
+bool mm_profiler_tick(size_t size);
+
+// Записать сэмпл выделения. Возвращает номер сэмпла для заголовка блока (0 - не записан):
+uint32_t mm_profiler_record(void *ptr, size_t size, uint8_t tag, const char *file, int line);
+
+// Блок с сэмплом перемещён или изменил размер:
+void mm_profiler_update(uint32_t sample, void *old_ptr, void *new_ptr, size_t new_size);
+
+// Блок с сэмплом освобождён:
+void mm_profiler_release(uint32_t sample, void *ptr);
@@ -0,0 +1,236 @@
+//
+// slab.c - Slab-аллокатор с классами размеров и кэшами потоков (бэкенд для mm).
+//
+// Мелкие блоки (до SLAB_MAX_SIZE) округляются до класса размера и берутся из
+// списка свободных блоков этого класса в кэше текущего потока (без блокировок).
+// Когда в кэше потока скапливается много свободных блоков, пачка из них уходит
+// в центральное депо, откуда её заберёт любой другой поток. Так освобождение
+// блока в чужом потоке тоже работает: блок просто попадает в кэш того потока,
+// который его освободил, а излишки возвращаются в депо. Если и в депо пусто -
+// нарезаем новый кусок памяти (span) на блоки класса.
+//
+// Крупные блоки (больше SLAB_MAX_SIZE) выделяются обычным malloc.
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "slab.h"
+
+
+// Узел списка свободных блоков (хранится прямо внутри свободного блока):
+typedef struct SlabNode {
+    struct SlabNode *next;        // Следующий свободный блок.
+    struct SlabNode *next_batch;  // Следующая пачка в депо (только у первого блока пачки).
+    size_t count;                 // Количество блоков в пачке (только у первого блока пачки).
+} SlabNode;
+
+
+// Корзина кэша потока для одного класса:
+typedef struct SlabCacheBin {
+    SlabNode *head;  // Список свободных блоков.
+    size_t count;    // Количество блоков в списке.
+} SlabCacheBin;
+
+
+// Центральное депо одного класса:
+typedef struct SlabDepot {
+    atomic_flag lock;  // Спинлок депо.
+    SlabNode *batches; // Стек пачек свободных блоков.
+} SlabDepot;
+
+
+// Кэши текущего потока и центральные депо:
+static _Thread_local SlabCacheBin slab_tcache[SLAB_CLASS_COUNT];
+static SlabDepot slab_depots[SLAB_CLASS_COUNT];
+static atomic_size_t slab_reserved_size = 0;
+
+
+// Индекс старшего бита:
+static inline size_t slab_log2(size_t x) {
+    #if defined(__GNUC__) || defined(__clang__)
+        return (sizeof(unsigned long long) * 8 - 1) - (size_t)__builtin_clzll((unsigned long long)x);
+    #else
+        size_t p = 0;
+        while (x >>= 1) p++;
+        return p;
+    #endif
+}
+
+
+// Получить индекс класса по размеру:
+// До 128 байт - шаг 16 байт. Дальше - 4 класса на каждую степень двойки.
+static inline size_t slab_class_index(size_t size) {
+    if (size <= 128) return size <= SLAB_MIN_SIZE ? 0 : (size + 15) / 16 - 2;
+    size_t p = slab_log2(size - 1);
+    size_t sub = ((size - 1) >> (p - 2)) & 3;
+    return 7 + (p - 7) * 4 + sub;
+}
+
+
+// Получить размер блока класса:
+static inline size_t slab_class_size(size_t index) {
+    if (index < 7) return SLAB_MIN_SIZE + index * 16;
+    size_t p = 7 + (index - 7) / 4;
+    size_t sub = (index - 7) % 4;
+    return ((size_t)1 << p) + (sub + 1) * ((size_t)1 << (p - 2));
+}
+
+
+// Захват и освобождение спинлока депо:
+static inline void slab_depot_lock(SlabDepot *depot) {
+    while (atomic_flag_test_and_set_explicit(&depot->lock, memory_order_acquire));
+}
+
+static inline void slab_depot_unlock(SlabDepot *depot) {
+    atomic_flag_clear_explicit(&depot->lock, memory_order_release);
+}
+
+
+// Положить пачку блоков в депо:
+static void slab_depot_push(size_t index, SlabNode *batch, size_t count) {
+    SlabDepot *depot = &slab_depots[index];
+    batch->count = count;
+    slab_depot_lock(depot);
+    batch->next_batch = depot->batches;
+    depot->batches = batch;
+    slab_depot_unlock(depot);
+}
+
+
+// Забрать пачку блоков из депо (или NULL если пусто):
+static SlabNode* slab_depot_pop(size_t index) {
+    SlabDepot *depot = &slab_depots[index];
+    slab_depot_lock(depot);
+    SlabNode *batch = depot->batches;
+    if (batch) depot->batches = batch->next_batch;
+    slab_depot_unlock(depot);
+    return batch;
+}
+
+
+// Нарезать новый кусок памяти на блоки класса и положить их в кэш потока:
+static bool slab_carve_span(size_t index, SlabCacheBin *bin) {
+    size_t block_size = slab_class_size(index);
+    size_t span_size = block_size * 8 > SLAB_SPAN_SIZE ? block_size * 8 : SLAB_SPAN_SIZE;
+    size_t count = span_size / block_size;
+
+    char *span = malloc(span_size);
+    if (!span) return false;
+    atomic_fetch_add(&slab_reserved_size, span_size);
+
+    // Связываем блоки в список (в порядке адресов, для локальности):
+    for (size_t i = 0; i < count; i++) {
+        SlabNode *node = (SlabNode*)(span + i * block_size);
+        node->next = (i + 1 < count) ? (SlabNode*)(span + (i + 1) * block_size) : bin->head;
+    }
+    bin->head = (SlabNode*)span;
+    bin->count += count;
+    return true;
+}
+
+
+// Выделение памяти:
+void* slab_alloc(size_t size) {
+    if (size > SLAB_MAX_SIZE) return malloc(size);
+
+    size_t index = slab_class_index(size);
+    SlabCacheBin *bin = &slab_tcache[index];
+
+    // Если кэш потока пуст - берём пачку из депо, а если и там пусто - нарезаем новый кусок:
+    if (!bin->head) {
+        SlabNode *batch = slab_depot_pop(index);
+        if (batch) {
+            bin->head = batch;
+            bin->count = batch->count;
+        } else if (!slab_carve_span(index, bin)) {
+            return NULL;
+        }
+    }
+
+    SlabNode *node = bin->head;
+    bin->head = node->next;
+    bin->count--;
+    return node;
+}
+
+
+// Выделение памяти с обнулением:
+void* slab_calloc(size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;  // Переполнение count * size.
+    size_t total = count * size;
+    if (total > SLAB_MAX_SIZE) return calloc(count, size);
+    void *ptr = slab_alloc(total);
+    if (ptr) memset(ptr, 0, total);
+    return ptr;
+}
+
+
+// Расширение блока памяти (нужен старый размер блока):
+void* slab_realloc(void *ptr, size_t old_size, size_t new_size) {
+    if (!ptr) return slab_alloc(new_size);
+
+    // Оба блока крупные - обычный realloc:
+    if (old_size > SLAB_MAX_SIZE && new_size > SLAB_MAX_SIZE) return realloc(ptr, new_size);
+
+    // Новый размер влезает в тот же класс - ничего не делаем:
+    if (old_size <= SLAB_MAX_SIZE && new_size <= SLAB_MAX_SIZE &&
+        slab_class_index(old_size) == slab_class_index(new_size)) return ptr;
+
+    // Иначе переносим данные в новый блок:
+    void *new_ptr = slab_alloc(new_size);
+    if (!new_ptr) return NULL;
+    memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    slab_free(ptr, old_size);
+    return new_ptr;
+}
+
+
+// Освобождение памяти (нужен размер блока):
+void slab_free(void *ptr, size_t size) {
+    if (!ptr) return;
+    if (size > SLAB_MAX_SIZE) { free(ptr); return; }
+
+    size_t index = slab_class_index(size);
+    SlabCacheBin *bin = &slab_tcache[index];
+
+    SlabNode *node = (SlabNode*)ptr;
+    node->next = bin->head;
+    bin->head = node;
+    bin->count++;
+
+    // Если в кэше потока скопилось слишком много блоков - отдаём пачку в депо:
+    if (bin->count >= SLAB_BATCH * 2) {
+        SlabNode *batch = bin->head;
+        SlabNode *last = batch;
+        for (size_t i = 1; i < SLAB_BATCH; i++) last = last->next;
+        bin->head = last->next;
+        bin->count -= SLAB_BATCH;
+        last->next = NULL;
+        slab_depot_push(index, batch, SLAB_BATCH);
+    }
+}
+
+
+// Вернуть все свободные блоки кэша текущего потока в центральное депо:
+void slab_thread_release() {
+    for (size_t i = 0; i < SLAB_CLASS_COUNT; i++) {
+        SlabCacheBin *bin = &slab_tcache[i];
+        if (!bin->head) continue;
+        slab_depot_push(i, bin->head, bin->count);
+        bin->head = NULL;
+        bin->count = 0;
+    }
+}
+
+
+// Получить сколько памяти в байтах зарезервировано под слэбы:
+size_t slab_get_reserved_size() {
+    return atomic_load(&slab_reserved_size);
+}
@@ -0,0 +1,37 @@
+//
+// slab.h - Slab-аллокатор с классами размеров и кэшами потоков (бэкенд для mm).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+
+
+// Определения:
+#define SLAB_MIN_SIZE    32        // Минимальный класс размера в байтах.
+#define SLAB_MAX_SIZE    32768     // Максимальный класс размера. Всё что больше - уходит в malloc.
+#define SLAB_CLASS_COUNT 39        // Количество классов размеров.
+#define SLAB_SPAN_SIZE   65536     // Минимальный размер куска памяти, который нарезается на блоки.
+#define SLAB_BATCH       64        // Сколько блоков передаётся между кэшем потока и центральным депо за раз.
+
+
+// Выделение памяти:
+void* slab_alloc(size_t size);
+
+// Выделение памяти с обнулением:
+void* slab_calloc(size_t count, size_t size);
+
+// Расширение блока памяти (нужен старый размер блока):
+void* slab_realloc(void *ptr, size_t old_size, size_t new_size);
+
+// Освобождение памяти (нужен размер блока):
+void slab_free(void *ptr, size_t size);
+
+// Вернуть все свободные блоки кэша текущего потока в центральное депо.
+// Вызывайте перед завершением рабочего потока, иначе его кэш будет потерян:
+void slab_thread_release();
+
+// Получить сколько памяти в байтах зарезервировано под слэбы:
+size_t slab_get_reserved_size();
@@ -0,0 +1,181 @@
+//
+// vm.c - Арены виртуальной памяти (резервирование адресов и подтверждение страниц по требованию).
+//
+// Windows: VirtualAlloc(MEM_RESERVE) + VirtualAlloc(MEM_COMMIT).
+// POSIX: mmap(PROT_NONE) + mprotect(PROT_READ | PROT_WRITE). Система выделит физическую
+// страницу только при первом обращении к ней, а возвращаются страницы через madvise.
+//
+
+
+// Подключаем:
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #define _DEFAULT_SOURCE
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "mm.h"
+#include "vm.h"
+
+
+// Сколько всего подтверждено памяти во всех аренах:
+static atomic_size_t mm_vm_committed_size = 0;
+
+
+// Выровнять размер по странице:
+static inline size_t page_align_up(size_t size) {
+    size_t page = mm_vm_get_page_size();
+    return (size + page - 1) & ~(page - 1);
+}
+
+
+// Зарезервировать диапазон адресов (без физической памяти):
+static void* vm_reserve(size_t size) {
+    #ifdef _WIN32
+        return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+    #else
+        void *ptr = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return ptr == MAP_FAILED ? NULL : ptr;
+    #endif
+}
+
+
+// Вернуть диапазон адресов системе:
+static void vm_release(void *ptr, size_t size) {
+    #ifdef _WIN32
+        (void)size;
+        VirtualFree(ptr, 0, MEM_RELEASE);
+    #else
+        munmap(ptr, size);
+    #endif
+}
+
+
+// Подтвердить страницы (сделать доступными для чтения и записи):
+static bool vm_commit(void *ptr, size_t size) {
+    #ifdef _WIN32
+        return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+    #else
+        return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+    #endif
+}
+
+
+// Вернуть физическую память страниц системе (адреса остаются зарезервированными):
+static void vm_decommit(void *ptr, size_t size) {
+    #ifdef _WIN32
+        VirtualFree(ptr, size, MEM_DECOMMIT);
+    #else
+        madvise(ptr, size, MADV_DONTNEED);
+        mprotect(ptr, size, PROT_NONE);
+    #endif
+}
+
+
+// Получить размер страницы памяти:
+size_t mm_vm_get_page_size() {
+    static size_t page_size = 0;
+    if (!page_size) {
+        #ifdef _WIN32
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            page_size = (size_t)info.dwPageSize;
+        #else
+            long size = sysconf(_SC_PAGESIZE);
+            page_size = size > 0 ? (size_t)size : 4096;
+        #endif
+    }
+    return page_size;
+}
+
+
+// Получить сколько всего подтверждено памяти во всех аренах в байтах:
+size_t mm_vm_get_committed_size() {
+    return atomic_load(&mm_vm_committed_size);
+}
+
+
+// Создать арену, зарезервировав диапазон адресов (округляется до страницы):
+MM_VMArena* mm_vm_create(size_t reserve_size) {
+    if (reserve_size == 0) return NULL;
+    reserve_size = page_align_up(reserve_size);
+
+    void *base = vm_reserve(reserve_size);
+    if (!base) {
+        fprintf(stderr, "mm_vm_create: Failed to reserve %zu bytes of address space.\n", reserve_size);
+        return NULL;
+    }
+
+    MM_VMArena *arena = (MM_VMArena*)mm_alloc(sizeof(MM_VMArena));
+    if (!arena) { vm_release(base, reserve_size); mm_alloc_error(); }
+    arena->base = (char*)base;
+    arena->reserved = reserve_size;
+    arena->committed = 0;
+    arena->used = 0;
+    return arena;
+}
+
+
+// Уничтожить арену и вернуть весь диапазон системе:
+void mm_vm_destroy(MM_VMArena **arena) {
+    if (!arena || !*arena) return;
+    mm_used_size_sub((*arena)->committed);
+    atomic_fetch_sub(&mm_vm_committed_size, (*arena)->committed);
+    vm_release((*arena)->base, (*arena)->reserved);
+    mm_free(*arena);
+    *arena = NULL;
+}
+
+
+// Подтвердить память так, чтобы было доступно хотя бы size байт от начала арены:
+bool mm_vm_commit(MM_VMArena *arena, size_t size) {
+    if (!arena) return false;
+    if (size <= arena->committed) return true;
+    if (size > arena->reserved) return false;
+
+    size_t new_committed = page_align_up(size);
+    size_t grow = new_committed - arena->committed;
+    if (!vm_commit(arena->base + arena->committed, grow)) return false;
+    mm_used_size_add(grow);
+    atomic_fetch_add(&mm_vm_committed_size, grow);
+    arena->committed = new_committed;
+    return true;
+}
+
+
+// Вернуть системе страницы после первых size байт (диапазон остаётся зарезервированным):
+void mm_vm_decommit(MM_VMArena *arena, size_t size) {
+    if (!arena) return;
+    size_t keep = page_align_up(size);
+    if (keep >= arena->committed) return;
+
+    size_t shrink = arena->committed - keep;
+    vm_decommit(arena->base + keep, shrink);
+    mm_used_size_sub(shrink);
+    atomic_fetch_sub(&mm_vm_committed_size, shrink);
+    arena->committed = keep;
+    if (arena->used > keep) arena->used = keep;
+}
+
+
+// Выделить память в конце арены (подтверждает страницы при необходимости, NULL если арена заполнена):
+void* mm_vm_push(MM_VMArena *arena, size_t size) {
+    if (!arena) return NULL;
+    size_t offset = (arena->used + MM_BASE_ALIGNMENT - 1) & ~(size_t)(MM_BASE_ALIGNMENT - 1);
+    if (offset + size > arena->reserved || !mm_vm_commit(arena, offset + size)) return NULL;
+    arena->used = offset + size;
+    return arena->base + offset;
+}
+
+
+// Сбросить занятую память арены (страницы остаются подтверждёнными):
+void mm_vm_reset(MM_VMArena *arena) {
+    if (!arena) return;
+    arena->used = 0;
+}
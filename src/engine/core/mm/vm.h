@@ -0,0 +1,53 @@
+//
+// vm.h - Арены виртуальной памяти (резервирование адресов и подтверждение страниц по требованию).
+//
+// Арена сразу резервирует большой диапазон адресов (физическая память при этом не
+// тратится), а страницы подтверждаются по мере роста. Данные арены никогда не
+// переезжают, поэтому указатели на них остаются стабильными, а рост не копирует память.
+// Подтверждённая память учитывается в mm (mm_get_used_size).
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdbool.h>
+
+
+// Объявление структур:
+typedef struct MM_VMArena MM_VMArena;
+
+
+// Арена виртуальной памяти:
+typedef struct MM_VMArena {
+    char *base;        // Начало зарезервированного диапазона.
+    size_t reserved;   // Сколько байт зарезервировано.
+    size_t committed;  // Сколько байт подтверждено (от начала диапазона).
+    size_t used;       // Сколько байт занято (для mm_vm_push).
+} MM_VMArena;
+
+
+// Получить размер страницы памяти:
+size_t mm_vm_get_page_size();
+
+// Получить сколько всего подтверждено памяти во всех аренах в байтах:
+size_t mm_vm_get_committed_size();
+
+// Создать арену, зарезервировав диапазон адресов (округляется до страницы):
+MM_VMArena* mm_vm_create(size_t reserve_size);
+
+// Уничтожить арену и вернуть весь диапазон системе:
+void mm_vm_destroy(MM_VMArena **arena);
+
+// Подтвердить память так, чтобы было доступно хотя бы size байт от начала арены:
+bool mm_vm_commit(MM_VMArena *arena, size_t size);
+
+// Вернуть системе страницы после первых size байт (диапазон остаётся зарезервированным):
+void mm_vm_decommit(MM_VMArena *arena, size_t size);
+
+// Выделить память в конце арены (подтверждает страницы при необходимости, NULL если арена заполнена):
+void* mm_vm_push(MM_VMArena *arena, size_t size);
+
+// Сбросить занятую память арены (страницы остаются подтверждёнными):
+void mm_vm_reset(MM_VMArena *arena);
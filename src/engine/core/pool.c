@@ -0,0 +1,222 @@
+//
+// pool.c - Пул объектов фиксированного размера с поколенными дескрипторами.
+//
+// Ячейка пула: [PoolSlot (8 байт)][объект]. Заголовок хранит индекс ячейки (чтобы
+// освобождать по указателю за O(1)) и поколение с флагом занятости. В свободной
+// ячейке на месте объекта лежит индекс следующей свободной ячейки.
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include "mm/mm.h"
+#include "pool.h"
+
+
+// Определения:
+#define POOL_SLOT_ALIVE      0x80000000u                                   // Флаг занятой ячейки.
+#define POOL_GEN_MASK        ((1u << (32 - OBJECTPOOL_INDEX_BITS)) - 1)  // Маска поколения.
+#define POOL_NO_FREE         UINT32_MAX                                    // Нет свободных ячеек.
+
+
+// Заголовок ячейки:
+typedef struct PoolSlot {
+    uint32_t index;  // Индекс ячейки.
+    uint32_t meta;   // Поколение (младшие биты) и флаг занятости.
+} PoolSlot;
+
+
+// Получить ячейку по индексу:
+static inline PoolSlot* pool_slot(ObjectPool *pool, size_t index) {
+    return (PoolSlot*)(pool->blocks[index / pool->block_count] + (index % pool->block_count) * pool->stride);
+}
+
+
+// Получить объект ячейки:
+static inline void* slot_object(PoolSlot *slot) {
+    return (char*)slot + sizeof(PoolSlot);
+}
+
+
+// Собрать дескриптор:
+static inline PoolHandle make_handle(uint32_t index, uint32_t meta) {
+    return ((meta & POOL_GEN_MASK) << OBJECTPOOL_INDEX_BITS) | index;
+}
+
+
+// Следующее поколение (пропускаем 0, чтобы дескриптор никогда не был равен OBJECTPOOL_INVALID_HANDLE):
+static inline uint32_t next_generation(uint32_t meta) {
+    uint32_t gen = ((meta & POOL_GEN_MASK) + 1) & POOL_GEN_MASK;
+    return gen ? gen : 1;
+}
+
+
+// Добавить новый блок ячеек:
+static bool pool_grow(ObjectPool *pool) {
+    if (pool->capacity + pool->block_count > OBJECTPOOL_MAX_OBJECTS) {
+        fprintf(stderr, "ObjectPool_alloc: Pool is full (max %u objects).\n", OBJECTPOOL_MAX_OBJECTS);
+        return false;
+    }
+
+    pool->blocks = mm_realloc(pool->blocks, sizeof(char*) * (pool->blocks_len + 1));
+    if (!pool->blocks) mm_alloc_error();
+    char *block = mm_alloc_tagged(pool->stride * pool->block_count, pool->tag);
+    if (!block) mm_alloc_error();
+    pool->blocks[pool->blocks_len++] = block;
+
+    // Связываем новые ячейки в список свободных (в порядке адресов):
+    size_t first = pool->capacity;
+    pool->capacity += pool->block_count;
+    for (size_t i = pool->capacity; i-- > first;) {
+        PoolSlot *slot = pool_slot(pool, i);
+        slot->index = (uint32_t)i;
+        slot->meta = 1;
+        *(uint32_t*)slot_object(slot) = pool->free_head;
+        pool->free_head = (uint32_t)i;
+    }
+    return true;
+}
+
+
+// Создать пул объектов (block_count - сколько объектов выделяется за раз, 0 - по умолчанию):
+ObjectPool* ObjectPool_create(size_t elem_size, size_t block_count) {
+    return ObjectPool_create_tagged(elem_size, block_count, MM_TAG_GENERAL);
+}
+
+
+// Создать пул объектов, блоки которого учитываются под тегом памяти tag:
+ObjectPool* ObjectPool_create_tagged(size_t elem_size, size_t block_count, MM_Tag tag) {
+    if (elem_size == 0) return NULL;
+    if (block_count == 0) block_count = OBJECTPOOL_DEFAULT_BLOCK_COUNT;
+
+    ObjectPool *pool = (ObjectPool*)mm_alloc(sizeof(ObjectPool));
+    if (!pool) mm_alloc_error();
+
+    // Ячейка выравнивается по 8 байт и вмещает индекс следующей свободной ячейки:
+    size_t size = elem_size < sizeof(uint32_t) ? sizeof(uint32_t) : elem_size;
+    pool->elem_size = elem_size;
+    pool->stride = (sizeof(PoolSlot) + size + 7) & ~(size_t)7;
+    pool->block_count = block_count;
+    pool->blocks = NULL;
+    pool->blocks_len = 0;
+    pool->capacity = 0;
+    pool->len = 0;
+    pool->free_head = POOL_NO_FREE;
+    pool->tag = tag;
+    return pool;
+}
+
+
+// Уничтожить пул объектов (все объекты пула становятся недействительными):
+void ObjectPool_destroy(ObjectPool **pool) {
+    if (!pool || !*pool) return;
+    for (size_t i = 0; i < (*pool)->blocks_len; i++) mm_free((*pool)->blocks[i]);
+    mm_free((*pool)->blocks);
+    mm_free(*pool);
+    *pool = NULL;
+}
+
+
+// Выделить объект (заполнен нулями). Если handle не NULL - туда записывается дескриптор объекта:
+void* ObjectPool_alloc(ObjectPool *pool, PoolHandle *handle) {
+    if (handle) *handle = OBJECTPOOL_INVALID_HANDLE;
+    if (!pool) return NULL;
+    if (pool->free_head == POOL_NO_FREE && !pool_grow(pool)) return NULL;
+
+    PoolSlot *slot = pool_slot(pool, pool->free_head);
+    void *ptr = slot_object(slot);
+    pool->free_head = *(uint32_t*)ptr;
+    slot->meta |= POOL_SLOT_ALIVE;
+    pool->len++;
+
+    memset(ptr, 0, pool->elem_size);
+    if (handle) *handle = make_handle(slot->index, slot->meta);
+    return ptr;
+}
+
+
+// Освободить объект по указателю:
+void ObjectPool_free(ObjectPool *pool, void *ptr) {
+    if (!pool || !ptr) return;
+    PoolSlot *slot = (PoolSlot*)((char*)ptr - sizeof(PoolSlot));
+    if (!(slot->meta & POOL_SLOT_ALIVE)) {
+        fprintf(stderr, "ObjectPool_free: Double free of object %u.\n", slot->index);
+        return;
+    }
+    slot->meta = next_generation(slot->meta);  // Снимаем флаг занятости и меняем поколение.
+    *(uint32_t*)ptr = pool->free_head;
+    pool->free_head = slot->index;
+    pool->len--;
+}
+
+
+// Освободить объект по дескриптору (устаревший дескриптор игнорируется):
+void ObjectPool_free_handle(ObjectPool *pool, PoolHandle handle) {
+    ObjectPool_free(pool, ObjectPool_get(pool, handle));
+}
+
+
+// Получить объект по дескриптору (NULL если дескриптор устарел):
+void* ObjectPool_get(ObjectPool *pool, PoolHandle handle) {
+    if (!pool || handle == OBJECTPOOL_INVALID_HANDLE) return NULL;
+    size_t index = handle & OBJECTPOOL_MAX_OBJECTS;
+    if (index >= pool->capacity) return NULL;
+    PoolSlot *slot = pool_slot(pool, index);
+    if (!(slot->meta & POOL_SLOT_ALIVE) || make_handle(slot->index, slot->meta) != handle) return NULL;
+    return slot_object(slot);
+}
+
+
+// Получить дескриптор объекта по указателю:
+PoolHandle ObjectPool_get_handle(ObjectPool *pool, void *ptr) {
+    if (!pool || !ptr) return OBJECTPOOL_INVALID_HANDLE;
+    PoolSlot *slot = (PoolSlot*)((char*)ptr - sizeof(PoolSlot));
+    if (!(slot->meta & POOL_SLOT_ALIVE)) return OBJECTPOOL_INVALID_HANDLE;
+    return make_handle(slot->index, slot->meta);
+}
+
+
+// Проверить что дескриптор указывает на живой объект:
+bool ObjectPool_is_valid(ObjectPool *pool, PoolHandle handle) {
+    return ObjectPool_get(pool, handle) != NULL;
+}
+
+
+// Получить объект по индексу ячейки (NULL если ячейка свободна). Для обхода: от 0 до ObjectPool_capacity:
+void* ObjectPool_get_at(ObjectPool *pool, size_t index) {
+    if (!pool || index >= pool->capacity) return NULL;
+    PoolSlot *slot = pool_slot(pool, index);
+    return (slot->meta & POOL_SLOT_ALIVE) ? slot_object(slot) : NULL;
+}
+
+
+// Получить количество живых объектов:
+size_t ObjectPool_len(ObjectPool *pool) {
+    if (!pool) return 0;
+    return pool->len;
+}
+
+
+// Получить количество ячеек во всех блоках:
+size_t ObjectPool_capacity(ObjectPool *pool) {
+    if (!pool) return 0;
+    return pool->capacity;
+}
+
+
+// Освободить все объекты (блоки памяти остаются для повторного использования):
+void ObjectPool_clear(ObjectPool *pool) {
+    if (!pool) return;
+    pool->free_head = POOL_NO_FREE;
+    for (size_t i = pool->capacity; i-- > 0;) {
+        PoolSlot *slot = pool_slot(pool, i);
+        if (slot->meta & POOL_SLOT_ALIVE) slot->meta = next_generation(slot->meta);
+        *(uint32_t*)slot_object(slot) = pool->free_head;
+        pool->free_head = (uint32_t)i;
+    }
+    pool->len = 0;
+}
@@ -0,0 +1,86 @@
+//
+// pool.h - Пул объектов фиксированного размера с поколенными дескрипторами.
+//
+// Объекты лежат подряд в больших блоках (по block_count штук), так что обход пула
+// хорошо ложится в кэш, а выделение и освобождение - O(1) через список свободных ячеек,
+// который хранится прямо внутри свободных ячеек.
+//
+// Кроме указателя пул выдаёт 32-битный дескриптор (индекс + поколение). Поколение ячейки
+// увеличивается при каждом освобождении, поэтому устаревший дескриптор сразу видно:
+// ObjectPool_get вернёт NULL вместо указателя на чужой объект.
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "mm/mm.h"
+
+
+// Определения:
+#define OBJECTPOOL_DEFAULT_BLOCK_COUNT 64                                    // Объектов в блоке по умолчанию.
+#define OBJECTPOOL_INDEX_BITS          20                                    // Сколько бит дескриптора занимает индекс.
+#define OBJECTPOOL_MAX_OBJECTS         ((1u << OBJECTPOOL_INDEX_BITS) - 1)  // Максимум объектов в пуле.
+#define OBJECTPOOL_INVALID_HANDLE      0                                     // Пустой дескриптор.
+
+
+// Объявление структур:
+typedef struct ObjectPool ObjectPool;
+typedef uint32_t PoolHandle;
+
+
+// Структура пула объектов:
+typedef struct ObjectPool {
+    size_t elem_size;    // Размер объекта.
+    size_t stride;       // Размер ячейки (заголовок + объект, с выравниванием).
+    size_t block_count;  // Сколько ячеек в одном блоке.
+    char **blocks;       // Блоки с ячейками.
+    size_t blocks_len;   // Количество блоков.
+    size_t capacity;     // Всего ячеек во всех блоках.
+    size_t len;          // Сколько ячеек занято.
+    uint32_t free_head;  // Первая свободная ячейка (UINT32_MAX - нет свободных).
+    MM_Tag tag;          // Тег памяти блоков.
+} ObjectPool;
+
+
+// Создать пул объектов (block_count - сколько объектов выделяется за раз, 0 - по умолчанию):
+ObjectPool* ObjectPool_create(size_t elem_size, size_t block_count);
+
+// Создать пул объектов, блоки которого учитываются под тегом памяти tag:
+ObjectPool* ObjectPool_create_tagged(size_t elem_size, size_t block_count, MM_Tag tag);
+
+// Уничтожить пул объектов (все объекты пула становятся недействительными):
+void ObjectPool_destroy(ObjectPool **pool);
+
+// Выделить объект (заполнен нулями). Если handle не NULL - туда записывается дескриптор объекта:
+void* ObjectPool_alloc(ObjectPool *pool, PoolHandle *handle);
+
+// Освободить объект по указателю:
+void ObjectPool_free(ObjectPool *pool, void *ptr);
+
+// Освободить объект по дескриптору (устаревший дескриптор игнорируется):
+void ObjectPool_free_handle(ObjectPool *pool, PoolHandle handle);
+
+// Получить объект по дескриптору (NULL если дескриптор устарел):
+void* ObjectPool_get(ObjectPool *pool, PoolHandle handle);
+
+// Получить дескриптор объекта по указателю:
+PoolHandle ObjectPool_get_handle(ObjectPool *pool, void *ptr);
+
+// Проверить что дескриптор указывает на живой объект:
+bool ObjectPool_is_valid(ObjectPool *pool, PoolHandle handle);
+
+// Получить объект по индексу ячейки (NULL если ячейка свободна). Для обхода: от 0 до ObjectPool_capacity:
+void* ObjectPool_get_at(ObjectPool *pool, size_t index);
+
+// Получить количество живых объектов:
+size_t ObjectPool_len(ObjectPool *pool);
+
+// Получить количество ячеек во всех блоках:
+size_t ObjectPool_capacity(ObjectPool *pool);
+
+// Освободить все объекты (блоки памяти остаются для повторного использования):
+void ObjectPool_clear(ObjectPool *pool);
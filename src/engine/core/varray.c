@@ -0,0 +1,186 @@
+//
+// varray.c - Динамический массив значений (элементы хранятся прямо в массиве, а не указатели на них).
+//
+
+
+// Подключаем:
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include "mm/mm.h"
+#include "varray.h"
+
+
+// Указатель на элемент по индексу:
+static inline char* VArray_ptr(VArray *arr, size_t index) {
+    return (char*)arr->data + index * arr->stride;
+}
+
+
+// Перевыделить память массива под заданное количество элементов:
+static void VArray_set_capacity(VArray *arr, size_t capacity) {
+    arr->data = mm_realloc(arr->data, arr->stride * capacity);
+    if (!arr->data) mm_alloc_error();
+    arr->capacity = capacity;
+}
+
+
+// Расширяем массив автоматически, чтобы влезло ещё count элементов:
+static void VArray_grow(VArray *arr, size_t count) {
+    if (arr->len + count <= arr->capacity) return;
+
+    // Увеличиваем массив в 2 раза (или больше, если не хватит):
+    size_t new_capacity = arr->capacity * 2;
+    if (new_capacity < arr->len + count) new_capacity = arr->len + count;
+    VArray_set_capacity(arr, new_capacity);
+}
+
+
+// Создать динамический массив значений с заданным размером элемента:
+VArray* VArray_create(size_t stride, size_t initial_capacity) {
+    if (stride == 0) return NULL;
+    if (initial_capacity == 0) {
+        initial_capacity = VARRAY_DEFAULT_CAPACITY;
+    }
+
+    VArray *arr = (VArray*)mm_alloc_tagged(sizeof(VArray), MM_TAG_DARRAY);
+    if (!arr) mm_alloc_error();
+
+    arr->data = mm_alloc_tagged(stride * initial_capacity, MM_TAG_DARRAY);
+    if (!arr->data) { mm_free(arr); mm_alloc_error(); }
+
+    arr->stride = stride;
+    arr->len = 0;
+    arr->capacity = initial_capacity;
+    arr->init_cap = initial_capacity;
+    return arr;
+}
+
+
+// Уничтожение массива:
+void VArray_destroy(VArray **arr) {
+    if (!arr || !*arr) return;
+    mm_free((*arr)->data);
+    mm_free(*arr);
+    *arr = NULL;
+}
+
+
+// Зарезервировать память минимум под capacity элементов:
+void VArray_reserve(VArray *arr, size_t capacity) {
+    if (!arr || capacity <= arr->capacity) return;
+    VArray_set_capacity(arr, capacity);
+}
+
+
+// Изменить длину массива (новые элементы заполняются нулями):
+void VArray_resize(VArray *arr, size_t len) {
+    if (!arr) return;
+    if (len > arr->len) {
+        VArray_reserve(arr, len);
+        memset(VArray_ptr(arr, arr->len), 0, (len - arr->len) * arr->stride);
+    }
+    arr->len = len;
+}
+
+
+// Ужимаем массив при необходимости:
+void VArray_shrink(VArray *arr) {
+    if (!arr) return;
+
+    // Целевой размер: занятые элементы + 25% текущей capacity, но не меньше размера по умолчанию:
+    size_t target_capacity = arr->len + arr->capacity / 4;
+    if (target_capacity < arr->init_cap) target_capacity = arr->init_cap;
+    if (target_capacity < arr->capacity) VArray_set_capacity(arr, target_capacity);
+}
+
+
+// Добавить элемент в конец массива (копируется stride байт; NULL - элемент из нулей). Возвращает указатель на элемент:
+void* VArray_push(VArray *arr, const void *element) {
+    if (!arr) return NULL;
+    VArray_grow(arr, 1);
+    char *ptr = VArray_ptr(arr, arr->len++);
+    if (element) memcpy(ptr, element, arr->stride);
+    else memset(ptr, 0, arr->stride);
+    return ptr;
+}
+
+
+// Добавить count элементов в конец массива одним копированием:
+void VArray_append(VArray *arr, const void *elements, size_t count) {
+    if (!arr || !elements || count == 0) return;
+    VArray_grow(arr, count);
+    memcpy(VArray_ptr(arr, arr->len), elements, count * arr->stride);
+    arr->len += count;
+}
+
+
+// Вставка элемента по индексу со сдвигом. Возвращает указатель на элемент:
+void* VArray_insert(VArray *arr, size_t index, const void *element) {
+    if (!arr) return NULL;
+    if (index > arr->len) index = arr->len;
+    VArray_grow(arr, 1);
+
+    // Сдвигаем всё вправо от index до конца:
+    char *ptr = VArray_ptr(arr, index);
+    memmove(ptr + arr->stride, ptr, (arr->len - index) * arr->stride);
+    if (element) memcpy(ptr, element, arr->stride);
+    else memset(ptr, 0, arr->stride);
+    arr->len++;
+    return ptr;
+}
+
+
+// Получение указателя на элемент по индексу (NULL если индекс за границей):
+void* VArray_get(VArray *arr, size_t index) {
+    if (!arr || index >= arr->len) return NULL;
+    return VArray_ptr(arr, index);
+}
+
+
+// Удаление элемента со сдвигом (если out не NULL - туда копируется удалённый элемент):
+bool VArray_remove(VArray *arr, size_t index, void *out) {
+    if (!arr || index >= arr->len) return false;
+    char *ptr = VArray_ptr(arr, index);
+    if (out) memcpy(out, ptr, arr->stride);
+
+    // Сдвиг влево:
+    memmove(ptr, ptr + arr->stride, (arr->len - index - 1) * arr->stride);
+    arr->len--;
+    return true;
+}
+
+
+// Удаление элемента заменой на последний (без сдвига, порядок не сохраняется):
+bool VArray_swap_remove(VArray *arr, size_t index, void *out) {
+    if (!arr || index >= arr->len) return false;
+    char *ptr = VArray_ptr(arr, index);
+    if (out) memcpy(out, ptr, arr->stride);
+    arr->len--;
+    if (index != arr->len) memcpy(ptr, VArray_ptr(arr, arr->len), arr->stride);
+    return true;
+}
+
+
+// Получить и удалить последний элемент из массива:
+bool VArray_pop(VArray *arr, void *out) {
+    if (!arr || arr->len == 0) return false;
+    arr->len--;
+    if (out) memcpy(out, VArray_ptr(arr, arr->len), arr->stride);
+    return true;
+}
+
+
+// Получить длину массива:
+size_t VArray_len(VArray *arr) {
+    if (!arr) return 0;
+    return arr->len;
+}
+
+
+// Очистка массива:
+void VArray_clear(VArray *arr) {
+    if (!arr) return;
+    arr->len = 0;
+}
@@ -0,0 +1,79 @@
+//
+// varray.h - Динамический массив значений (элементы хранятся прямо в массиве, а не указатели на них).
+//
+// В отличие от DArray, размер элемента задаётся при создании, и элементы лежат подряд
+// в одном блоке памяти. Нет отдельного выделения памяти на каждый элемент и лишнего
+// перехода по указателю при обходе.
+// ВНИМАНИЕ: Указатели на элементы становятся недействительными после роста массива!
+//
+
+#pragma once
+
+
+// Подключаем:
+#include <stddef.h>
+#include <stdbool.h>
+
+
+// Определения:
+#define VARRAY_DEFAULT_CAPACITY 64  // Размер массива по умолчанию.
+
+// Получить элемент по индексу как значение нужного типа (без проверки границ):
+#define VArray_at(arr, type, index) (((type*)(arr)->data)[index])
+
+
+// Объявление структур:
+typedef struct VArray VArray;
+
+
+// Структура динамического массива значений:
+typedef struct VArray {
+    void *data;        // Элементы массива.
+    size_t stride;     // Размер одного элемента.
+    size_t len;        // Длина массива (сколько элементов занято).
+    size_t capacity;   // Сколько элементов вмещает выделенная память.
+    size_t init_cap;   // Размер массива по умолчанию.
+} VArray;
+
+
+// Создать динамический массив значений с заданным размером элемента:
+VArray* VArray_create(size_t stride, size_t initial_capacity);
+
+// Уничтожение массива:
+void VArray_destroy(VArray **arr);
+
+// Зарезервировать память минимум под capacity элементов:
+void VArray_reserve(VArray *arr, size_t capacity);
+
+// Изменить длину массива (новые элементы заполняются нулями):
+void VArray_resize(VArray *arr, size_t len);
+
+// Ужимаем массив при необходимости:
+void VArray_shrink(VArray *arr);
+
+// Добавить элемент в конец массива (копируется stride байт; NULL - элемент из нулей). Возвращает указатель на элемент:
+void* VArray_push(VArray *arr, const void *element);
+
+// Добавить count элементов в конец массива одним копированием:
+void VArray_append(VArray *arr, const void *elements, size_t count);
+
+// Вставка элемента по индексу со сдвигом. Возвращает указатель на элемент:
+void* VArray_insert(VArray *arr, size_t index, const void *element);
+
+// Получение указателя на элемент по индексу (NULL если индекс за границей):
+void* VArray_get(VArray *arr, size_t index);
+
+// Удаление элемента со сдвигом (если out не NULL - туда копируется удалённый элемент):
+bool VArray_remove(VArray *arr, size_t index, void *out);
+
+// Удаление элемента заменой на последний (без сдвига, порядок не сохраняется):
+bool VArray_swap_remove(VArray *arr, size_t index, void *out);
+
+// Получить и удалить последний элемент из массива:
+bool VArray_pop(VArray *arr, void *out);
+
+// Получить длину массива:
+size_t VArray_len(VArray *arr);
+
+// Очистка массива:
+void VArray_clear(VArray *arr);
@@ -80,6 +80,8 @@ void destroy(Window *self) {
 // Точка входа в программу:
 int main(int argc, char *argv[]) {
     printf("Engine version: %s\n", ENGINE_VERSION);
+    mm_profiler_set_rate(MM_PROFILER_DEFAULT_RATE);  // Профайлер кучи (для отчёта при утечке памяти).
+    ShaderProgram_set_binary_cache_dir("cache/shaders");  // Кэш скомпилированных шейдерных программ.
 
     Renderer *renderer = RendererGL_create(4, 1, true, RENDERER_GL_CORE);
     WinConfig *config = Window_create_config(start, update, render, resize, show, hide, destroy);
@@ -93,7 +95,10 @@ int main(int argc, char *argv[]) {
     RendererGL_destroy(&renderer);
 
     printf("(After free) Memory used: %g kb (%zu b).\n", mm_get_used_size_kb(), mm_get_used_size());
-    if (mm_get_used_size() > 0) printf("Memory leak!\n");
+    if (mm_get_used_size() > 0) {
+        printf("Memory leak!\n");
+        mm_profiler_report(stdout);
+    }
 
     return 0;
 }
@@ -6,12 +6,20 @@
 // Подключаем:
 #include <engine/engine.h>
 #include <engine/core/graphics/gl.h>
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#endif
 
 
-GLuint VBO, VAO;
+Mesh *triangle;
 Camera2D *camera;
 ShaderProgram *shader;
 Texture *texture;
+SpriteBatch *batch;
+RenderTargetPool *targets;
+RenderQueue *queue;
+RendererInstance stars[1000];
 
 
 // Вызывается после создания окна:
@@ -28,19 +36,34 @@ void start(Window *self) {
     self->set_fps(self, 10);
     self->set_vsync(self, false);
 
+    BufferGC_GL_set_recycle(true);  // Удалённые текстуры и буферы переиспользуются вместо glDelete*/glGen*.
+
     texture = Texture_create(self->renderer);
 
     Image *img2 = Image_load("data/so_bad.png", IMG_RGBA);
     texture->load(texture, img2);
     Image_destroy(&img2);
 
+    batch = SpriteBatch_create(self->renderer, 0);
+    targets = RenderTargetPool_create(self->renderer, 0);
+    queue = RenderQueue_create(self->renderer);
+
+    // Звёзды для отрисовки экземплярами:
+    for (int i = 0; i < 1000; i++) {
+        stars[i] = (RendererInstance){
+            .position = {(rand() % 2000) / 1000.0f - 1.0f, (rand() % 2000) / 1000.0f - 1.0f, 0.0f},
+            .scale = {1.0f + rand() % 4, 1.0f},
+            .color = Renderer_pack_color((Vec4f){1.0f, 1.0f, 1.0f, 0.5f + (rand() % 50) / 100.0f}),
+        };
+    }
+
     camera = Camera2D_create(
         self, self->get_width(self), self->get_height(self),
         (Vec2d){0.0, 0.0}, 0.0f, 0.01f
     );
 
     // double start_time = Time_now(NULL);
-    // DArray *arr = DArray_create(0);
+    // DArray *arr = DArray_create_reserved(1024*1024*1024);  // Растёт без копирования (DArray_create(0) копирует при росте).
     // for (int i=0; i<1024*1024*1024; i++)
     //     DArray_push(arr, (void*)camera);
     // DArray_clear(arr);
@@ -49,15 +72,18 @@ void start(Window *self) {
     // printf("Time: %f\n", Time_now(NULL)-start_time);
 
 
-    // const char* vertex_shader_src = fs_load_file("data/shaders/default.vert", "r");
-    // const char* fragment_shader_src = fs_load_file("data/shaders/default.frag", "r");
+    // Шейдеры из data/shaders подключают frame_data.glsl, поэтому их надо прогнать через препроцессор
+    // (строки надо освободить уже после уничтожения шейдера):
+    // char* vertex_file = fs_load_file("data/shaders/default.vert", "r");
+    // char* fragment_file = fs_load_file("data/shaders/default.frag", "r");
+    // char* vertex_shader_src = ShaderPreproc_process(vertex_file, NULL, 0);
+    // char* fragment_shader_src = ShaderPreproc_process(fragment_file, NULL, 0);
+    // mm_free(vertex_file);
+    // mm_free(fragment_file);
 
     // shader = ShaderProgram_create(self->renderer, vertex_shader_src, fragment_shader_src, NULL);
     // shader->compile(shader);
 
-    // mm_free((char*)vertex_shader_src);
-    // mm_free((char*)fragment_shader_src);
-
     // === Вершины треугольника ===
     float vertices[] = {
          0.0f,  0.5f, 0.0f,  // верх
@@ -65,21 +91,10 @@ void start(Window *self) {
          0.5f, -0.5f, 0.0f   // правый
     };
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    // Настройка VAO/VBO
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
     // layout(location = 0) → 3 float'а
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    MeshLayout layout = {.count = 1, .attribs = {{.location = 0, .type = MESH_ATTRIB_FLOAT, .components = 3}}};
+    triangle = Mesh_create(self->renderer, &layout, RENDER_TRIANGLES, MESH_USAGE_STATIC);
+    triangle->set_vertices(triangle, 0, vertices, 3);
 }
 
 
@@ -166,6 +181,27 @@ void render(Window *self, Renderer *render, float dtime) {
     float b = 0.5 + 0.5 * cosf(t + 4.0);
     render->clear(render, 0.0, 0.0, 0.0, 1.0f);
 
+    // Звёзды рисуем в цель с MSAA из пула и переносим в окно (цель того же размера берётся из пула каждый кадр):
+    RenderTarget *stars_target = RenderTargetPool_acquire(targets, &(RenderTargetDesc){
+        .width = self->get_width(self), .height = self->get_height(self),
+        .color_count = 1, .color_format = TEX_RGBA, .samples = 4,
+    });
+    if (stars_target) {
+        stars_target->begin(stars_target);
+        render->clear(render, 0.0, 0.0, 0.0, 1.0f);
+        // Звёзды записываем в очередь команд частями от дальних к ближним, выполнятся они уже отсортированными по ключу:
+        RenderList *list = RenderQueue_get_list(queue);
+        for (int i = 0; i < 4; i++) {
+            uint64_t key = RenderQueue_make_key(0, 0, 0, 1.0f - i / 4.0f);
+            RenderList_draw_instanced(list, key, RENDERER_MESH_POINT, stars + i * 250, 250);
+        }
+        RenderQueue_execute(queue);
+        stars_target->end(stars_target);
+        stars_target->blit(stars_target, NULL, false);
+        RenderTargetPool_release(targets, stars_target);
+    }
+    RenderTargetPool_next_frame(targets);
+
     mat4 model;
     glm_mat4_identity(model);
     glm_translate(model, (vec3){r, g, 0});
@@ -173,13 +209,11 @@ void render(Window *self, Renderer *render, float dtime) {
     glm_rotate(model, glm_rad(r*360.0f), (vec3){1.0f, 0.0f, 0.0f});
     glm_rotate(model, glm_rad(b*360.0f), (vec3){0.0f, 0.0f, 1.0f});
     texture->begin(texture);
-    glActiveTexture(GL_TEXTURE1);
     render->default_shader->set_uniform_vec4(render->default_shader, "u_color", (Vec4f){r, g, b, 1.0f});
     render->default_shader->set_uniform_mat4(render->default_shader, "u_model", model);
     // render->default_shader->set_uniform_bool(render->default_shader, "u_use_texture", true);
-    // render->default_shader->set_uniform_int(render->default_shader, "u_texture", 1);
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+    // render->default_shader->set_sampler2d(render->default_shader, "u_texture", texture);
+    triangle->draw(triangle, 0, 0);
 
     glm_mat4_identity(model);
     glm_translate(model, (vec3){b, -r, 0});
@@ -188,10 +222,27 @@ void render(Window *self, Renderer *render, float dtime) {
     glm_rotate(model, glm_rad(r*360.0f), (vec3){0.0f, 0.0f, 1.0f});
     render->default_shader->set_uniform_vec4(render->default_shader, "u_color", (Vec4f){g, b, r, 1.0f});
     render->default_shader->set_uniform_mat4(render->default_shader, "u_model", model);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+    triangle->draw(triangle, 0, 0);
     texture->end(texture);
     // shader->end(shader);
 
+    // Сетка спрайтов одним пакетом (белые квадраты и текстура вперемешку, рисуются за 2 вызова):
+    batch->begin(batch);
+    for (int y = 0; y < 10; y++) {
+        for (int x = 0; x < 10; x++) {
+            batch->draw(batch, &(SpriteBatchSprite){
+                .texture = (x + y) % 2 ? texture : NULL,
+                .position = {-1.0f + x * 0.2f, -1.0f + y * 0.2f},
+                .size = {0.15f, 0.15f},
+                .origin = {0.075f, 0.075f},
+                .rotation = t + (x + y) * 0.1f,
+                .uv = {0.0f, 0.0f, 1.0f, 1.0f},
+                .color = {r, g, b, 1.0f},
+            });
+        }
+    }
+    batch->end(batch);
+
     self->display(self);
 }
 
@@ -218,18 +269,86 @@ void hide(Window *self) {
 // Вызывается при закрытии окна:
 void destroy(Window *self) {
     printf("Destroy called.\n");
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    Mesh_destroy(&triangle);
     ShaderProgram_destroy(&shader);
+    SpriteBatch_destroy(&batch);
+    RenderTargetPool_destroy(&targets);
+    RenderQueue_destroy(&queue);
     Camera2D_destroy(&camera);
     Texture_destroy(&texture);
     printf("destroy done.\n");
 }
 
 
+// Получить текущий размер резидентной памяти процесса в байтах:
+static size_t bench_get_rss() {
+    #ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc;
+        if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+        return pmc.WorkingSetSize;
+    #else
+        long pages = 0;
+        FILE *f = fopen("/proc/self/statm", "r");
+        if (!f) return 0;
+        if (fscanf(f, "%*d %ld", &pages) != 1) pages = 0;
+        fclose(f);
+        return (size_t)pages * (size_t)sysconf(_SC_PAGESIZE);
+    #endif
+}
+
+
+// Бенчмарк менеджера памяти (запуск: "--bench-mm").
+// Для сравнения раскладок блоков соберите дважды: с MM_COMPACT_HEADER в "defines" конфига сборки и без:
+static void bench_mm(size_t alignment) {
+    const size_t count = 1024 * 1024;
+    void **ptrs = malloc(sizeof(void*) * count);
+    uint32_t seed = 12345;
+
+    size_t rss_before = bench_get_rss();
+    double start_time = Time_now(NULL);
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        size_t size = 16 + (seed >> 16) % 33;  // 16-48 байт.
+        ptrs[i] = alignment ? mm_alloc_aligned(size, alignment) : mm_alloc(size);
+    }
+    double alloc_time = Time_now(NULL) - start_time;
+    size_t rss_after = bench_get_rss();
+    size_t used = mm_get_used_size();
+    size_t absolute = mm_get_absolute_used_size();
+
+    start_time = Time_now(NULL);
+    for (size_t i = 0; i < count; i++) mm_free(ptrs[i]);
+    double free_time = Time_now(NULL) - start_time;
+    free(ptrs);
+
+    printf("[bench-mm] header: %zu b, backend: %s, align: %zu.\n", mm_get_block_header_size(),
+           mm_get_backend() == MM_BACKEND_SLAB ? "slab" : "malloc", alignment ? alignment : MM_BASE_ALIGNMENT);
+    printf("[bench-mm]   used: %g mb, absolute: %g mb (overhead %.1f%%), rss: +%g mb.\n",
+           used / 1048576.0, absolute / 1048576.0, (absolute - used) * 100.0 / used,
+           (rss_after - rss_before) / 1048576.0);
+    printf("[bench-mm]   alloc: %.2f M/s, free: %.2f M/s.\n",
+           count / alloc_time / 1e6, count / free_time / 1e6);
+}
+
+
 // Точка входа в программу:
 int main(int argc, char *argv[]) {
     printf("Engine version: %s\n", ENGINE_VERSION);
+    bool bench = argc > 1 && strcmp(argv[1], "--bench-mm") == 0;
+    bool mm_report = argc > 1 && strcmp(argv[1], "--mm-report") == 0;  // Отчёт профайлера кучи перед освобождением.
+    if (bench && argc > 2 && strcmp(argv[2], "malloc") == 0) {
+        mm_set_backend(MM_BACKEND_MALLOC);
+    } else {
+        mm_set_backend(MM_BACKEND_SLAB);  // Используем slab-аллокатор (до первого выделения памяти).
+    }
+    if (bench) {
+        bench_mm(0);
+        bench_mm(32);
+        bench_mm(64);
+        return 0;
+    }
+    mm_profiler_set_rate(MM_PROFILER_DEFAULT_RATE);  // Профайлер кучи (сэмплирование почти ничего не стоит).
+    ShaderProgram_set_binary_cache_dir("cache/shaders");  // Кэш скомпилированных шейдерных программ.
 
     Renderer *renderer = RendererGL_create(4, 1, true, RENDERER_GL_CORE);
     WinConfig *config = Window_create_config(start, update, render, resize, show, hide, destroy);
@@ -240,6 +359,7 @@ int main(int argc, char *argv[]) {
     printf("(Before free) MM used: %g kb (%zu b). Blocks allocated: %zu. Absolute: %zu b. BlockHeaderSize: %zu b.\n",
             mm_get_used_size_kb(), mm_get_used_size(), mm_get_total_allocated_blocks(), mm_get_absolute_used_size(),
             mm_get_block_header_size());
+    if (mm_report) mm_profiler_report(stdout);
 
     WindowSDL3_destroy(&window);
     Window_destroy_config(&config);
@@ -248,7 +368,10 @@ int main(int argc, char *argv[]) {
     printf("(After free) MM used: %g kb (%zu b). Blocks allocated: %zu. Absolute: %zu b. BlockHeaderSize: %zu b.\n",
             mm_get_used_size_kb(), mm_get_used_size(), mm_get_total_allocated_blocks(), mm_get_absolute_used_size(),
             mm_get_block_header_size());
-    if (mm_get_used_size() > 0) printf("Memory leak!\n");
+    if (mm_get_used_size() > 0) {
+        printf("Memory leak!\n");
+        mm_profiler_report(stdout);
+    }
 
     return 0;
 }